@@ -6,6 +6,9 @@ do
     rm -rf "$d/graph"
 done
 
+# Parse every log once in parallel, the graph scripts then load the results from each directory's .parsed cache
+python3 -m analysis.parser.cache --log-dir results/*
+
 ./analysis/graph/challenge_response_epoch.py --log-dir results/*
 ./analysis/graph/challenge_response_perf.py --log-dir results/*
 ./analysis/graph/correctly_evaluated.py --log-dir results/*
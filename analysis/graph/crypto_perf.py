@@ -10,7 +10,7 @@ import scipy.stats as stats
 
 import matplotlib.pyplot as plt
 
-from analysis.parser.profile_pyterm import main as profile_pyterm
+from analysis.parser.profile_pyterm import main as profile_pyterm, ProfileAnalyser, PROFILE_TRUST_EDGES
 from analysis.graph.util import savefig
 
 plt.rcParams['text.usetex'] = True
@@ -33,6 +33,7 @@ def main(log_dir: pathlib.Path):
         ]
         for (hostname, result)
         in results.items()
+        if result.stats_sha256
     }
 
 
@@ -92,27 +93,41 @@ def main(log_dir: pathlib.Path):
         "stats_encrypt_n": 1e-3,
         "stats_decrypt_u": 1e-3,
         "stats_decrypt_n": 1e-3,
+        "stats_certificate_decode": 1e-5,
+        "stats_certificate_verify": 1e-3,
     }
+    names.update({
+        f"{name}_{edges}": 1e-5
+        for name in ProfileAnalyser.EDGES_STATS
+        for edges in PROFILE_TRUST_EDGES
+    })
 
     for (name, bin_width) in names.items():
-        fig = plt.figure()
-        ax = fig.gca()
-
         labels = []
         hs = []
 
         hmin, hmax = float("+inf"), float("-inf")
 
         for (hostname, result) in sorted(results.items(), key=lambda x: x[0]):
-            labels.append(hostname)
+            h = getattr(result, name, [])
+
+            # Each profile mode only records some of the stats
+            if not h:
+                continue
 
-            h = getattr(result, name)
+            labels.append(hostname)
 
             hs.append(h)
 
             hmin = min(hmin, min(h))
             hmax = max(hmax, max(h))
 
+        if not hs:
+            continue
+
+        fig = plt.figure()
+        ax = fig.gca()
+
         hmin = round_down(hmin, bin_width)
         hmax = round_up(hmax, bin_width)
 
@@ -129,6 +144,38 @@ def main(log_dir: pathlib.Path):
 
         savefig(fig, log_dir / "graphs" / f"crypto_perf_{name}_hist.pdf")
 
+    # How the trust pipeline scales with the number of edges
+    for name in ProfileAnalyser.EDGES_STATS:
+        XYs = {
+            hostname: [
+                (x.edges, x.seconds)
+                for x
+                in getattr(result, name)
+            ]
+            for (hostname, result)
+            in results.items()
+            if getattr(result, name)
+        }
+
+        if not XYs:
+            continue
+
+        fig = plt.figure()
+        ax = fig.gca()
+
+        for (hostname, XY) in sorted(XYs.items(), key=lambda x: x[0]):
+            X, Y = zip(*XY)
+            ax.scatter(X, Y, label=hostname)
+
+        ax.set_xticks(PROFILE_TRUST_EDGES)
+
+        ax.set_xlabel('Number of Edges')
+        ax.set_ylabel('Time Taken (secs)')
+
+        ax.legend()
+
+        savefig(fig, log_dir / "graphs" / f"crypto_perf_{name}_scatter.pdf")
+
 
 
 if __name__ == "__main__":
@@ -19,13 +19,6 @@ from analysis.graph.util import savefig
 plt.rcParams['text.usetex'] = True
 plt.rcParams['font.size'] = 12
 
-def packet_length(packet) -> int:
-    # Count the length of the fragments, if this packet was fragmented
-    if '6lowpan' in packet and hasattr(packet['6lowpan'], "reassembled_length"):
-        return int(packet['6lowpan'].reassembled_length)
-    else:
-        return int(packet.length)
-
 def main(log_dir: pathlib.Path, tx_ymax: Optional[float], rx_ymax: Optional[float]):
     (log_dir / "graphs").mkdir(parents=True, exist_ok=True)
 
@@ -33,7 +26,7 @@ def main(log_dir: pathlib.Path, tx_ymax: Optional[float], rx_ymax: Optional[floa
 
     XYs_tx = {
         hostname: [
-            (name, [datetime.fromtimestamp(float(value.sniff_timestamp)) for value in values], [packet_length(value) for value in values])
+            (name, [datetime.fromtimestamp(value.sniff_timestamp) for value in values], [value.length for value in values])
             for (name, values)
             in result.tx.items()
         ]
@@ -44,7 +37,7 @@ def main(log_dir: pathlib.Path, tx_ymax: Optional[float], rx_ymax: Optional[floa
 
     XYs_rx = {
         hostname: [
-            (name, [datetime.fromtimestamp(float(value.sniff_timestamp)) for value in values], [packet_length(value) for value in values])
+            (name, [datetime.fromtimestamp(value.sniff_timestamp) for value in values], [value.length for value in values])
             for (name, values)
             in result.rx.items()
         ]
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+import hashlib
+import importlib
+import pickle
+import pathlib
+from concurrent.futures import ProcessPoolExecutor
+from typing import Callable, Dict, Iterable, Optional, TypeVar
+
+# Parsed results are saved next to the logs they came from
+CACHE_DIR_NAME = ".parsed"
+
+# Set ANALYSIS_CACHE=0 to always parse the logs and ANALYSIS_JOBS to limit the processes used
+CACHE_ENABLED = os.environ.get("ANALYSIS_CACHE", "1") != "0"
+JOBS = int(os.environ["ANALYSIS_JOBS"]) if "ANALYSIS_JOBS" in os.environ else None
+
+T = TypeVar("T")
+
+_parser_version = None
+
+def parser_version() -> str:
+    """Any change to the parsers could change what they produce, so the version is a hash of their source"""
+    global _parser_version
+
+    if _parser_version is None:
+        h = hashlib.sha256()
+        for path in sorted(pathlib.Path(__file__).parent.glob("*.py")):
+            h.update(path.name.encode())
+            h.update(path.read_bytes())
+        _parser_version = h.hexdigest()
+
+    return _parser_version
+
+def file_hash(path: pathlib.Path) -> str:
+    h = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            h.update(chunk)
+    return h.hexdigest()
+
+def importable(analyse: Callable) -> Optional[Callable]:
+    """A parser run with python3 -m has its module named __main__, so its cache would not be found by the
+    graph scripts and the classes pickled in it could not be loaded. Returns analyse from the parser's module
+    imported by its real name, or None if it has no such name (e.g., it was run as a script)."""
+    if analyse.__module__ != "__main__":
+        return analyse
+
+    spec = getattr(sys.modules["__main__"], "__spec__", None)
+    if spec is None:
+        return None
+
+    return getattr(importlib.import_module(spec.name), analyse.__name__)
+
+def cache_path(path: pathlib.Path, analyse: Callable) -> pathlib.Path:
+    # Several parsers read the same logs, so each has its own cache
+    return path.parent / CACHE_DIR_NAME / f"{path.name}.{analyse.__module__.rsplit('.', 1)[-1]}.pickle"
+
+def dependency_hashes(path: pathlib.Path, analyse: Callable) -> Dict[str, Optional[str]]:
+    """Hashes of the other files that analyse(path) reads, listed by cache_dependencies(path) in the parser's module"""
+    cache_dependencies = getattr(sys.modules.get(analyse.__module__), "cache_dependencies", None)
+    if cache_dependencies is None:
+        return {}
+
+    return {str(dep): file_hash(dep) if dep.exists() else None for dep in cache_dependencies(path)}
+
+def load(path: pathlib.Path, analyse: Callable):
+    """Returns the cached result of analyse(path), or None if the log or parsers have changed since it was saved"""
+    cached = cache_path(path, analyse)
+
+    try:
+        with open(cached, "rb") as f:
+            key = pickle.load(f)
+
+            if key["parser_version"] != parser_version():
+                return None
+
+            # Hashing is only needed when the log might have changed, e.g., after it has been copied
+            stat = path.stat()
+            if (stat.st_size, stat.st_mtime_ns) != key["stat"]:
+                if file_hash(path) != key["file_hash"]:
+                    return None
+
+            if dependency_hashes(path, analyse) != key["dependencies"]:
+                return None
+
+            return pickle.load(f)
+
+    except (OSError, EOFError, KeyError, TypeError, pickle.UnpicklingError, AttributeError, ImportError):
+        return None
+
+def save(path: pathlib.Path, analyse: Callable, result, log_hash: str, dependencies: Dict[str, Optional[str]]):
+    cached = cache_path(path, analyse)
+    cached.parent.mkdir(exist_ok=True)
+
+    stat = path.stat()
+    key = {
+        "parser_version": parser_version(),
+        "file_hash": log_hash,
+        "dependencies": dependencies,
+        "stat": (stat.st_size, stat.st_mtime_ns),
+    }
+
+    # Write to a temporary file first, so an interrupted run never leaves a truncated cache
+    tmp = cached.with_name(f"{cached.name}.{os.getpid()}.tmp")
+    with open(tmp, "wb") as f:
+        pickle.dump(key, f, protocol=pickle.HIGHEST_PROTOCOL)
+        pickle.dump(result, f, protocol=pickle.HIGHEST_PROTOCOL)
+    os.replace(tmp, cached)
+
+def _analyse_and_save(analyse: Callable[[pathlib.Path], T], path: pathlib.Path, cache: bool=CACHE_ENABLED) -> T:
+    # Hash before parsing, so a log that is still being written is not cached as complete
+    log_hash = file_hash(path) if cache else None
+    dependencies = dependency_hashes(path, analyse) if cache else None
+
+    result = analyse(path)
+
+    if cache and result is not None:
+        try:
+            save(path, analyse, result, log_hash, dependencies)
+        except (OSError, pickle.PicklingError) as ex:
+            print(f"Failed to cache {path}: {ex}", file=sys.stderr)
+
+    return result
+
+def analyse_logs(paths: Iterable[pathlib.Path], analyse: Callable[[pathlib.Path], Optional[T]],
+                 jobs: Optional[int]=JOBS) -> Dict[pathlib.Path, T]:
+    """Returns analyse(path) for each log, loading it from the cache if neither the log nor the parsers
+    have changed since it was last parsed. The other logs are parsed in parallel.
+    analyse must be a module level function so it can be run in another process."""
+    results = {}
+    to_parse = []
+
+    cache = CACHE_ENABLED
+    if cache:
+        resolved = importable(analyse)
+        if resolved is None:
+            print(f"Not caching {analyse.__name__} as it was not run as a module", file=sys.stderr)
+            cache = False
+        else:
+            analyse = resolved
+
+    for path in sorted(paths):
+        result = load(path, analyse) if cache else None
+        if result is not None:
+            print(f"Loaded {path} from cache")
+            results[path] = result
+        else:
+            to_parse.append(path)
+
+    if len(to_parse) == 1 or jobs == 1:
+        for path in to_parse:
+            print(f"Processing {path}...")
+            results[path] = _analyse_and_save(analyse, path, cache)
+
+    elif to_parse:
+        with ProcessPoolExecutor(max_workers=jobs) as executor:
+            futures = {path: executor.submit(_analyse_and_save, analyse, path, cache) for path in to_parse}
+
+            for (path, future) in futures.items():
+                print(f"Processing {path}...")
+                results[path] = future.result()
+
+    return {path: results[path] for path in sorted(results) if results[path] is not None}
+
+def main(log_dirs: list, jobs: Optional[int]):
+    # Imported here as the parsers use this module
+    from analysis.parser import wsn_pyterm, edge_challenge_response, profile_pyterm, prof_pyterm
+
+    parsers = [wsn_pyterm, edge_challenge_response, profile_pyterm, prof_pyterm]
+
+    # Every log in every directory is one job, so the work is spread over all processes
+    paths = {
+        parser: [path for log_dir in log_dirs for path in parser.log_files(log_dir)]
+        for parser in parsers
+    }
+
+    with ProcessPoolExecutor(max_workers=jobs) as executor:
+        futures = [
+            (path, executor.submit(_analyse_and_save, parser.analyse_log, path))
+            for (parser, parser_paths) in paths.items()
+            for path in parser_paths
+            if load(path, parser.analyse_log) is None
+        ]
+
+        for (path, future) in futures:
+            future.result()
+
+    print(f"Parsed {len(futures)} log(s), {sum(len(parser_paths) for parser_paths in paths.values()) - len(futures)} already cached")
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Parse logs in parallel and cache the results for the graph scripts')
+    parser.add_argument('--log-dir', type=pathlib.Path, default=["results"], nargs='+', help='The directories which contain the log output')
+    parser.add_argument('--jobs', type=int, default=JOBS, help='The number of processes to parse with (default: one per core)')
+
+    args = parser.parse_args()
+
+    main(args.log_dir, args.jobs)
@@ -21,7 +21,8 @@ contiki_log = re.compile(r"\[(.+)\:(.+)\] (.*)")
 
 def parse_contiki_debug(line: str) -> Tuple[str, str, str]:
     # Remove colour escape sequences from the line
-    line = ansi_escape.sub('', line)
+    if "\x1B" in line:
+        line = ansi_escape.sub('', line)
 
     m = contiki_log.match(line)
     if m is None:
@@ -40,6 +41,10 @@ def parse_contiki(f):
     for (i, line) in enumerate(f):
         time, rest = line.strip().split(" # ", 1)
 
+        # Binary events are decoded by analysis.parser.event_log
+        if rest.startswith("#Ev|"):
+            continue
+
         result = parse_contiki_debug(rest)
         if result is None:
             if saved_line is not None:
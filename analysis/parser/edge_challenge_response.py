@@ -9,6 +9,8 @@ import ast
 from dataclasses import dataclass
 import pathlib
 
+from analysis.parser.cache import analyse_logs
+
 @dataclass(frozen=True)
 class Challenge:
     source: ipaddress.IPv6Address
@@ -139,29 +141,37 @@ class ChallengeResponseAnalyser:
 
         self.task_actions.append((time, m_behaviour, m_action, m_action_type))
 
-def main(log_dir: pathlib.Path):
-    print(f"Looking for results in {log_dir}")
-
-    gs = log_dir.glob("*challenge_response.log")
+def log_files(log_dir: pathlib.Path) -> list:
+    result = []
 
-    results = {}
-
-    for g in gs:
-        print(f"Processing {g}...")
-        bg = os.path.basename(g)
-
-        kind, hostname, cr, log = bg.split(".", 3)
+    for g in log_dir.glob("*challenge_response.log"):
+        kind, hostname, cr, log = g.name.split(".", 3)
 
         if kind != "edge":
             print("Can only have challenge_response results from an edge node")
             continue
 
-        a = ChallengeResponseAnalyser(hostname)
+        result.append(g)
+
+    return result
 
-        with open(g, 'r') as f:
-            a.analyse(f)
+def analyse_log(g: pathlib.Path) -> ChallengeResponseAnalyser:
+    kind, hostname, cr, log = g.name.split(".", 3)
+
+    a = ChallengeResponseAnalyser(hostname)
+
+    with open(g, 'r') as f:
+        a.analyse(f)
+
+    return a
+
+def main(log_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    results = {}
 
-        results[hostname] = a
+    for a in analyse_logs(log_files(log_dir), analyse_log).values():
+        results[a.hostname] = a
 
     return results
 
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+from datetime import datetime
+import base64
+import binascii
+from dataclasses import dataclass
+from enum import IntEnum
+from typing import Optional, Tuple, Any
+import pathlib
+from collections import Counter
+
+import cbor2
+
+# Must be kept in sync with wsn/common/event-log.h
+EVENT_LOG_PREFIX = "#Ev|"
+
+class EventId(IntEnum):
+    START = 1
+    TM_UPDATE = 2
+
+# Must be kept in sync with wsn/common/trust/trust-models.h
+class TrustMetric(IntEnum):
+    TASK_SUBMISSION = 1001
+    TASK_RESULT = 1002
+    ANNOUNCE = 1003
+    CHALLENGE_RESP = 1004
+    LAST_PING = 1005
+    RESULT_QUALITY = 2001
+    RESULT_LATENCY = 2002
+    THROUGHPUT = 2003
+
+@dataclass(frozen=True)
+class Event:
+    time: datetime
+    kind: EventId
+    ticks: int
+    fields: Tuple[Any, ...]
+
+@dataclass(frozen=True)
+class TMUpdateEvent:
+    time: datetime
+    ticks: int
+    edge_id: str
+    capability: Optional[str]
+    metric: TrustMetric
+    observation: Tuple[int, int]
+    tm_from: Any
+    tm_to: Any
+
+def fletcher16(data: bytes) -> int:
+    sum1 = 0
+    sum2 = 0
+
+    for b in data:
+        sum1 = (sum1 + b) % 255
+        sum2 = (sum2 + sum1) % 255
+
+    return (sum2 << 8) | sum1
+
+def decode_frame(encoded: str) -> Optional[list]:
+    try:
+        frame = base64.b64decode(encoded, validate=True)
+    except binascii.Error:
+        return None
+
+    if len(frame) < 3:
+        return None
+
+    data, checksum = frame[:-2], int.from_bytes(frame[-2:], "big")
+    if fletcher16(data) != checksum:
+        return None
+
+    try:
+        return cbor2.loads(data)
+    except (cbor2.CBORDecodeError, ValueError):
+        return None
+
+def parse_events(f):
+    """Yields the events in a pyterm log, skipping any text output"""
+    for line in f:
+        try:
+            time, rest = line.strip().split(" # ", 1)
+        except ValueError:
+            continue
+
+        if not rest.startswith(EVENT_LOG_PREFIX):
+            continue
+
+        contents = decode_frame(rest[len(EVENT_LOG_PREFIX):])
+        if contents is None:
+            print(f"Skipping corrupt event '{rest}'", file=sys.stderr)
+            continue
+
+        (kind, ticks, *fields) = contents
+
+        yield Event(datetime.fromisoformat(time), EventId(kind), ticks, tuple(fields))
+
+def decode_tm_update(event: Event) -> TMUpdateEvent:
+    assert event.kind == EventId.TM_UPDATE
+
+    (eui64, capability, metric, obs1, obs2, tm_from, tm_to) = event.fields
+
+    return TMUpdateEvent(event.time, event.ticks, eui64.hex(), capability, TrustMetric(metric), (obs1, obs2), tm_from, tm_to)
+
+def main(log_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    gs = log_dir.glob("*.pyterm.log")
+
+    for g in gs:
+        print(f"Processing {g}...")
+        bg = os.path.basename(g)
+
+        kind, hostname, cr, log = bg.split(".", 3)
+
+        counts = Counter()
+        clock_second = None
+
+        with open(g, 'r') as f:
+            for event in parse_events(f):
+                if event.kind == EventId.START:
+                    (clock_second,) = event.fields
+                elif event.kind == EventId.TM_UPDATE:
+                    counts[decode_tm_update(event).metric] += 1
+
+        if not counts:
+            continue
+
+        print(f"{hostname}: clock_second={clock_second}")
+        for (metric, count) in sorted(counts.items()):
+            print(f"\t{metric.name} {count}")
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Parse binary events from pyterm')
+    parser.add_argument('--log-dir', type=pathlib.Path, default="results", help='The directory which contains the log output')
+
+    args = parser.parse_args()
+
+    main(args.log_dir)
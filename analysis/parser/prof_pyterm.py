@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+
+from datetime import datetime
+import re
+import base64
+import struct
+from collections import defaultdict
+from dataclasses import dataclass
+from typing import Dict
+import pathlib
+
+import numpy as np
+import scipy.stats as stats
+
+from analysis.parser.common import parse_contiki
+from analysis.parser.cache import analyse_logs
+
+# Must be kept in sync with prof_id_t in wsn/common/prof.h
+PROF_IDS = {
+    1: "choose_edge",
+    2: "calculate_trust_value",
+    3: "serialise_trust",
+    4: "process_received_trust",
+    5: "certificate_decode",
+    6: "mqtt_publish_handler",
+    7: "sign_queue",
+    8: "sign",
+    9: "verify_queue",
+    10: "verify",
+}
+
+# (u8 id, u32 start, u32 duration) in little endian
+SAMPLE = struct.Struct("<BII")
+
+@dataclass(frozen=True)
+class ProfSample:
+    time: datetime
+    name: str
+    start: int
+    us: float
+
+class ProfAnalyser:
+    RE_DUMP_BEGIN = re.compile(r'dump begin ([0-9]+) ([0-9]+) ([0-9]+)')
+    RE_DUMP_END = re.compile(r'dump end')
+    RE_DUMP = re.compile(r'dump ([A-Za-z0-9+/=]+)')
+
+    def __init__(self, hostname: str):
+        self.hostname = hostname
+
+        self.rtimer_second = None
+        self.dropped = 0
+
+        self.samples = []
+
+        self.res = {
+            self.RE_DUMP_BEGIN: self._process_dump_begin,
+            self.RE_DUMP_END: None,
+            self.RE_DUMP: self._process_dump,
+        }
+
+    def analyse(self, f):
+        for (time, log_level, module, line) in parse_contiki(f):
+
+            if module == "prof":
+                for (r, f) in self.res.items():
+                    m = r.match(line)
+                    if m is not None:
+                        if f is not None:
+                            f(time, log_level, module, line, m)
+                        break
+
+    def by_name(self) -> Dict[str, np.array]:
+        result = defaultdict(list)
+
+        for sample in self.samples:
+            result[sample.name].append(sample.us)
+
+        return {name: np.array(us) for (name, us) in result.items()}
+
+    def summary(self):
+        print(f"{self.hostname}: {len(self.samples)} samples, {self.dropped} dropped")
+
+        for (name, us) in sorted(self.by_name().items()):
+            print(name, "(us)", stats.describe(us))
+
+            counts, edges = np.histogram(us, bins=10)
+            for (count, lo, hi) in zip(counts, edges, edges[1:]):
+                print(f"\t[{lo:10.1f}, {hi:10.1f}) {count}")
+
+    def _process_dump_begin(self, time: datetime, log_level: str, module: str, line: str, m: str):
+        self.rtimer_second = int(m.group(1))
+        self.dropped += int(m.group(3))
+
+    def _process_dump(self, time: datetime, log_level: str, module: str, line: str, m: str):
+        if self.rtimer_second is None:
+            print(f"Ignoring dump line before a dump header at {time}")
+            return
+
+        data = base64.b64decode(m.group(1))
+
+        for (ident, start, duration) in SAMPLE.iter_unpack(data):
+            name = PROF_IDS.get(ident, f"unknown{ident}")
+            us = duration * 1e6 / self.rtimer_second
+
+            self.samples.append(ProfSample(time, name, start, us))
+
+def global_summary(results: Dict[str, ProfAnalyser]):
+    combined = defaultdict(list)
+
+    for a in results.values():
+        for (name, us) in a.by_name().items():
+            combined[name].append(us)
+
+    print("Global:")
+
+    for (name, uss) in sorted(combined.items()):
+        print(name, "(us)", stats.describe(np.concatenate(uss)))
+
+def log_files(log_dir: pathlib.Path) -> list:
+    return list(log_dir.glob("*.pyterm.log"))
+
+def analyse_log(g: pathlib.Path) -> ProfAnalyser:
+    kind, hostname, cr, log = g.name.split(".", 3)
+
+    a = ProfAnalyser(hostname)
+
+    with open(g, 'r') as f:
+        a.analyse(f)
+
+    return a
+
+def main(log_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    results = {}
+
+    for a in analyse_logs(log_files(log_dir), analyse_log).values():
+        if not a.samples:
+            continue
+
+        a.summary()
+
+        results[a.hostname] = a
+
+    global_summary(results)
+
+    return results
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Parse profiling dumps from pyterm')
+    parser.add_argument('--log-dir', type=pathlib.Path, default="results", help='The directory which contains the log output')
+
+    args = parser.parse_args()
+
+    main(args.log_dir)
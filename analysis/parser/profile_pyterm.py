@@ -5,17 +5,27 @@ from datetime import datetime
 import re
 from dataclasses import dataclass
 import pathlib
+from typing import Dict
 
 import numpy as np
 import scipy.stats as stats
 
 from analysis.parser.common import parse_contiki
+from analysis.parser.cache import analyse_logs
 
 @dataclass(frozen=True)
 class LengthStats:
     length: int
     seconds: float
 
+@dataclass(frozen=True)
+class EdgesStats:
+    edges: int
+    seconds: float
+
+# Must be kept in sync with profile_trust_edges in wsn/profile/profile.c
+PROFILE_TRUST_EDGES = (1, 4, 16)
+
 def us_to_s(us: int) -> float:
     return us / 1000000.0
 
@@ -31,6 +41,22 @@ class ProfileAnalyser:
     RE_ENCRYPT = re.compile(r'encrypt\(([0-9]+)\), ([0-9]+) us')
     RE_DECRYPT = re.compile(r'decrypt\(([0-9]+)\), ([0-9]+) us')
 
+    RE_CERTIFICATE_DECODE = re.compile(r'certificate_decode\(\), ([0-9]+) us')
+    RE_CERTIFICATE_VERIFY = re.compile(r'certificate_verify\(\), ([0-9]+) us')
+
+    RE_SERIALISE_TRUST = re.compile(r'serialise_trust\(([0-9]+)\), ([0-9]+) us')
+    RE_PROCESS_RECEIVED_TRUST = re.compile(r'process_received_trust\(([0-9]+)\), ([0-9]+) us')
+    RE_CALCULATE_TRUST_VALUE = re.compile(r'calculate_trust_value\(([0-9]+)\), ([0-9]+) us')
+    RE_CHOOSE_EDGE = re.compile(r'choose_edge\(([0-9]+)\), ([0-9]+) us')
+
+    # Names of the stats that are recorded against the number of edges
+    EDGES_STATS = [
+        "stats_serialise_trust",
+        "stats_process_received_trust",
+        "stats_calculate_trust_value",
+        "stats_choose_edge",
+    ]
+
     def __init__(self, hostname: str):
         self.hostname = hostname
 
@@ -40,6 +66,12 @@ class ProfileAnalyser:
         self.stats_verify = []
         self.stats_encrypt = []
         self.stats_decrypt = []
+        self.stats_certificate_decode = []
+        self.stats_certificate_verify = []
+        self.stats_serialise_trust = []
+        self.stats_process_received_trust = []
+        self.stats_calculate_trust_value = []
+        self.stats_choose_edge = []
 
         self.res = {
             self.RE_SHA256_END: self._process_sha256_end,
@@ -48,8 +80,20 @@ class ProfileAnalyser:
             self.RE_VERIFY: self._process_verify,
             self.RE_ENCRYPT: self._process_encrypt,
             self.RE_DECRYPT: self._process_decrypt,
+            self.RE_CERTIFICATE_DECODE: self._process_certificate_decode,
+            self.RE_CERTIFICATE_VERIFY: self._process_certificate_verify,
+            self.RE_SERIALISE_TRUST: self._process_edges(self.stats_serialise_trust),
+            self.RE_PROCESS_RECEIVED_TRUST: self._process_edges(self.stats_process_received_trust),
+            self.RE_CALCULATE_TRUST_VALUE: self._process_edges(self.stats_calculate_trust_value),
+            self.RE_CHOOSE_EDGE: self._process_edges(self.stats_choose_edge),
         }
 
+    def __getstate__(self):
+        # The handlers are closures that cannot be pickled, they are only needed while analysing
+        state = self.__dict__.copy()
+        del state["res"]
+        return state
+
     def analyse(self, f):
         for (time, log_level, module, line) in parse_contiki(f):
 
@@ -91,6 +135,24 @@ class ProfileAnalyser:
             print("decrypt (u)", stats.describe(self.stats_decrypt_u))
             print("decrypt (n)", stats.describe(self.stats_decrypt_n))
 
+        if self.stats_certificate_decode:
+            print("certificate_decode", stats.describe(self.stats_certificate_decode))
+
+        if self.stats_certificate_verify:
+            print("certificate_verify", stats.describe(self.stats_certificate_verify))
+
+        for name in self.EDGES_STATS:
+            xs = getattr(self, name)
+            if not xs:
+                continue
+
+            for edges in sorted({x.edges for x in xs}):
+                seconds = [x.seconds for x in xs if x.edges == edges]
+
+                setattr(self, f"{name}_{edges}", seconds)
+
+                print(f"{name[len('stats_'):]} ({edges} edges)", stats.describe(seconds))
+
     def _process_sha256_end(self, time: datetime, log_level: str, module: str, line: str, m: str):
         m_len = int(m.group(1))
         m_s = us_to_s(int(m.group(2)))
@@ -124,6 +186,25 @@ class ProfileAnalyser:
 
         self.stats_decrypt.append(LengthStats(m_len, m_s))
 
+    def _process_certificate_decode(self, time: datetime, log_level: str, module: str, line: str, m: str):
+        m_s = us_to_s(int(m.group(1)))
+
+        self.stats_certificate_decode.append(m_s)
+
+    def _process_certificate_verify(self, time: datetime, log_level: str, module: str, line: str, m: str):
+        m_s = us_to_s(int(m.group(1)))
+
+        self.stats_certificate_verify.append(m_s)
+
+    def _process_edges(self, into: list):
+        def process(time: datetime, log_level: str, module: str, line: str, m: str):
+            m_edges = int(m.group(1))
+            m_s = us_to_s(int(m.group(2)))
+
+            into.append(EdgesStats(m_edges, m_s))
+
+        return process
+
 def print_mean_ci(name: str, x: np.array, confidence: float=0.95):
     mean, sem, n = np.mean(x), stats.sem(x), len(x)
     ci = mean - stats.t.interval(0.95, len(x)-1, loc=np.mean(x), scale=stats.sem(x))[0]
@@ -149,6 +230,12 @@ def global_summary(results: Dict[str, ProfileAnalyser]):
         "stats_encrypt_n",
         "stats_decrypt_u",
         "stats_decrypt_n",
+        "stats_certificate_decode",
+        "stats_certificate_verify",
+    ] + [
+        f"{name}_{edges}"
+        for name in ProfileAnalyser.EDGES_STATS
+        for edges in PROFILE_TRUST_EDGES
     ]
 
     print("Global:")
@@ -163,31 +250,39 @@ def global_summary(results: Dict[str, ProfileAnalyser]):
             print_mean_ci(name, combined)
 
 
-def main(log_dir: pathlib.Path):
-    print(f"Looking for results in {log_dir}")
-
-    gs = log_dir.glob("profile.*.pyterm.log")
-
-    results = {}
-
-    for g in gs:
-        print(f"Processing {g}...")
-        bg = os.path.basename(g)
+def log_files(log_dir: pathlib.Path) -> list:
+    result = []
 
-        kind, hostname, cr, log = bg.split(".", 3)
+    for g in log_dir.glob("profile.*.pyterm.log"):
+        kind, hostname, cr, log = g.name.split(".", 3)
 
         if kind != "profile":
             print(f"Can only have challenge_response results from a profile node instead of {kind}")
             continue
 
-        a = ProfileAnalyser(hostname)
+        result.append(g)
 
-        with open(g, 'r') as f:
-            a.analyse(f)
+    return result
+
+def analyse_log(g: pathlib.Path) -> ProfileAnalyser:
+    kind, hostname, cr, log = g.name.split(".", 3)
+
+    a = ProfileAnalyser(hostname)
+
+    with open(g, 'r') as f:
+        a.analyse(f)
+
+    return a
+
+def main(log_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    results = {}
 
+    for a in analyse_logs(log_files(log_dir), analyse_log).values():
         a.summary()
 
-        results[hostname] = a
+        results[a.hostname] = a
 
     global_summary(results)
 
@@ -9,16 +9,34 @@ import ipaddress
 import textwrap
 import pathlib
 import itertools
+from dataclasses import dataclass
 
 from resource_rich.root.keystore import Keystore
 
+import common.configuration
 from common.configuration import hostname_to_ips
 
 from tools.keygen.util import ip_to_eui64
 
+from analysis.parser.cache import analyse_logs
+
 import pyshark
 from pyshark.packet.packet import Packet
 
+def packet_length(packet: Packet) -> int:
+    # Count the length of the fragments, if this packet was fragmented
+    if '6lowpan' in packet and hasattr(packet['6lowpan'], "reassembled_length"):
+        return int(packet['6lowpan'].reassembled_length)
+    else:
+        return int(packet.length)
+
+@dataclass(frozen=True)
+class PacketSummary:
+    """The fields of a dissected packet that the graphs need, unlike a pyshark Packet this can be cached"""
+    number: int
+    sniff_timestamp: float
+    length: int
+
 class PcapAnalyser:
     def __init__(self, hostname: str, quiet: bool=False):
         self.hostname = hostname
@@ -50,7 +68,7 @@ class PcapAnalyser:
 
         self.quiet = quiet
 
-    def get_tx_rx_list(self, packet: Packet) -> Dict[str, List[Packet]]:
+    def get_tx_rx_list(self, packet: Packet) -> Dict[str, List[PacketSummary]]:
         try:
             addr = ipaddress.IPv6Address(packet['6lowpan'].src)
             is_tx = addr in self.addrs
@@ -75,8 +93,8 @@ class PcapAnalyser:
             for layer in layers:
                 print(layer, {n: getattr(packet[layer], n) for n in packet[layer].field_names})
 
-    def _record_type(self, packet: Packet, xx: Dict[str, List[Packet]], kind: str):
-        xx[kind].append(packet)
+    def _record_type(self, packet: Packet, xx: Dict[str, List[PacketSummary]], kind: str):
+        xx[kind].append(PacketSummary(int(packet.number), float(packet.sniff_timestamp), packet_length(packet)))
 
         self.packet_kinds[int(packet.number)] = kind
         
@@ -254,40 +272,67 @@ class PcapAnalyser:
             self._print_packet_attributes(packet)
             raise RuntimeError(f"Unprocessed general packet")
 
-def main(log_dir: pathlib.Path, quiet: bool=False) -> Dict[str, PcapAnalyser]:
-    print(f"Looking for results in {log_dir}")
+def log_files(log_dir: pathlib.Path) -> list:
+    kind_options = {"wsn", "edge", "adversary"}
+
+    result = []
+
+    for g in log_dir.glob("*.pcap"):
+        kind, hostname, *_ = g.name.split(".")
+
+        if kind not in kind_options:
+            print(f"Can only have pcap results from one of {kind_options}")
+            continue
+
+        result.append(g)
+
+    return result
+
+def oscore_contexts(g: pathlib.Path) -> pathlib.Path:
+    return g.parent / "keystore" / "oscore.contexts.uat"
+
+def cache_dependencies(g: pathlib.Path) -> list:
+    """The analysis also depends on the addresses of the devices and the keys used to decrypt OSCORE"""
+    return [pathlib.Path(common.configuration.__file__), oscore_contexts(g)]
+
+def _analyse_log(g: pathlib.Path, quiet: bool) -> PcapAnalyser:
+    kind, hostname, *_ = g.name.split(".")
 
     override_prefs={
-        'oscore.contexts': str((log_dir / "keystore" / "oscore.contexts.uat").resolve())
+        'oscore.contexts': str(oscore_contexts(g).resolve())
     }
 
-    gs = log_dir.glob("*.pcap")
+    a = PcapAnalyser(hostname, quiet)
 
-    results = {}
+    # Need pass "-2" in order for packets to be processed twice,
+    # this means that fragments will be reassembled
+    with pyshark.FileCapture(str(g), override_prefs=override_prefs, custom_parameters=["-2"], debug=True, keep_packets=False) as cap:
+        a.analyse(cap)
 
-    for g in gs:
-        print(f"Processing {g}...")
+    return a
 
-        kind, hostname, *_ = g.name.split(".")
+# Only pcaps that have changed since they were last analysed are dissected by tshark,
+# the rest are loaded from the cache along with the other parsed logs
+def analyse_log(g: pathlib.Path) -> PcapAnalyser:
+    return _analyse_log(g, quiet=True)
 
-        kind_options = {"wsn", "edge", "adversary"}
-        if kind not in kind_options:
-            print(f"Can only have pcap results from one of {kind_options}")
-            continue
+def analyse_log_verbose(g: pathlib.Path) -> PcapAnalyser:
+    return _analyse_log(g, quiet=False)
+
+def main(log_dir: pathlib.Path, quiet: bool=False) -> Dict[str, PcapAnalyser]:
+    print(f"Looking for results in {log_dir}")
 
-        a = PcapAnalyser(hostname, quiet)
+    analysed = analyse_logs(log_files(log_dir), analyse_log if quiet else analyse_log_verbose)
 
-        # Need pass "-2" in order for packets to be processed twice,
-        # this means that fragments will be reassembled
-        with pyshark.FileCapture(str(g), override_prefs=override_prefs, custom_parameters=["-2"], debug=True, keep_packets=False) as cap:
-            a.analyse(cap)
+    results = {}
 
+    for a in analysed.values():
         print(a.hostname, a.addrs, a.eui64)
         print(f"Tx Addrs: {a.tx_addrs}")
         print(f"Rx Addrs: {a.rx_addrs}")
         print()
 
-        results[hostname] = a
+        results[a.hostname] = a
 
     return results
 
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+
+import os
+import re
+from datetime import datetime
+from dataclasses import dataclass
+from ipaddress import IPv6Address
+from typing import Optional, List
+import pathlib
+
+from analysis.parser.common import parse_contiki
+from analysis.parser.event_log import parse_events, decode_tm_update, EventId, TrustMetric
+from tools.keygen.util import ip_to_eui64
+
+# Must be kept in sync with REPLAY_TRACE_HEADER in wsn/sim/replay.c
+TRACE_HEADER = "# tm-trace 1"
+
+# The applications that use choose_edge to pick where to send a task
+CHOOSE_APPLICATIONS = {"envmon", "routing"}
+
+# Must be kept in sync with wsn/applications/challenge-response/challenge-response.h
+CHALLENGE_RESPONSE_APPLICATION_NAME = "cr"
+
+# Must be kept in sync with tm_challenge_response_type_t and tm_edge_ping_action_t in wsn/common/trust/trust-models.h
+TM_CHALLENGE_RESPONSE_RESP = 2
+TM_PING_SENT = 1
+TM_PING_RECEIVED = 2
+TM_PING_TIMEOUT = 3
+
+@dataclass(frozen=True)
+class TraceRecord:
+    time: datetime
+    kind: str
+    fields: tuple
+
+    # Pings are logged by both edge-ping and some trust models
+    from_edge_ping: bool = False
+
+    def line(self, start: datetime) -> str:
+        ms = round((self.time - start).total_seconds() * 1000)
+        return " ".join([str(ms), self.kind] + [str(field) for field in self.fields])
+
+def eui64_of(addr: str) -> str:
+    return ip_to_eui64(IPv6Address(addr)).hex()
+
+class TraceAnalyser:
+    """Extracts the trust model updates and edge choices of one node from its pyterm log,
+    in the format that wsn/sim/replay reads"""
+
+    RE_ANNOUNCE = re.compile(r'Added capability \((.+)\) for edge with identity (.+)')
+    RE_REMOVE = re.compile(r'Removed capability (.+) from (.+)')
+    RE_REMOVE_ALL = re.compile(r'Removed all capabilities for edge (.+)')
+
+    # The text that TM_LOG_UPDATE_BEGIN logs in each trust model
+    RE_UPDATES = [
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) capability (\S+) TM task_submission \(req=(-?[0-9]+), coap=(-?[0-9]+)\): '),
+            lambda m: (m.group(2), TrustMetric.TASK_SUBMISSION, int(m.group(3)), int(m.group(4)))),
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) capability (\S+) TM task_result \(result=([0-9]+)\): '),
+            lambda m: (m.group(2), TrustMetric.TASK_RESULT, int(m.group(3)), 0)),
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) capability (\S+) TM result_quality \(good=([0-9]+)\): '),
+            lambda m: (m.group(2), TrustMetric.RESULT_QUALITY, int(m.group(3)), 0)),
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) capability (\S+) TM throughput (in|out) \(([0-9]+) bytes/tick\): '),
+            lambda m: (m.group(2), TrustMetric.THROUGHPUT, 0 if m.group(3) == "in" else 1, int(m.group(4)))),
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) TM cr \(type=([0-9]+),good=([0-9]+)\): '),
+            lambda m: (None, TrustMetric.CHALLENGE_RESP, int(m.group(2)), int(m.group(3)))),
+        # Only logged when a reply is received
+        (re.compile(r'Updating Edge ([0-9a-f]{16}) TM last ping: '),
+            lambda m: (None, TrustMetric.LAST_PING, TM_PING_RECEIVED, 0)),
+    ]
+
+    RE_PING_SENT = re.compile(r'Pinging edge (\S+) seq=')
+    RE_PING_TIMEOUT = re.compile(r'No reply to ping seq=[0-9]+ from edge (\S+)')
+    RE_PING_RECEIVED = re.compile(r'Received ping response seq=[0-9]+ from (\S+)')
+
+    RE_MESSAGE_SENT = re.compile(r'Message sent to coaps?://\[(.+)\]')
+
+    def __init__(self, hostname: str):
+        self.hostname = hostname
+
+        self.start = None
+
+        self.records: List[TraceRecord] = []
+
+    def analyse(self, path: pathlib.Path):
+        with open(path, 'r') as f:
+            for (time, log_level, module, line) in parse_contiki(f):
+                self._analyse_line(time, module, line)
+
+        # Logs with EVENT_LOG_ENABLED record updates as binary events instead of text
+        with open(path, 'r') as f:
+            for event in parse_events(f):
+                if self.start is None:
+                    self.start = event.time
+
+                if event.kind == EventId.TM_UPDATE:
+                    update = decode_tm_update(event)
+                    self._add_update(update.time, update.edge_id, update.capability, update.metric, *update.observation)
+
+        # Every ping is in the edge-ping log, the trust model only logs those that change its state
+        if any(record.from_edge_ping for record in self.records):
+            self.records = [
+                record for record in self.records
+                if record.from_edge_ping or record.kind != "update" or record.fields[2] != TrustMetric.LAST_PING
+            ]
+
+        # Stable, so records at the same time stay in the order they were logged
+        self.records.sort(key=lambda record: record.time)
+
+    def _analyse_line(self, time: datetime, module: str, line: str):
+        if self.start is None:
+            self.start = time
+
+        if line.startswith("Updating Edge "):
+            for (r, f) in self.RE_UPDATES:
+                m = r.match(line)
+                if m is not None:
+                    self._add_update(time, m.group(1), *f(m))
+                    break
+            return
+
+        if module == "edge-ping":
+            for (r, action) in ((self.RE_PING_SENT, TM_PING_SENT),
+                                (self.RE_PING_TIMEOUT, TM_PING_TIMEOUT),
+                                (self.RE_PING_RECEIVED, TM_PING_RECEIVED)):
+                m = r.match(line)
+                if m is not None:
+                    self.records.append(TraceRecord(time, "update",
+                        (eui64_of(m.group(1)), "-", int(TrustMetric.LAST_PING), action, 0), from_edge_ping=True))
+                    break
+            return
+
+        if module.startswith("A-") and module[2:] in CHOOSE_APPLICATIONS:
+            m = self.RE_MESSAGE_SENT.match(line)
+            if m is not None:
+                self.records.append(TraceRecord(time, "choose", (module[2:], eui64_of(m.group(1)))))
+            return
+
+        m = self.RE_ANNOUNCE.match(line)
+        if m is not None:
+            self.records.append(TraceRecord(time, "announce", (eui64_of(m.group(2)), m.group(1))))
+            return
+
+        m = self.RE_REMOVE.match(line)
+        if m is not None:
+            self.records.append(TraceRecord(time, "remove", (eui64_of(m.group(2)), m.group(1))))
+            return
+
+        m = self.RE_REMOVE_ALL.match(line)
+        if m is not None:
+            self.records.append(TraceRecord(time, "remove", (eui64_of(m.group(1)), "-")))
+            return
+
+    def _add_update(self, time: datetime, edge_id: str, capability: Optional[str], metric: TrustMetric, obs1: int, obs2: int):
+        # The basic family of models record challenge-responses as the result quality of the cr capability,
+        # replay them as challenge-responses so that models that handle them differently can be compared
+        if metric == TrustMetric.RESULT_QUALITY and capability == CHALLENGE_RESPONSE_APPLICATION_NAME:
+            (capability, metric, obs1, obs2) = (None, TrustMetric.CHALLENGE_RESP, TM_CHALLENGE_RESPONSE_RESP, obs1)
+
+        self.records.append(TraceRecord(time, "update", (edge_id, capability or "-", int(metric), int(obs1), int(obs2))))
+
+    def write(self, path: pathlib.Path):
+        with open(path, 'w') as f:
+            print(f"{TRACE_HEADER} {self.hostname}", file=f)
+            print(f"# start {self.start.isoformat()}", file=f)
+
+            for record in self.records:
+                print(record.line(self.start), file=f)
+
+    def summary(self):
+        kinds = {}
+        for record in self.records:
+            kinds[record.kind] = kinds.get(record.kind, 0) + 1
+
+        print(f"{self.hostname}: " + ", ".join(f"{count} {kind}" for (kind, count) in sorted(kinds.items())))
+
+def main(log_dir: pathlib.Path, out_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    gs = log_dir.glob("*.pyterm.log")
+
+    out_dir.mkdir(parents=True, exist_ok=True)
+
+    results = {}
+
+    for g in gs:
+        print(f"Processing {g}...")
+        bg = os.path.basename(g)
+
+        kind, hostname, cr, log = bg.split(".", 3)
+
+        a = TraceAnalyser(hostname)
+        a.analyse(g)
+
+        # Edges and the root do not have a trust model
+        if not any(record.kind == "update" for record in a.records):
+            continue
+
+        a.summary()
+        a.write(out_dir / f"{hostname}.trace")
+
+        results[hostname] = a
+
+    print(f"Saved {len(results)} trace(s) to {out_dir}")
+
+    return results
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Extract the trust model updates and edge choices from pyterm logs for wsn/sim/replay')
+    parser.add_argument('--log-dir', type=pathlib.Path, default="results", help='The directory which contains the log output')
+    parser.add_argument('--out-dir', type=pathlib.Path, default="traces", help='The directory to save a trace for each node to')
+
+    args = parser.parse_args()
+
+    main(args.log_dir, args.out_dir)
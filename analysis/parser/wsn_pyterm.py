@@ -14,6 +14,8 @@ from collections import defaultdict, Counter
 from pprint import pprint
 
 from analysis.parser.common import parse_contiki
+from analysis.parser.cache import analyse_logs
+from analysis.parser.event_log import parse_events, decode_tm_update, EventId, TrustMetric
 
 class ChallengeResponseType(IntEnum):
     NO_ACK = 0
@@ -92,6 +94,16 @@ class Task:
     time: datetime
     details: Union[MonitoringTask, RoutingTask]
 
+@dataclass(frozen=True)
+class HedgeStats:
+    tasks: int
+    hedged: int
+    hedge_won: int
+    latency_saved_ms: int
+
+    def hedge_rate(self) -> float:
+        return self.hedged / self.tasks if self.tasks else 0.0
+
 @dataclass(frozen=True)
 class TrustValue:
     target: str
@@ -146,6 +158,8 @@ class ChallengeResponseAnalyser:
 
     RE_TASK_SENT = re.compile(r'Message sent to coap://\[(.+)\]:5683')
 
+    RE_ROUTING_HEDGE_STATS = re.compile(r'Hedge stats: tasks=([0-9]+) hedged=([0-9]+) hedge_won=([0-9]+) latency_saved=([0-9]+)ms')
+
     RE_CHOOSE_BANDED_TRUST_VALUE = re.compile(r'Trust value for edge ([0-9A-Fa-f]+) and capability ([0-9A-Za-z]+)=([0-9.-]+) at ([0-9]+)/([0-9]+)')
 
 
@@ -184,6 +198,8 @@ class ChallengeResponseAnalyser:
         self.tasks = []
         self._pending_tasks = {}
 
+        self.routing_hedge_stats = None
+
         self.trust_choose = None
 
         self.reputation_receive_from = {}
@@ -249,6 +265,10 @@ class ChallengeResponseAnalyser:
                     t = Task(m_target, time, task_details)
                     self.tasks.append(t)
 
+                elif line.startswith("Hedge stats"):
+                    m = self.RE_ROUTING_HEDGE_STATS.match(line)
+                    self.routing_hedge_stats = HedgeStats(*[int(x) for x in m.groups()])
+
             elif module == "A-envmon":
                 if line.startswith("Generated message"):
                     m = self.RE_MONITORING_GENERATED.match(line)
@@ -365,6 +385,31 @@ class ChallengeResponseAnalyser:
 
             #print((time, module, line))
 
+        # Firmware built with EVENT_LOG_ENABLED logs trust model updates as binary events
+        f.seek(0)
+        for event in parse_events(f):
+            if event.kind == EventId.TM_UPDATE:
+                self._process_tm_update_event(decode_tm_update(event))
+
+    def _process_tm_update_event(self, e):
+        if e.metric == TrustMetric.CHALLENGE_RESP:
+            cr = ChallengeResponse(ChallengeResponseType(e.observation[0]), bool(e.observation[1]))
+            tm_from = EdgeResourceTM(*e.tm_from)
+            tm_to = EdgeResourceTM(*e.tm_to)
+
+        elif e.metric == TrustMetric.THROUGHPUT:
+            cr = Throughput(e.capability, ThroughputDirection(e.observation[0]), e.observation[1])
+            tm_from = ThroughputTM(*e.tm_from)
+            tm_to = ThroughputTM(*e.tm_to)
+
+        else:
+            # Other trust model
+            return
+
+        u = TrustModelUpdate(e.time, e.edge_id, cr, tm_from, tm_to)
+
+        self.tm_updates.append(u)
+
     def _process_updating_edge_cr(self, time, log_level, module, line):
         # print(line)
         m = self.RE_TRUST_UPDATING_CR.match(line)
@@ -476,29 +521,37 @@ class ChallengeResponseAnalyser:
 
 
 
-def main(log_dir: pathlib.Path):
-    print(f"Looking for results in {log_dir}")
-
-    gs = log_dir.glob("*.pyterm.log")
-
-    results = {}
+def log_files(log_dir: pathlib.Path) -> list:
+    result = []
 
-    for g in gs:
-        print(f"Processing {g}...")
-        bg = os.path.basename(g)
-
-        kind, hostname, cr, log = bg.split(".", 3)
+    for g in log_dir.glob("*.pyterm.log"):
+        kind, hostname, cr, log = g.name.split(".", 3)
 
         if kind != "wsn":
             print("Can only have challenge_response results from an wsn node")
             continue
 
-        a = ChallengeResponseAnalyser(hostname)
+        result.append(g)
+
+    return result
+
+def analyse_log(g: pathlib.Path) -> ChallengeResponseAnalyser:
+    kind, hostname, cr, log = g.name.split(".", 3)
 
-        with open(g, 'r') as f:
-            a.analyse(f)
+    a = ChallengeResponseAnalyser(hostname)
+
+    with open(g, 'r') as f:
+        a.analyse(f)
+
+    return a
+
+def main(log_dir: pathlib.Path):
+    print(f"Looking for results in {log_dir}")
+
+    results = {}
 
-        results[hostname] = a
+    for a in analyse_logs(log_files(log_dir), analyse_log).values():
+        results[a.hostname] = a
 
     return results
 
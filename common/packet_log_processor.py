@@ -1,44 +1,90 @@
-from datetime import datetime, timezone
+import logging
+from datetime import datetime
+
+logger = logging.getLogger("packet-log")
+
+# Must be kept in sync with PCAP_PREFIX in wsn/common/pcap/pcap-loggers.c
+PCAP_LOG_MARKER = "#"
+
+PACKET_KINDS = ("in", "out", "outres")
 
 class PacketLogProcessor:
     def __init__(self):
         self.previous_out = None
 
     def process_all(self, f):
-        packets = []
+        return zip(*self.process_lines(f))
 
+    def process_lines(self, f):
+        """Yields (message, kind, time) for each packet received or successfully sent"""
         for line in f:
             result = self.process(line)
             if result is not None:
-                packets.append(result)
-
-        return zip(*packets)
+                yield result
 
     def process(self, line: str):
         line = line.rstrip()
 
+        # The #In|, #Out| and #OutRes| lines from pcap-loggers.c, as logged by pyterm
+        if line.startswith(PCAP_LOG_MARKER) or " # " in line:
+            return self._process_raw(line)
+
         (time, kind, rest) = line.split(",", 2)
+        (length, rest) = rest.split(",")
 
-        if kind == "in":
-            now = datetime.now(timezone.utc) if time is None else datetime.fromisoformat(time)
+        result = self._process_kind(time, kind, int(length), rest)
+        if result is False:
+            raise RuntimeError(f"Unknown line {line}")
 
-            length, message = rest.split(",")
-            return self._process_in(int(length), bytes.fromhex(message), now=now)
+        return result
 
-        elif kind == "out":
-            now = datetime.now(timezone.utc) if time is None else datetime.fromisoformat(time)
+    def _process_raw(self, line: str):
+        time = None
+
+        if " # " in line:
+            (time, line) = line.split(" # ", 1)
+
+        # Other output from the node
+        if not line.startswith(PCAP_LOG_MARKER):
+            return None
 
-            length, message = rest.split(",")
-            return self._process_out(int(length), bytes.fromhex(message), now=now)
+        try:
+            (kind, length, rest) = line[len(PCAP_LOG_MARKER):].split("|")
+        except ValueError:
+            return None
 
-        elif kind == "outres":
-            now = datetime.now(timezone.utc) if time is None else datetime.fromisoformat(time)
+        # Other output that happens to look like a packet log line
+        kind = kind.lower()
+        if kind not in PACKET_KINDS:
+            return None
 
-            length, result = rest.split(",")
-            return self._process_out_res(int(length), int(result), now=now)
+        try:
+            length = int(length)
+        except ValueError:
+            return None
+
+        # When the packet was logged is only known from pyterm's timestamp
+        if time is None:
+            logger.warning(f"Ignoring packet without a timestamp {line}")
+            return None
+
+        return self._process_kind(time, kind, length, rest)
+
+    def _process_kind(self, time: str, kind: str, length: int, rest: str):
+        """Returns False if kind is not a packet log line"""
+        if kind not in PACKET_KINDS:
+            return False
+
+        now = datetime.fromisoformat(time)
+
+        if kind == "in":
+            return self._process_in(length, bytes.fromhex(rest), now=now)
+
+        elif kind == "out":
+            return self._process_out(length, bytes.fromhex(rest), now=now)
 
         else:
-            raise RuntimeError(f"Unknown line {line}")
+            return self._process_out_res(length, int(rest), now=now)
 
     def _process_in(self, length: int, message: bytes, now: datetime):
         if length != len(message):
@@ -0,0 +1,42 @@
+from __future__ import annotations
+
+import struct
+from datetime import datetime
+
+# See https://www.tcpdump.org/linktypes.html
+LINKTYPE_IEEE802_15_4_NOFCS = 230
+
+PCAP_MAGIC = 0xa1b2c3d4
+PCAP_VERSION = (2, 4)
+PCAP_SNAPLEN = 0xffff
+
+# magic, version major, version minor, thiszone, sigfigs, snaplen, network
+PCAP_HEADER = struct.Struct("<IHHiIII")
+
+# ts_sec, ts_usec, incl_len, orig_len
+PCAP_RECORD_HEADER = struct.Struct("<IIII")
+
+class PcapWriter:
+    """Writes frames to a libpcap file, without needing tshark to do it"""
+    def __init__(self, path, linktype: int=LINKTYPE_IEEE802_15_4_NOFCS):
+        self.path = path
+        self.linktype = linktype
+        self.count = 0
+
+        self.f = None
+
+    def __enter__(self):
+        self.f = open(self.path, "wb")
+        self.f.write(PCAP_HEADER.pack(PCAP_MAGIC, *PCAP_VERSION, 0, 0, PCAP_SNAPLEN, self.linktype))
+        return self
+
+    def __exit__(self, exception_type, exception_value, traceback):
+        self.f.close()
+
+    def write(self, message: bytes, time: datetime):
+        (ts_sec, ts_usec) = divmod(round(time.timestamp() * 1_000_000), 1_000_000)
+
+        self.f.write(PCAP_RECORD_HEADER.pack(ts_sec, ts_usec, len(message), len(message)))
+        self.f.write(message)
+
+        self.count += 1
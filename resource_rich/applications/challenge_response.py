@@ -6,10 +6,10 @@ import logging
 import time
 import math
 import base64
-import hashlib
 
 from config import serial_sep
 import client_common
+import challenge_solver
 
 NAME = "cr"
 
@@ -33,18 +33,17 @@ def _task_runner(task):
             timeout = True
             break
 
-        prefix = prefix_int.to_bytes((prefix_int.bit_length() + 7) // 8, byteorder='big')
-
-        m = hashlib.sha256()
-        m.update(prefix)
-        m.update(data)
-        digest = m.digest()
+        # Search a batch of prefixes at a time
+        found = challenge_solver.find_prefix(data, difficulty, prefix_int, challenge_solver.batch_size)
 
         # Have we found a suitable prefix
-        if all(x == 0 for x in digest[0:difficulty]):
+        if found is not None:
+            prefix_int = found
             break
         else:
-            prefix_int += 1
+            prefix_int += challenge_solver.batch_size
+
+    prefix = challenge_solver.prefix_bytes(prefix_int)
 
     end_timer = time.perf_counter()
     duration = end_timer - start_timer
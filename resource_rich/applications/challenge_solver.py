@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+"""Find a prefix such that sha256(prefix || data) starts with `difficulty` zero bytes.
+
+Uses the native solver in native/ when it has been built (with `make -C native`),
+otherwise falls back to hashlib."""
+
+import ctypes
+import hashlib
+import logging
+from pathlib import Path
+from typing import Optional
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger("challenge-solver")
+logger.setLevel(logging.DEBUG)
+
+_lib_path = Path(__file__).parent / "native" / "libchallengesolver.so"
+
+try:
+    _lib = ctypes.CDLL(str(_lib_path))
+    _lib.challenge_solve.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_uint,
+                                     ctypes.c_uint64, ctypes.c_uint64, ctypes.POINTER(ctypes.c_uint64)]
+    _lib.challenge_solve.restype = ctypes.c_int
+except OSError as ex:
+    logger.warning(f"Native challenge solver not available ({ex}), using hashlib")
+    _lib = None
+
+# How many prefixes to try before returning, so the caller can check for timeouts
+batch_size = 1 << 18 if _lib is not None else 1 << 12
+
+def prefix_bytes(prefix_int: int) -> bytes:
+    return prefix_int.to_bytes((prefix_int.bit_length() + 7) // 8, byteorder='big')
+
+def _find_prefix_hashlib(data: bytes, difficulty: int, start: int, count: int) -> Optional[int]:
+    for prefix_int in range(start, start + count):
+        m = hashlib.sha256()
+        m.update(prefix_bytes(prefix_int))
+        m.update(data)
+        digest = m.digest()
+
+        if all(x == 0 for x in digest[0:difficulty]):
+            return prefix_int
+
+    return None
+
+def find_prefix(data: bytes, difficulty: int, start: int, count: int) -> Optional[int]:
+    """Returns the smallest prefix integer in [start, start + count) that solves the challenge"""
+    if _lib is not None:
+        found = ctypes.c_uint64()
+        ret = _lib.challenge_solve(data, len(data), difficulty, start, count, ctypes.byref(found))
+        if ret == 1:
+            return found.value
+        elif ret == 0:
+            return None
+
+        # The native solver cannot handle these parameters
+        logger.warning(f"Native challenge solver failed for data of length {len(data)}, using hashlib")
+
+    return _find_prefix_hashlib(data, difficulty, start, count)
+
+if __name__ == "__main__":
+    import argparse
+    import os
+    import time
+
+    parser = argparse.ArgumentParser(description='Compare the native and hashlib challenge solvers')
+    parser.add_argument('-d', '--difficulty', type=int, default=2, help='The number of leading zero bytes')
+    parser.add_argument('-n', '--challenges', type=int, default=5, help='The number of random challenges to solve')
+    args = parser.parse_args()
+
+    for _ in range(args.challenges):
+        data = os.urandom(32)
+
+        start_timer = time.perf_counter()
+        native = find_prefix(data, args.difficulty, 0, 1 << 40)
+        native_duration = time.perf_counter() - start_timer
+
+        start_timer = time.perf_counter()
+        python = _find_prefix_hashlib(data, args.difficulty, 0, 1 << 40)
+        python_duration = time.perf_counter() - start_timer
+
+        assert native == python
+
+        print(f"prefix={native} native={native_duration:.4f}s hashlib={python_duration:.4f}s speedup={python_duration/native_duration:.1f}x")
@@ -18,6 +18,9 @@ logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger("app-client")
 logger.setLevel(logging.DEBUG)
 
+# Stats are decoded as uint32_t by the nodes
+stats_max_value = 2**32 - 1
+
 class Client:
 
     # This comes from Contiki-NG's circular buffer
@@ -110,8 +113,7 @@ class Client:
             logger.error(f"Failed to parse message '{message}' with {ex}")
             return
 
-        loop = asyncio.get_running_loop()
-        task_result = await loop.run_in_executor(self.executor, self._task_runner, (src, dt, payload))
+        task_result = await self._run_task((src, dt, payload))
 
         (dest, message_response, duration) = task_result
 
@@ -123,6 +125,11 @@ class Client:
         async with self.response_lock:
             await self._send_result(dest, message_response)
 
+    async def _run_task(self, task):
+        # Tasks are CPU bound, so run them in the process pool
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(self.executor, self._task_runner, task)
+
     async def _send_result(self, dest, message_response):
         raise NotImplementedError()
 
@@ -163,16 +170,18 @@ class Client:
         await self._receive_ack()
 
     def _stats_string(self) -> str:
+        # Durations are in seconds, but are sent in milliseconds (and variance in milliseconds^2)
+        # so nodes can use them to estimate how long tasks will take
         try:
-            variance = int(math.ceil(self.stats.variance()))
+            variance = self.stats.variance() * 1000 * 1000
         except ZeroDivisionError:
             variance = 0
 
-        mean = int(math.ceil(self.stats.mean()))
-        maximum = int(math.ceil(self.stats.maximum()))
-        minimum = int(math.ceil(self.stats.minimum()))
+        mean = self.stats.mean() * 1000
+        maximum = self.stats.maximum() * 1000
+        minimum = self.stats.minimum() * 1000
 
-        data = (mean, maximum, minimum, variance)
+        data = tuple(min(int(math.ceil(x)), stats_max_value) for x in (mean, maximum, minimum, variance))
 
         return base64.b64encode(cbor2.dumps(data)).decode("utf-8")
 
@@ -0,0 +1,218 @@
+// Brute force solver for the challenge-response application.
+//
+// Finds the smallest prefix such that sha256(prefix || data) starts with
+// `difficulty` zero bytes. The prefix is the minimal big-endian encoding
+// of an integer (0 is the empty prefix), matching challenge_response.py.
+//
+// prefix || data fits in a single SHA-256 block, so each candidate costs one
+// compression. Candidates are hashed LANES at a time using GCC/Clang vector
+// extensions, so the compiler can use SSE/AVX/NEON without platform specific code.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef LANES
+#define LANES 8
+#endif
+
+typedef uint32_t vu32 __attribute__((vector_size(LANES * sizeof(uint32_t))));
+
+#define SHA256_BLOCK_LEN 64
+// Leave space for the 0x80 padding byte and the 64-bit length
+#define SHA256_MAX_SINGLE_BLOCK_MSG_LEN (SHA256_BLOCK_LEN - 1 - 8)
+
+#define MAX_PREFIX_LEN 8
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static inline uint32_t
+load_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static size_t
+prefix_len(uint64_t v)
+{
+    size_t len = 0;
+    while (v != 0)
+    {
+        len += 1;
+        v >>= 8;
+    }
+    return len;
+}
+
+static void
+write_prefix(uint8_t* block, uint64_t v, size_t len)
+{
+    for (size_t i = 0; i != len; ++i)
+    {
+        block[len - 1 - i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+// Hash the LANES blocks and write the resulting digest words, digest[word][lane]
+static void
+sha256_compress_lanes(const uint32_t w_in[16][LANES], uint32_t digest[8][LANES])
+{
+    vu32 w[16];
+    for (int i = 0; i != 16; ++i)
+    {
+        memcpy(&w[i], w_in[i], sizeof(w[i]));
+    }
+
+    vu32 a = (vu32){0} + IV[0], b = (vu32){0} + IV[1], c = (vu32){0} + IV[2], d = (vu32){0} + IV[3];
+    vu32 e = (vu32){0} + IV[4], f = (vu32){0} + IV[5], g = (vu32){0} + IV[6], h = (vu32){0} + IV[7];
+
+    for (int t = 0; t != 64; ++t)
+    {
+        if (t >= 16)
+        {
+            const vu32 w2 = w[(t - 2) & 15];
+            const vu32 w15 = w[(t - 15) & 15];
+            const vu32 s0 = ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3);
+            const vu32 s1 = ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10);
+            w[t & 15] += s0 + w[(t - 7) & 15] + s1;
+        }
+
+        const vu32 S1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+        const vu32 ch = (e & f) ^ (~e & g);
+        const vu32 t1 = h + S1 + ch + K[t] + w[t & 15];
+        const vu32 S0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+        const vu32 maj = (a & b) ^ (a & c) ^ (b & c);
+        const vu32 t2 = S0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    const vu32 out[8] = {a + IV[0], b + IV[1], c + IV[2], d + IV[3], e + IV[4], f + IV[5], g + IV[6], h + IV[7]};
+    for (int i = 0; i != 8; ++i)
+    {
+        memcpy(digest[i], &out[i], sizeof(out[i]));
+    }
+}
+
+static int
+has_leading_zero_bytes(const uint32_t digest[8][LANES], size_t lane, unsigned difficulty)
+{
+    for (unsigned i = 0; i != difficulty; ++i)
+    {
+        const uint32_t word = digest[i / 4][lane];
+        const uint8_t byte = (uint8_t)(word >> (24 - 8 * (i % 4)));
+        if (byte != 0)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Search the prefixes [start, start + count) for a solution.
+// Returns 1 and sets *found to the smallest solution, 0 if there was no solution,
+// or -1 if the parameters cannot be handled (the caller should fall back to another solver).
+int
+challenge_solve(const uint8_t* data, size_t data_len, unsigned difficulty,
+                uint64_t start, uint64_t count, uint64_t* found)
+{
+    if (difficulty > 32 || found == NULL)
+    {
+        return -1;
+    }
+
+    const uint64_t end = (UINT64_MAX - start < count) ? UINT64_MAX : start + count;
+
+    uint64_t i = start;
+    while (i < end)
+    {
+        const size_t len = prefix_len(i);
+        if (len + data_len > SHA256_MAX_SINGLE_BLOCK_MSG_LEN)
+        {
+            return -1;
+        }
+
+        // All prefixes with the same length share the rest of the block
+        const uint64_t len_limit = (len == MAX_PREFIX_LEN) ? UINT64_MAX : ((uint64_t)1 << (8 * len));
+        const uint64_t limit = end < len_limit ? end : len_limit;
+
+        uint8_t block[SHA256_BLOCK_LEN] = {0};
+        memcpy(block + len, data, data_len);
+        block[len + data_len] = 0x80;
+        const uint64_t bit_len = (uint64_t)(len + data_len) * 8;
+        for (int j = 0; j != 8; ++j)
+        {
+            block[SHA256_BLOCK_LEN - 1 - j] = (uint8_t)(bit_len >> (8 * j));
+        }
+
+        // Only the first few words change with the prefix
+        const size_t varying_words = (len + 3) / 4;
+
+        uint32_t w[16][LANES];
+        for (size_t k = varying_words; k != 16; ++k)
+        {
+            const uint32_t word = load_be32(block + 4 * k);
+            for (size_t lane = 0; lane != LANES; ++lane)
+            {
+                w[k][lane] = word;
+            }
+        }
+
+        while (i < limit)
+        {
+            const uint64_t remaining = limit - i;
+            const size_t batch = remaining < LANES ? (size_t)remaining : LANES;
+
+            for (size_t lane = 0; lane != LANES; ++lane)
+            {
+                // Unused lanes repeat the last candidate and are ignored
+                const uint64_t candidate = i + (lane < batch ? lane : batch - 1);
+                write_prefix(block, candidate, len);
+
+                for (size_t k = 0; k != varying_words; ++k)
+                {
+                    w[k][lane] = load_be32(block + 4 * k);
+                }
+            }
+
+            uint32_t digest[8][LANES];
+            sha256_compress_lanes(w, digest);
+
+            for (size_t lane = 0; lane != batch; ++lane)
+            {
+                if (has_leading_zero_bytes(digest, lane, difficulty))
+                {
+                    *found = i + lane;
+                    return 1;
+                }
+            }
+
+            i += batch;
+        }
+    }
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 #!/usr/bin/env python3
 
+from __future__ import annotations
+
 import cbor2
 from pyroutelib3 import Router
 
@@ -8,6 +10,10 @@ import struct
 import time
 import math
 import base64
+import asyncio
+from collections import OrderedDict, deque
+from concurrent.futures import ThreadPoolExecutor
+from typing import Optional, Tuple
 from more_itertools import chunked
 
 from config import serial_sep
@@ -33,6 +39,16 @@ def _format_route(route):
         in route
     ]
 
+# Each process pool worker keeps its own router, so OSM tiles are loaded once per worker
+# rather than once per task
+_router: Optional[Router] = None
+
+def _get_router() -> Router:
+    global _router
+    if _router is None:
+        _router = Router("car")
+    return _router
+
 def _task_runner(task):
     (src, dt, (node_time, routing_source, routing_destination)) = task
 
@@ -42,7 +58,7 @@ def _task_runner(task):
 
     start_timer = time.perf_counter()
 
-    router = Router("car")
+    router = _get_router()
 
     start = router.findNode(routing_source[0], routing_source[1])
     end = router.findNode(routing_destination[0], routing_destination[1])
@@ -67,6 +83,53 @@ def _task_runner(task):
 
     return (src, encoded_route, duration)
 
+class RouteCache:
+    """LRU cache of encoded routes keyed on the OSM nodes the source and destination snap to"""
+    def __init__(self, capacity: int):
+        self.capacity = capacity
+        self.routes = OrderedDict()
+        self.hits = 0
+        self.misses = 0
+
+    def get(self, key):
+        try:
+            encoded_route = self.routes[key]
+        except KeyError:
+            self.misses += 1
+            return None
+
+        self.routes.move_to_end(key)
+        self.hits += 1
+        return encoded_route
+
+    def put(self, key, encoded_route):
+        self.routes[key] = encoded_route
+        self.routes.move_to_end(key)
+
+        while len(self.routes) > self.capacity:
+            self.routes.popitem(last=False)
+
+    def hit_rate(self) -> float:
+        total = self.hits + self.misses
+        return self.hits / total if total else 0.0
+
+class LatencyWindow:
+    """The most recent task latencies, used to report the mean and p99"""
+    def __init__(self, size: int=1000):
+        self.latencies = deque(maxlen=size)
+
+    def push(self, latency: float):
+        self.latencies.append(latency)
+
+    def mean(self) -> float:
+        return sum(self.latencies) / len(self.latencies) if self.latencies else 0.0
+
+    def p99(self) -> float:
+        if not self.latencies:
+            return 0.0
+        ordered = sorted(self.latencies)
+        return ordered[min(len(ordered) - 1, math.ceil(len(ordered) * 0.99) - 1)]
+
 class RoutingClient(client_common.Client):
 
     task_resp1_prefix = f"app{serial_sep}resp1{serial_sep}"
@@ -74,9 +137,67 @@ class RoutingClient(client_common.Client):
 
     coap_max_chunk_size = 256
 
-    def __init__(self):
+    def __init__(self, route_cache_size: int=1024):
         super().__init__(NAME, task_runner=_task_runner, max_workers=2)
 
+        # Nodes in the same area ask for near identical routes, so snap the source and destination
+        # to OSM nodes here and only dispatch tasks to the process pool when the route is not cached.
+        # Snapping may need to load tiles, so it is done on a single thread to keep the router private.
+        self.snap_router = Router("car")
+        self.snap_executor = ThreadPoolExecutor(max_workers=1)
+
+        self.route_cache = RouteCache(route_cache_size)
+
+        # Latency of all tasks and of those that were not cached, to show the effect of the cache
+        self.latency = LatencyWindow()
+        self.uncached_latency = LatencyWindow()
+
+    async def stop(self):
+        self.snap_executor.shutdown()
+        await super().stop()
+
+    def _snap(self, routing_source, routing_destination) -> Tuple[Optional[int], Optional[int]]:
+        start = self.snap_router.findNode(routing_source[0], routing_source[1])
+        end = self.snap_router.findNode(routing_destination[0], routing_destination[1])
+        return (start, end)
+
+    async def _run_task(self, task):
+        (src, dt, (node_time, routing_source, routing_destination)) = task
+
+        start_timer = time.perf_counter()
+
+        loop = asyncio.get_running_loop()
+        key = await loop.run_in_executor(self.snap_executor, self._snap, routing_source, routing_destination)
+
+        cacheable = None not in key
+
+        encoded_route = self.route_cache.get(key) if cacheable else None
+        if encoded_route is not None:
+            duration = time.perf_counter() - start_timer
+
+            logger.debug(f"Route cache hit for {key} from {src} took {duration} seconds")
+
+            task_result = (src, encoded_route, duration)
+        else:
+            task_result = await super()._run_task(task)
+
+            (_, encoded_route, _) = task_result
+
+            # Do not cache unknown routing errors, they may not happen again
+            if cacheable and encoded_route[0] != 3:
+                self.route_cache.put(key, encoded_route)
+
+            self.uncached_latency.push(time.perf_counter() - start_timer)
+
+        self.latency.push(time.perf_counter() - start_timer)
+
+        logger.info(f"Route cache hits={self.route_cache.hits} misses={self.route_cache.misses} "
+                    f"hit_rate={self.route_cache.hit_rate():.1%} "
+                    f"latency mean={self.latency.mean():.4f}s p99={self.latency.p99():.4f}s "
+                    f"uncached mean={self.uncached_latency.mean():.4f}s p99={self.uncached_latency.p99():.4f}s")
+
+        return task_result
+
     async def _send_result(self, dest, message_response):
         status, route = message_response
 
@@ -24,15 +24,32 @@ class InvalidAddressRequest(error.BadRequest):
 class UnknownAddressRequest(error.BadRequest):
     message = "Error: Unknown IP Address requested"
 
+class TooManyAddressesRequest(error.BadRequest):
+    message = "Error: Too many IP Addresses requested"
+
 ipv6_byte_len = 16
 
+# Limit the size of the response to a batch request
+max_batch_addresses = 32
+
+def normalise_address(request_address: ipaddress.IPv6Address) -> ipaddress.IPv6Address:
+    # Convert to global address, if request is for link-local
+    if str(request_address).startswith("fe80"):
+        global_request_address = ipaddress.IPv6Address("fd00" + str(request_address)[4:])
+
+        logger.info(f"Request is for link-local address {request_address}, converting to global address {global_request_address}")
+
+        request_address = global_request_address
+
+    return request_address
+
 class COAPKeyServer(resource.Resource):
     def __init__(self, keystore: Keystore):
         super().__init__()
         self.keystore = keystore
 
     async def render_get(self, request):
-        """An MQTT Subscribe request"""
+        """A request for a single certificate"""
 
         try:
             if request.opt.content_format == media_types_rev['text/plain;charset=utf-8']:
@@ -52,13 +69,7 @@ class COAPKeyServer(resource.Resource):
 
         logger.info(f"Received request for {request_address} from {request.remote}")
 
-        # Convert to global address, if request is for link-local
-        if str(request_address).startswith("fe80"):
-            global_request_address = ipaddress.IPv6Address("fd00" + str(request_address)[4:])
-
-            logger.info(f"Request is for link-local address {request_address}, converting to global address {global_request_address}")
-
-            request_address = global_request_address
+        request_address = normalise_address(request_address)
 
         try:
             cert = self.keystore.get_cert(request_address)
@@ -67,6 +78,41 @@ class COAPKeyServer(resource.Resource):
 
         return aiocoap.Message(payload=cert, content_format=media_types_rev['application/cbor'])
 
+class COAPKeyBatchServer(resource.Resource):
+    """Serves the certificates of many addresses in one request.
+
+    The request is a CBOR array of addresses (either 16 byte strings or text),
+    the response is a CBOR array of the certificates in the same order
+    with null for unknown addresses."""
+    def __init__(self, keystore: Keystore):
+        super().__init__()
+        self.keystore = keystore
+
+    async def render_post(self, request):
+        if request.opt.content_format != media_types_rev['application/cbor']:
+            raise error.UnsupportedContentFormat()
+
+        try:
+            payload = cbor2.loads(request.payload)
+            if not isinstance(payload, list):
+                raise InvalidAddressRequest()
+
+            request_addresses = [ipaddress.IPv6Address(addr) for addr in payload]
+
+        except (ValueError, UnicodeDecodeError, cbor2.CBORDecodeError):
+            raise InvalidAddressRequest()
+
+        if len(request_addresses) > max_batch_addresses:
+            raise TooManyAddressesRequest()
+
+        logger.info(f"Received batch request for {len(request_addresses)} addresses from {request.remote}")
+
+        request_addresses = [normalise_address(addr) for addr in request_addresses]
+
+        certs = self.keystore.encode_certs(request_addresses)
+
+        return aiocoap.Message(payload=certs, content_format=media_types_rev['application/cbor'])
+
 
 def main(key_dir, coap_target_port):
     logger.info("Starting coap key server")
@@ -74,11 +120,13 @@ def main(key_dir, coap_target_port):
     loop = asyncio.get_event_loop()
 
     keystore = Keystore(key_dir)
+    keystore.preload()
 
     coap_site = resource.Site()
     coap_site.add_resource(['.well-known', 'core'],
         resource.WKCResource(coap_site.get_resources_as_linkheader, impl_info=None))
     coap_site.add_resource(['key'], COAPKeyServer(keystore))
+    coap_site.add_resource(['keys'], COAPKeyBatchServer(keystore))
 
     try:
         loop.create_task(aiocoap.Context.create_server_context(coap_site))
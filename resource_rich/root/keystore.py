@@ -1,6 +1,7 @@
 import logging
 import os
 import ipaddress
+from typing import Iterable, List, Optional
 
 from common.certificate import SignedCertificate
 
@@ -12,6 +13,19 @@ logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger("keystore")
 logger.setLevel(logging.DEBUG)
 
+def _cbor_array_header(length: int) -> bytes:
+    """The CBOR header for a definite length array (major type 4)"""
+    if length < 24:
+        return bytes([0x80 | length])
+    elif length < 2**8:
+        return bytes([0x98]) + length.to_bytes(1, "big")
+    elif length < 2**16:
+        return bytes([0x99]) + length.to_bytes(2, "big")
+    else:
+        return bytes([0x9a]) + length.to_bytes(4, "big")
+
+CBOR_NULL = bytes([0xf6])
+
 class Keystore:
     def __init__(self, key_dir):
         self.key_dir = key_dir
@@ -24,6 +38,24 @@ class Keystore:
         # Load the server's public/private key
         self.privkey = self._load_privkey(os.path.join(key_dir, "private.pem"))
 
+    def preload(self):
+        """Load every public key and certificate in the key directory, so requests
+        do not need to wait for disk access when many nodes are booting together."""
+        count = 0
+
+        for addr in self.list_addresses():
+            self.get_pubkey(addr)
+
+            try:
+                self.get_cert(addr)
+            except FileNotFoundError:
+                logger.warning(f"No certificate available for {addr}")
+                continue
+
+            count += 1
+
+        logger.info(f"Preloaded {count} certificates from {self.key_dir}")
+
     def list_addresses(self):
         with os.scandir(self.key_dir) as it:
             for entry in it:
@@ -91,6 +123,27 @@ class Keystore:
 
         return cert
 
+    def get_certs(self, request_addresses: Iterable[ipaddress.IPv6Address]) -> List[Optional[bytes]]:
+        """Get the encoded certificates of many addresses, None is returned for unknown addresses"""
+        result = []
+
+        for request_address in request_addresses:
+            try:
+                result.append(self.get_cert(request_address))
+            except FileNotFoundError:
+                result.append(None)
+
+        return result
+
+    def encode_certs(self, request_addresses: Iterable[ipaddress.IPv6Address]) -> bytes:
+        """Encode a CBOR array of the certificates for the addresses.
+
+        Certificates are stored already CBOR encoded, so they are placed
+        into the array as they are rather than being decoded and re-encoded."""
+        certs = self.get_certs(request_addresses)
+
+        return _cbor_array_header(len(certs)) + b"".join(CBOR_NULL if cert is None else cert for cert in certs)
+
     def oscore_ident(self, request_address) -> bytes:
         cert = SignedCertificate.decode(self.get_cert(request_address))
 
@@ -9,6 +9,7 @@ import urllib.parse
 import copy
 import pickle
 import os
+import ipaddress
 
 import asyncio_mqtt
 import asyncio_mqtt.error
@@ -57,6 +58,10 @@ class SubscriptionManager:
                 # No subscriptions, so do not need to subscribe
                 return False
 
+    async def is_subscribed(self, topic: str, source: str) -> bool:
+        async with self._lock:
+            return source in self._subscriptions.get(topic, ())
+
     async def subscribe(self, topic: str, source: str):
         async with self._lock:
             self._subscriptions[topic].add(source)
@@ -189,6 +194,9 @@ class MQTTCOAPBridge:
         topic = self._coap_request_extract_mqtt_topic(request)
         host = self._coap_request_extract_host(request)
 
+        # Only the first subscription to a topic is new, re-subscribing to it does not trigger a publish
+        new_subscriber = not await self.manager.is_subscribed(topic, host)
+
         if await self.manager.should_subscribe(topic, host):
             await self.mqtt_connector.client.subscribe(topic)
 
@@ -200,8 +208,24 @@ class MQTTCOAPBridge:
         logger.info(f"Subscribed {host} to {topic}")
         await self.manager.subscribe(topic, host)
 
+        # Edges reset their announce and capability publish intervals when told of
+        # a new device, so it does not have to wait for their next slow publish
+        if new_subscriber:
+            await self._publish_new_subscriber(host)
+
         return result
 
+    async def _publish_new_subscriber(self, host: str):
+        # Same conversion from an IPv6 address to an identity as eui64_from_ipaddr
+        iid = bytearray(ipaddress.IPv6Address(host).packed[8:])
+        iid[0] ^= 0x02
+
+        topic = f"edge/{iid.hex()}/subscribed"
+
+        logger.info(f"Notifying edges of new subscriber {host} on {topic}")
+
+        await self.mqtt_connector.client.publish(topic, b"")
+
     async def coap_to_mqtt_unsubscribe(self, request: aiocoap.Message) -> aiocoap.Message:
         topic = self._coap_request_extract_mqtt_topic(request)
         host = self._coap_request_extract_host(request)
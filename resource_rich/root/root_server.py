@@ -5,7 +5,7 @@ import asyncio
 import signal
 import ipaddress
 
-from .coap_key_server import COAPKeyServer
+from .coap_key_server import COAPKeyServer, COAPKeyBatchServer
 from .mqtt_coap_bridge import MQTTCOAPBridge
 from .stereotype_server import StereotypeServer
 
@@ -99,6 +99,7 @@ def main(mqtt_database,
     loop = asyncio.get_event_loop()
 
     keystore = Keystore(key_directory)
+    keystore.preload()
     server_credentials = keystore_aiocoap_oscore_credentials(keystore)
 
     coap_site = resource.Site()
@@ -108,6 +109,9 @@ def main(mqtt_database,
     key_server = COAPKeyServer(keystore)
     coap_site.add_resource(['key'], OscoreSiteWrapper(key_server, server_credentials))
 
+    key_batch_server = COAPKeyBatchServer(keystore)
+    coap_site.add_resource(['keys'], OscoreSiteWrapper(key_batch_server, server_credentials))
+
     bridge = MQTTCOAPBridge(mqtt_database)
     coap_site.add_resource(['mqtt'], OscoreSiteWrapper(bridge.coap_connector, server_credentials))
 
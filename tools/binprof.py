@@ -15,21 +15,6 @@ import argparse
 # https://web.archive.org/web/20190317203555/https://www.embeddedrelated.com/showarticle/900.php
 # They looked up details with readelf/objdump
 
-parser = argparse.ArgumentParser(description='RAM and Flash profiling')
-parser.add_argument('binary', type=str, help='The path to the binary to profile')
-parser.add_argument('--other', type=str, default="other", help='What to classify unknown memory as')
-parser.add_argument('--no-error-if-unknown', action='store_true', default=False, help='Raise an error if there is memory classified as other')
-args = parser.parse_args()
-
-result = subprocess.run(
-    f"nm --print-size --size-sort --radix=d --line-numbers {args.binary}",
-    check=True,
-    shell=True,
-    capture_output=True,
-    encoding="utf-8",
-    universal_newlines=True,
-)
-
 @dataclass(frozen=True)
 class Result:
     position: int
@@ -42,31 +27,43 @@ class Result:
         super().__setattr__("position", int(self.position))
         super().__setattr__("size", int(self.size))
 
-flash_symb = []
-ram_symb = []
+def load_symbols(binary):
+    result = subprocess.run(
+        f"nm --print-size --size-sort --radix=d --line-numbers {binary}",
+        check=True,
+        shell=True,
+        capture_output=True,
+        encoding="utf-8",
+        universal_newlines=True,
+    )
+
+    flash_symb = []
+    ram_symb = []
 
-for line in result.stdout.split("\n"):
-    if not line:
-        continue
+    for line in result.stdout.split("\n"):
+        if not line:
+            continue
 
-    details = line.split(' ')
+        details = line.split(' ')
 
-    if "\t" in details[-1]:
-        details = details[:-1] + details[-1].split("\t")
+        if "\t" in details[-1]:
+            details = details[:-1] + details[-1].split("\t")
 
-    r = Result(*details)
+        r = Result(*details)
 
-    # Contiki's ramprof picks up [abdrw] and flashprof picks up [t] (both case insensitive)
+        # Contiki's ramprof picks up [abdrw] and flashprof picks up [t] (both case insensitive)
 
-    if r.symbol_type in "Tt":
-        flash_symb.append(r)
-    elif r.symbol_type in "abdrwABDRW":
-        ram_symb.append(r)
-    elif r.symbol_type in "Nn":
-        # Debug symbol
-        pass
-    else:
-        raise RuntimeError(f"Unknown symbol type {r}")
+        if r.symbol_type in "Tt":
+            flash_symb.append(r)
+        elif r.symbol_type in "abdrwABDRW":
+            ram_symb.append(r)
+        elif r.symbol_type in "Nn":
+            # Debug symbol
+            pass
+        else:
+            raise RuntimeError(f"Unknown symbol type {r}")
+
+    return flash_symb, ram_symb
 
 def summarise(symbs):
     return sum(x.size for x in symbs)
@@ -190,6 +187,9 @@ def classify(symb, other="other"):
     if any(osdir in symb.location for osdir in ("os/lib", "os/sys", "os/dev", "os/contiki")):
         return "contiki-ng"
 
+    if "common/crypto/keystore" in symb.location:
+        return "system/keystore"
+
     if "common/crypto" in symb.location:
         return "system/crypto"
 
@@ -199,6 +199,9 @@ def classify(symb, other="other"):
     if "wsn/node" in symb.location or "wsn/edge" in symb.location:
         return "system/common"
 
+    if "wsn/common" in symb.location:
+        return "system/common"
+
     return other
 
 
@@ -210,69 +213,111 @@ def classify_all(symbs, other="other"):
 
     return dict(result)
 
-classified_ram_symb = classify_all(ram_symb, other=args.other)
-summarised_ram_symb = {k: summarise(v) for k, v in classified_ram_symb.items()}
-
-classified_flash_symb = classify_all(flash_symb, other=args.other)
-summarised_flash_symb = {k: summarise(v) for k, v in classified_flash_symb.items()}
-
-if "other" in classified_ram_symb or "other" in classified_flash_symb:
-    try:
-        print("RAM unknown:")
-        pprint(classified_ram_symb["other"])
-    except KeyError:
-        pass
-
-    try:
-        print("Flash unknown:")
-        pprint(classified_flash_symb["other"])
-    except KeyError:
-        pass
-
-    if not args.no_error_if_unknown:
-        raise RuntimeError("Symbols with an unknown classification")
-
-total_flash_symb = sum(summarised_flash_symb.values())
-total_ram_symb = sum(summarised_ram_symb.values())
-
-keys = set(summarised_ram_symb.keys()) | set(classified_flash_symb.keys())
-for k in sorted(keys):
-    k_sum_flash = summarised_flash_symb.get(k, 0)
-    k_sum_flash_pc = round(100*k_sum_flash/total_flash_symb, 1)
-
-    k_sum_ram = summarised_ram_symb.get(k, 0)
-    k_sum_ram_pc = round(100*k_sum_ram/total_ram_symb, 1)
-
-    print(f"{k} & {k_sum_flash} & {k_sum_flash_pc} & {k_sum_ram} & {k_sum_ram_pc} \\\\")
-print("\\midrule")
-print(f"Total Used & {total_flash_symb} & 100 & {total_ram_symb} & 100 \\\\")
-print()
-
-config = [
-    ('Certificates', 'PUBLIC_KEYSTORE_SIZE', 12, 'public_keys_memb'),
-    ('Stereotypes', 'MAX_NUM_STEREOTYPES', 5, 'stereotypes_memb'),
-    ('Edges', 'NUM_EDGE_RESOURCES', 4, 'edge_resources_memb'),
-    ('Edge Capabilities', 'NUM_EDGE_CAPABILITIES', 3 * 4, 'edge_capabilities_memb'),
-    ('Peers', 'NUM_PEERS', 8, 'peers_memb'),
-    ('Peer Edges', 'NUM_PEERS', 8 * 4, 'peer_edges_memb'),
-    ('Peer Edge Capabilities', 'NUM_PEERS', 8 * 4 * 3, 'peer_capabilities_memb'),
-    None,
-    ('Reputation Tx Buffer', 'TRUST_TX_SIZE', 2, 'trust_tx_memb'),
-    ('Reputation Rx Buffer', 'TRUST_RX_SIZE', 2, 'trust_rx_memb'),
-    None,
-    ('Sign Buffer', 'MESSAGES_TO_SIGN_SIZE', 3, 'messages_to_sign_memb'),
-    ('Verify Buffer', 'MESSAGES_TO_VERIFY_SIZE', 3, 'messages_to_verify_memb'),
-]
-
-for conf in config:
-    if conf is None:
+def summarise_binary(binary, other="other"):
+    """Returns the flash and RAM used by each classification in the binary"""
+    flash_symb, ram_symb = load_symbols(binary)
+
+    summarised_flash = {k: summarise(v) for k, v in classify_all(flash_symb, other=other).items()}
+    summarised_ram = {k: summarise(v) for k, v in classify_all(ram_symb, other=other).items()}
+
+    return summarised_flash, summarised_ram
+
+def main(args):
+    flash_symb, ram_symb = load_symbols(args.binary)
+
+    classified_ram_symb = classify_all(ram_symb, other=args.other)
+    summarised_ram_symb = {k: summarise(v) for k, v in classified_ram_symb.items()}
+
+    classified_flash_symb = classify_all(flash_symb, other=args.other)
+    summarised_flash_symb = {k: summarise(v) for k, v in classified_flash_symb.items()}
+
+    if "other" in classified_ram_symb or "other" in classified_flash_symb:
+        try:
+            print("RAM unknown:")
+            pprint(classified_ram_symb["other"])
+        except KeyError:
+            pass
+
+        try:
+            print("Flash unknown:")
+            pprint(classified_flash_symb["other"])
+        except KeyError:
+            pass
+
+        if not args.no_error_if_unknown:
+            raise RuntimeError("Symbols with an unknown classification")
+
+    total_flash_symb = sum(summarised_flash_symb.values())
+    total_ram_symb = sum(summarised_ram_symb.values())
+
+    keys = set(summarised_ram_symb.keys()) | set(classified_flash_symb.keys())
+    for k in sorted(keys):
+        k_sum_flash = summarised_flash_symb.get(k, 0)
+        k_sum_flash_pc = round(100*k_sum_flash/total_flash_symb, 1)
+
+        k_sum_ram = summarised_ram_symb.get(k, 0)
+        k_sum_ram_pc = round(100*k_sum_ram/total_ram_symb, 1)
+
+        print(f"{k} & {k_sum_flash} & {k_sum_flash_pc} & {k_sum_ram} & {k_sum_ram_pc} \\\\")
+    print("\\midrule")
+    print(f"Total Used & {total_flash_symb} & 100 & {total_ram_symb} & 100 \\\\")
+    print()
+
+    config = [
+        ('Certificates', 'PUBLIC_KEYSTORE_SIZE', 12, 'public_keys_memb'),
+        ('Stereotypes', 'MAX_NUM_STEREOTYPES', 5, 'stereotypes_memb'),
+        ('Edges', 'NUM_EDGE_RESOURCES', 4, 'edge_resources_memb'),
+        ('Edge Capabilities', 'NUM_EDGE_CAPABILITIES', 3 * 4, 'edge_capabilities_memb'),
+        ('Peers', 'NUM_PEERS', 8, 'peers_memb'),
+        ('Peer Edges', 'NUM_PEERS', 8 * 4, 'peer_edges_memb'),
+        ('Peer Edge Capabilities', 'NUM_PEERS', 8 * 4 * 3, 'peer_capabilities_memb'),
+        None,
+        ('Reputation Tx Buffer', 'TRUST_TX_SIZE', 2, 'trust_tx_memb'),
+        ('Reputation Rx Buffer', 'TRUST_RX_SIZE', 2, 'trust_rx_memb'),
+        None,
+        ('Sign Buffer', 'MESSAGES_TO_SIGN_SIZE', 3, 'messages_to_sign_memb'),
+        ('Verify Buffer', 'MESSAGES_TO_VERIFY_SIZE', 3, 'messages_to_verify_memb'),
+    ]
+
+    for conf in config:
+        if conf is None:
+            print("\\midrule")
+            continue
+
+        (nice_name, cname, num, vname) = conf
+        try:
+            [symb] = [x for x in ram_symb if x.name == vname + "_memb_mem"]
+            size = symb.size
+            print(f"{nice_name} & {num} & {int(size/num)} & {size} \\\\ % {vname}")
+        except ValueError:
+            print(f"Missing {vname}")
+
+    if args.baseline is not None:
+        # For example, to see how much static RAM moving buffers to the scratch arena saved
+        baseline_flash_symb, baseline_ram_symb = load_symbols(args.baseline)
+
+        baseline_ram = {k: summarise(v) for k, v in classify_all(baseline_ram_symb, other=args.other).items()}
+        baseline_flash = {k: summarise(v) for k, v in classify_all(baseline_flash_symb, other=args.other).items()}
+
+        print()
+        print(f"Saved compared to {args.baseline} (Flash, RAM):")
+
+        keys = set(baseline_ram.keys()) | set(baseline_flash.keys()) | set(summarised_ram_symb.keys()) | set(summarised_flash_symb.keys())
+        for k in sorted(keys):
+            saved_flash = baseline_flash.get(k, 0) - summarised_flash_symb.get(k, 0)
+            saved_ram = baseline_ram.get(k, 0) - summarised_ram_symb.get(k, 0)
+
+            if saved_flash != 0 or saved_ram != 0:
+                print(f"{k} & {saved_flash} & {saved_ram} \\\\")
         print("\\midrule")
-        continue
-
-    (nice_name, cname, num, vname) = conf
-    try:
-        [symb] = [x for x in ram_symb if x.name == vname + "_memb_mem"]
-        size = symb.size
-        print(f"{nice_name} & {num} & {int(size/num)} & {size} \\\\ % {vname}")
-    except ValueError:
-        print(f"Missing {vname}")
+        print(f"Total Saved & {sum(baseline_flash.values()) - total_flash_symb} & {sum(baseline_ram.values()) - total_ram_symb} \\\\")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='RAM and Flash profiling')
+    parser.add_argument('binary', type=str, help='The path to the binary to profile')
+    parser.add_argument('--other', type=str, default="other", help='What to classify unknown memory as')
+    parser.add_argument('--no-error-if-unknown', action='store_true', default=False, help='Raise an error if there is memory classified as other')
+    parser.add_argument('--baseline', type=str, default=None, help='A binary built before a change, to report the RAM and Flash it saved')
+    args = parser.parse_args()
+
+    main(args)
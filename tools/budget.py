@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+from __future__ import annotations
+
+import argparse
+import subprocess
+import shutil
+import pathlib
+import shlex
+import json
+import sys
+import os
+from contextlib import contextmanager
+from dataclasses import dataclass
+from typing import Optional
+
+from tools.binprof import summarise_binary
+
+# The scripts under these directories describe the firmware that experiments are run with
+setup_script_dirs = ["tests/scenarios", "tests/papers"]
+
+default_baseline = "tests/budget/baseline.json"
+
+# Must be kept in sync with Setup._target_build_args in tools/setup.py
+target_build_args = {
+    "remote-revb": {
+        "TARGET": "zoul",
+        "PLATFORM": "remote-revb",
+    },
+    "nRF52840DK": {
+        "TARGET": "nrf52840",
+        "BOARD": "dk",
+    },
+    "nRF52833DK": {
+        "TARGET": "nrf52833",
+        "BOARD": "dk",
+    },
+}
+
+@dataclass(frozen=True)
+class Configuration:
+    trust_model: str
+    trust_choose: str
+    applications: tuple[str, ...]
+    target: str
+    with_pcap: bool
+    with_adversary: tuple[str, ...]
+    with_bad_edge: tuple[str, ...]
+    defines: tuple[tuple[str, str], ...]
+
+    @property
+    def binaries(self) -> list[str]:
+        # The same binaries that tools/setup.py builds
+        binaries = ["node", "edge"]
+        if self.with_adversary:
+            binaries.append("adversary")
+        if self.with_bad_edge:
+            binaries.append("bad_edge")
+        return binaries
+
+    def build_args(self, binary: str) -> dict[str, str]:
+        build_args = {
+            "TRUST_MODEL": self.trust_model,
+            "TRUST_CHOOSE": self.trust_choose,
+            "APPLICATIONS": '"' + " ".join(self.applications) + '"',
+            "MAKE_ATTACKS": "dummy",
+        }
+
+        build_args.update(target_build_args[self.target])
+
+        if self.with_pcap:
+            build_args["MAKE_WITH_PCAP"] = "1"
+
+        if self.defines:
+            build_args["ADDITIONAL_CFLAGS"] = '"' + " ".join([f"-D{k}='{v}'" for (k,v) in self.defines]) + '"'
+
+        if binary == "adversary" and self.with_adversary:
+            build_args["MAKE_ATTACKS"] = ",".join(self.with_adversary)
+        if binary == "bad_edge" and self.with_bad_edge:
+            build_args["MAKE_ATTACKS"] = ",".join(self.with_bad_edge)
+
+        return build_args
+
+def setup_parser() -> argparse.ArgumentParser:
+    # Only the tools/setup.py arguments that change what is built
+    parser = argparse.ArgumentParser(add_help=False)
+    parser.add_argument('trust_model', type=str)
+    parser.add_argument('trust_choose', type=str)
+    parser.add_argument('--applications', nargs="+", type=str, default=[])
+    parser.add_argument('--with-pcap', action='store_true')
+    parser.add_argument('--with-adversary', nargs="*", type=str, default=[])
+    parser.add_argument('--with-bad-edge', nargs="*", type=str, default=[])
+    parser.add_argument('--defines', nargs=2, action='append', default=[])
+    parser.add_argument('--target', type=str, default="remote-revb")
+    return parser
+
+def parse_setup_script(path: pathlib.Path) -> Optional[Configuration]:
+    with open(path, "r") as f:
+        contents = f.read().replace("\\\n", " ")
+
+    for line in contents.splitlines():
+        tokens = shlex.split(line, comments=True)
+
+        if "tools.setup" not in tokens:
+            continue
+
+        (args, _) = setup_parser().parse_known_args(tokens[tokens.index("tools.setup")+1:])
+
+        return Configuration(args.trust_model, args.trust_choose, tuple(args.applications), args.target,
+                             args.with_pcap, tuple(args.with_adversary or []), tuple(args.with_bad_edge or []),
+                             tuple(tuple(define) for define in args.defines))
+
+    return None
+
+def find_configurations() -> dict[str, Configuration]:
+    """Finds the unique configurations, named by the first setup script that uses them"""
+    configurations = {}
+
+    for setup_script_dir in setup_script_dirs:
+        for path in sorted(pathlib.Path(setup_script_dir).glob("*/setup*.sh")):
+            configuration = parse_setup_script(path)
+            if configuration is None:
+                print(f"No tools.setup command in {path}, skipping")
+                continue
+
+            if configuration in configurations.values():
+                continue
+
+            name = str(path.relative_to("tests").with_suffix(""))
+
+            configurations[name] = configuration
+
+    return configurations
+
+@contextmanager
+def default_static_keys():
+    # The keys do not change the memory used, so build with the defaults if keys have not been generated
+    static_keys = pathlib.Path("wsn/common/crypto/static-keys.c")
+
+    if static_keys.exists():
+        yield
+        return
+
+    shutil.copy(static_keys.with_suffix(".c.default"), static_keys)
+    try:
+        yield
+    finally:
+        static_keys.unlink()
+
+def build(configuration: Configuration, binary: str, verbose_make: bool) -> pathlib.Path:
+    build_args = configuration.build_args(binary)
+
+    if verbose_make:
+        build_args["V"] = "1"
+
+    build_args_str = " ".join(f"{k}={v}" for (k,v) in build_args.items())
+
+    # Changing the defines does not cause a rebuild, so always start from clean
+    subprocess.run(f"make clean -C wsn/{binary} {build_args_str}", shell=True, check=True)
+    subprocess.run(f"make -C wsn/{binary} {build_args_str}", shell=True, check=True)
+
+    return pathlib.Path(f"wsn/{binary}/{binary}.{build_args['TARGET']}")
+
+def measure(configurations: dict[str, Configuration], verbose_make: bool) -> dict:
+    results = {}
+
+    with default_static_keys():
+        for (name, configuration) in configurations.items():
+            results[name] = {}
+
+            for binary in configuration.binaries:
+                print(f"Building {binary} for {name}")
+
+                elf = build(configuration, binary, verbose_make)
+
+                flash, ram = summarise_binary(elf)
+
+                results[name][binary] = {
+                    "flash": {"total": sum(flash.values()), **flash},
+                    "ram": {"total": sum(ram.values()), **ram},
+                }
+
+    return results
+
+def compare(results: dict, baseline: dict, thresholds: dict[str, int]) -> list[str]:
+    """Prints the change in memory for each subsystem and returns those that exceed the thresholds"""
+    regressions = []
+
+    for (name, binaries) in sorted(results.items()):
+        if name not in baseline:
+            print(f"{name}: not in baseline")
+            continue
+
+        for (binary, kinds) in sorted(binaries.items()):
+            for (kind, subsystems) in kinds.items():
+                baseline_subsystems = baseline[name].get(binary, {}).get(kind, {})
+
+                for subsystem in sorted(set(subsystems) | set(baseline_subsystems)):
+                    now = subsystems.get(subsystem, 0)
+                    before = baseline_subsystems.get(subsystem, 0)
+                    delta = now - before
+
+                    if delta == 0:
+                        continue
+
+                    where = f"{name} {binary} {kind} {subsystem}"
+
+                    print(f"{where}: {before} -> {now} ({delta:+d})")
+
+                    if delta > thresholds[kind]:
+                        regressions.append(f"{where} grew by {delta} bytes (threshold {thresholds[kind]})")
+
+    return regressions
+
+def main(args):
+    configurations = find_configurations()
+
+    if args.only:
+        configurations = {
+            name: configuration
+            for (name, configuration) in configurations.items()
+            if any(only in name for only in args.only)
+        }
+
+    if args.list:
+        for (name, configuration) in configurations.items():
+            print(name, configuration)
+        return
+
+    results = measure(configurations, args.verbose_make)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+    print(f"Saved results to {args.output}")
+
+    if args.update_baseline:
+        baseline = {}
+        if os.path.exists(args.baseline):
+            with open(args.baseline, "r") as f:
+                baseline = json.load(f)
+
+        baseline.update(results)
+
+        pathlib.Path(args.baseline).parent.mkdir(parents=True, exist_ok=True)
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=4, sort_keys=True)
+        print(f"Updated baseline {args.baseline}")
+        return
+
+    if not os.path.exists(args.baseline):
+        raise RuntimeError(f"No baseline at {args.baseline}, create one with --update-baseline")
+
+    with open(args.baseline, "r") as f:
+        baseline = json.load(f)
+
+    regressions = compare(results, baseline, {"flash": args.flash_threshold, "ram": args.ram_threshold})
+
+    if regressions:
+        print("Memory budget exceeded:")
+        for regression in regressions:
+            print(f"\t{regression}")
+        sys.exit(1)
+
+    print("Within memory budget")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='RAM and Flash budget of the firmware used in the tests')
+    parser.add_argument('--only', nargs="+", type=str, default=None, help='Only check configurations whose name contains one of these')
+    parser.add_argument('--list', action='store_true', help='List the configurations to check and exit')
+    parser.add_argument('--output', type=str, default="budget.json", help='Where to save the measured RAM and Flash')
+    parser.add_argument('--baseline', type=str, default=default_baseline, help='The RAM and Flash to compare against')
+    parser.add_argument('--update-baseline', action='store_true', help='Save the measurements as the new baseline instead of comparing')
+    parser.add_argument('--flash-threshold', type=int, default=256, help='Bytes of Flash a subsystem may grow by before it is a regression')
+    parser.add_argument('--ram-threshold', type=int, default=64, help='Bytes of RAM a subsystem may grow by before it is a regression')
+    parser.add_argument('--verbose-make', action='store_true', help='Outputs greater detail while compiling')
+    args = parser.parse_args()
+
+    main(args)
@@ -7,17 +7,28 @@ import multiprocessing.pool
 
 import regenerate_pcap
 
-def main(directory: pathlib.Path, num_procs: int, timeout: Optional[int]):
-    sources = list(directory.glob("*.packet.log"))
+def is_up_to_date(source: pathlib.Path, dest: pathlib.Path) -> bool:
+    return dest.exists() and dest.stat().st_mtime_ns >= source.stat().st_mtime_ns
+
+def main(directory: pathlib.Path, num_procs: int, force: bool):
+    sources = sorted(directory.glob("*.packet.log"))
     destinations = [src.parent / (src.name + '.pcap') for src in sources]
 
-    args = list(zip(sources, destinations, [timeout]*len(sources)))
+    args = [
+        (src, dest)
+        for (src, dest) in zip(sources, destinations)
+        if force or not is_up_to_date(src, dest)
+    ]
 
-    print(f"Generating pcaps for {sources}")
+    print(f"Generating pcaps for {[src for (src, dest) in args]}")
+    print(f"{len(sources) - len(args)} pcaps already up to date")
     print(f"using {num_procs} processes")
 
+    # Hand out one file at a time, so a few large logs do not hold up the rest
     with multiprocessing.pool.Pool(num_procs) as pool:
-        pool.starmap(regenerate_pcap.main, args)
+        counts = pool.starmap(regenerate_pcap.main, args, chunksize=1)
+
+    print(f"Wrote {sum(counts)} packets to {len(counts)} pcaps")
 
 if __name__ == "__main__":
     import argparse
@@ -25,8 +36,8 @@ if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='Regenerate pcap files from the raw log')
     parser.add_argument('directory', type=pathlib.Path, help='The directory containing multiple pcap logs to convert')
     parser.add_argument('--num-procs', type=int, required=False, default=len(os.sched_getaffinity(0)), help='The number of processes to use')
-    parser.add_argument('--timeout', type=regenerate_pcap.int_or_None, default=600, help='The timeout per file in seconds. pass "None" for no timeout.')
+    parser.add_argument('--force', action='store_true', help='Regenerate pcaps that are newer than their packet log')
 
     args = parser.parse_args()
 
-    main(args.directory, args.num_procs, args.timeout)
+    main(args.directory, args.num_procs, args.force)
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+from __future__ import annotations
+
+import argparse
+import subprocess
+import pathlib
+import shutil
+import csv
+from collections import defaultdict
+
+from tools.budget import parse_setup_script
+from tools.simulate import build_host, sim_dir
+
+def parse_model(model: str) -> tuple[str, str]:
+    try:
+        (trust_model, trust_choose) = model.split("/", 1)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"'{model}' is not trust_model/trust_choose")
+
+    return (trust_model, trust_choose)
+
+def replay(binary: pathlib.Path, trace: pathlib.Path, out_dir: pathlib.Path, args) -> str:
+    hostname = trace.stem
+
+    costs = out_dir / f"{hostname}.costs.csv"
+
+    replay_args = [
+        str(binary),
+        "--repeat", str(args.repeat),
+        "--seed", str(args.seed),
+        "--trajectory", str(out_dir / f"{hostname}.trajectory.csv"),
+        "--decisions", str(out_dir / f"{hostname}.decisions.csv"),
+        "--costs", str(costs),
+    ]
+
+    if args.log:
+        replay_args += ["--log", str(out_dir / f"wsn.{hostname}.pyterm.log")]
+
+    replay_args.append(str(trace))
+
+    subprocess.run(replay_args, check=True)
+
+    return hostname
+
+def summarise(out_dir: pathlib.Path, hostnames: list[str]) -> dict:
+    """The mean cost of each call and how often the recorded choice was made over all traces"""
+    count = defaultdict(int)
+    total_ns = defaultdict(int)
+    choices = 0
+    agree = 0
+
+    for hostname in hostnames:
+        with open(out_dir / f"{hostname}.costs.csv", newline="") as f:
+            for row in csv.DictReader(f):
+                count[row["name"]] += int(row["count"])
+                total_ns[row["name"]] += int(row["total_ns"])
+
+        with open(out_dir / f"{hostname}.decisions.csv", newline="") as f:
+            for row in csv.DictReader(f):
+                choices += 1
+                agree += int(row["agree"])
+
+    return {
+        "mean_ns": {name: total_ns[name] / count[name] for name in count if count[name] > 0},
+        "choices": choices,
+        "agree": agree,
+    }
+
+def main(args):
+    traces = sorted(args.traces.glob("*.trace")) if args.traces.is_dir() else [args.traces]
+    if not traces:
+        raise RuntimeError(f"No traces in {args.traces}, create them with analysis.parser.tm_trace")
+
+    applications = args.applications
+    defines = [tuple(define) for define in args.defines]
+
+    # Build with the same applications and defines as the firmware the traces were recorded with
+    if args.scenario is not None:
+        configuration = parse_setup_script(pathlib.Path("tests/scenarios") / args.scenario / "setup.sh")
+        if configuration is None:
+            raise RuntimeError(f"No tools.setup command for {args.scenario}")
+
+        applications = applications or list(configuration.applications)
+        defines = list(configuration.defines) + defines
+
+    summaries = {}
+
+    for (trust_model, trust_choose) in args.models:
+        name = f"{trust_model}-{trust_choose}"
+        out_dir = args.out_dir / name
+        out_dir.mkdir(parents=True, exist_ok=True)
+
+        build_host("replay", trust_model, trust_choose, applications, defines, args.nanocbor_dir)
+
+        # Keep the binary that produced the results
+        binary = out_dir / "replay"
+        shutil.copy(sim_dir / "replay", binary)
+
+        hostnames = [replay(binary, trace, out_dir, args) for trace in traces]
+
+        summaries[name] = summarise(out_dir, hostnames)
+
+    calls = sorted({call for summary in summaries.values() for call in summary["mean_ns"]})
+
+    with open(args.out_dir / "summary.csv", "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["model", "choices", "agree"] + [f"{call}_ns" for call in calls])
+
+        for (name, summary) in summaries.items():
+            writer.writerow([name, summary["choices"], summary["agree"]] +
+                            [f"{summary['mean_ns'].get(call, float('nan')):.1f}" for call in calls])
+
+    print(f"Mean ns per call over {len(traces)} trace(s), replayed {args.repeat} time(s):")
+    for (name, summary) in summaries.items():
+        agreement = 100 * summary["agree"] / summary["choices"] if summary["choices"] else float("nan")
+        print(f"{name}: chose the recorded edge {agreement:.1f}% of the time")
+        for (call, ns) in sorted(summary["mean_ns"].items()):
+            print(f"\t{call} {ns:.1f}")
+
+    print(f"Saved results to {args.out_dir}")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Replay trust model traces against other trust models and choose policies')
+    parser.add_argument('traces', type=pathlib.Path, help='A trace or directory of traces from analysis.parser.tm_trace')
+    parser.add_argument('models', nargs='+', type=parse_model, help='The trust_model/trust_choose pairs to replay with')
+    parser.add_argument('--scenario', type=str, default=None, help='Use the applications and defines of tests/scenarios/SCENARIO')
+    parser.add_argument('--applications', nargs='+', type=str, default=[], help='The applications the traces were recorded with')
+    parser.add_argument('--defines', nargs=2, action='append', default=[], help='Additional defines to build with')
+    parser.add_argument('--repeat', type=int, default=100, help='Replay each trace this many times when measuring')
+    parser.add_argument('--seed', type=int, default=0, help='Seed for choose policies that are random')
+    parser.add_argument('--log', action='store_true', help='Save the trust model output of the first replay as a pyterm log')
+    parser.add_argument('--out-dir', type=pathlib.Path, default=pathlib.Path("replay"), help='Where to save the results')
+    parser.add_argument('--nanocbor-dir', type=str, default=None, help='Where nanocbor is, if not the submodule')
+    args = parser.parse_args()
+
+    main(args)
@@ -48,6 +48,11 @@ class EdgeRunner(ApplicationRunner):
             print("Waiting for edge bridge to start before running applications...", flush=True)
             time.sleep(15)
 
+            # The challenge response applications use a native solver
+            if any(application.endswith("challenge_response") for (application, niceness, params) in self.application):
+                print("Building native challenge solver", flush=True)
+                subprocess.run("make -C resource_rich/applications/native", shell=True, check=False)
+
             apps = []
 
             print("Running applications", flush=True)
@@ -1,13 +1,14 @@
 #!/usr/bin/env python3
 
 import argparse
+import os
 
 from tools.setup import Setup as BaseSetup, available_targets
 
 class Setup(BaseSetup):
-    def __init__(self, mode: str, target: str, verbose_make: bool, deploy: str):
-        super().__init__(trust_model="basic",
-                         trust_choose=None,
+    def __init__(self, mode: str, trust_model: str, trust_choose: str, target: str, verbose_make: bool, deploy: str):
+        super().__init__(trust_model=trust_model,
+                         trust_choose=trust_choose,
                          applications=["monitoring"],
                          with_pcap=False,
                          with_adversary=None,
@@ -26,6 +27,12 @@ class Setup(BaseSetup):
             build_args["PROFILE_AES"] = 1
         elif self.mode == "ECC":
             build_args["PROFILE_ECC"] = 1
+        elif self.mode == "SHA256":
+            build_args["PROFILE_SHA256"] = 1
+        elif self.mode == "CERTIFICATE":
+            build_args["PROFILE_CERTIFICATE"] = 1
+        elif self.mode == "TRUST":
+            build_args["PROFILE_TRUST"] = 1
         else:
             raise RuntimeError(f"Unknown profile mode {self.mode}")
 
@@ -39,13 +46,23 @@ if __name__ == "__main__":
     import argparse
 
     parser = argparse.ArgumentParser(description='Setup')
-    parser.add_argument('mode', choices=['ECC', 'AES'], help='What to profile')
+    available_trust_models = [x for x in os.listdir("wsn/common/trust/models") if not x.endswith(".h")]
+    available_trust_chooses = [x for x in os.listdir("wsn/common/trust/choose") if not x.endswith(".h")]
+
+    parser.add_argument('mode', choices=['ECC', 'AES', 'SHA256', 'CERTIFICATE', 'TRUST'], help='What to profile')
+    parser.add_argument('--trust-model', choices=available_trust_models, default="basic", help='The trust model to profile')
+    parser.add_argument('--trust-choose', choices=available_trust_chooses, default=None, help='The trust choose to profile, required for TRUST')
     parser.add_argument('--target', choices=available_targets, default=available_targets[0], help="Which target to compile for")
     parser.add_argument('--verbose-make', action='store_true', help='Outputs greater detail while compiling')
     parser.add_argument('--deploy', choices=['none', 'ansible', 'fabric'], default='none', help='Choose how deployment is performed to observers')
     args = parser.parse_args()
 
+    if args.mode == "TRUST" and args.trust_choose is None:
+        parser.error("--trust-choose is required when profiling TRUST")
+
     setup = Setup(args.mode,
+                  args.trust_model,
+                  args.trust_choose,
                   args.target,
                   args.verbose_make,
                   args.deploy)
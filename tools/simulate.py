@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+from __future__ import annotations
+
+import argparse
+import subprocess
+import pathlib
+import sys
+from typing import Sequence
+
+from tools.budget import parse_setup_script
+
+sim_dir = pathlib.Path("wsn/sim")
+
+def build_host(target: str, trust_model: str, trust_choose: str, applications: Sequence[str],
+               defines: Sequence[tuple[str, str]], nanocbor_dir: str | None):
+    """Builds target (sim or replay) in wsn/sim"""
+    build_args = {
+        "TRUST_MODEL": trust_model,
+        "TRUST_CHOOSE": trust_choose,
+    }
+
+    if applications:
+        build_args["APPLICATIONS"] = " ".join(applications)
+
+    if defines:
+        build_args["ADDITIONAL_CFLAGS"] = " ".join(f"-D{k}='{v}'" for (k,v) in defines)
+
+    if nanocbor_dir is not None:
+        build_args["NANOCBOR_DIR"] = nanocbor_dir
+
+    subprocess.run(["make", "-C", str(sim_dir), target] + [f"{k}={v}" for (k,v) in build_args.items()], check=True)
+
+def build(setup_script: pathlib.Path, nanocbor_dir: str | None):
+    """Builds wsn/sim with the same trust model, choose policy, applications and defines as the scenario"""
+    configuration = parse_setup_script(setup_script)
+    if configuration is None:
+        raise RuntimeError(f"No tools.setup command in {setup_script}")
+
+    build_host("sim", configuration.trust_model, configuration.trust_choose,
+               configuration.applications, configuration.defines, nanocbor_dir)
+
+def main(args):
+    setup_script = pathlib.Path("tests/scenarios") / args.scenario / "setup.sh"
+
+    build(setup_script, args.nanocbor_dir)
+
+    sim_args = [
+        str(sim_dir / "sim"),
+        "--scenario", args.scenario,
+        "--nodes", str(args.nodes),
+        "--duration", str(args.duration),
+        "--seed", str(args.seed),
+    ]
+
+    if args.log_dir is not None:
+        args.log_dir.mkdir(parents=True, exist_ok=True)
+        sim_args += ["--log-dir", str(args.log_dir)]
+
+    sim_args += args.sim_args
+
+    result = subprocess.run(sim_args)
+    sys.exit(result.returncode)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Simulate the IoT nodes of a scenario in tests/scenarios on this machine')
+    parser.add_argument('scenario', type=str, help='The name of the scenario to simulate')
+    parser.add_argument('--nodes', type=int, default=1, help='The number of IoT nodes to simulate')
+    parser.add_argument('--duration', type=int, default=3600, help='Seconds of simulated time for each node')
+    parser.add_argument('--seed', type=int, default=0, help='The same seed always gives the same results')
+    parser.add_argument('--log-dir', type=pathlib.Path, default=None, help='Where to save the pyterm logs of each node')
+    parser.add_argument('--nanocbor-dir', type=str, default=None, help='Where nanocbor is, if not the submodule')
+    # Any other arguments (e.g., --edge or --log-level) are passed to wsn/sim/sim
+    (args, sim_args) = parser.parse_known_args()
+    args.sim_args = sim_args
+
+    main(args)
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+
+# Discrete event simulation comparing the task latency achieved by the
+# trust choose policies in wsn/common/trust/choose.
+#
+# IoT nodes submit tasks to edges which process them in FIFO order.
+# Each node only knows what it would on a real deployment: the trust value
+# of each edge, the service time stats the edge last acknowledged with
+# and how many tasks the node itself has in flight to each edge.
+
+from __future__ import annotations
+
+import argparse
+import heapq
+import itertools
+import math
+import random
+from dataclasses import dataclass, field
+from typing import Callable, Dict, List, Optional
+
+
+@dataclass
+class EdgeConfig:
+    trust: float
+    mean_service: float  # seconds
+    rtt: float  # seconds
+
+
+# (trust, mean service time, round trip time)
+default_edges = [
+    EdgeConfig(0.9, 2.0, 0.05),
+    EdgeConfig(0.8, 0.8, 0.10),
+    EdgeConfig(0.6, 1.0, 0.05),
+    EdgeConfig(0.3, 0.5, 0.20),
+]
+
+# Matches the defaults in choose/expected-delay/trust-choose.c
+default_service_ms = 250
+min_trust = 0.05
+
+
+class RunningStats:
+    """Mean of completed task durations, as the edge reports in application_stats_t"""
+    def __init__(self):
+        self.n = 0
+        self.total = 0.0
+
+    def push(self, x: float):
+        self.n += 1
+        self.total += x
+
+    def mean(self) -> Optional[float]:
+        return self.total / self.n if self.n else None
+
+
+@dataclass
+class Edge:
+    config: EdgeConfig
+    workers: int
+    busy: int = 0
+    queue: List["Task"] = field(default_factory=list)
+    stats: RunningStats = field(default_factory=RunningStats)
+
+
+@dataclass
+class NodeView:
+    """What a node knows about an edge"""
+    in_flight: int = 0
+    mean_ms: Optional[float] = None
+
+
+@dataclass
+class Task:
+    node: int
+    edge: int
+    submitted: float
+    service: float
+
+
+def choose_highest(rng, views, edges):
+    return max(range(len(edges)), key=lambda i: edges[i].config.trust)
+
+
+def choose_proportional(rng, views, edges):
+    return rng.choices(range(len(edges)), weights=[e.config.trust for e in edges])[0]
+
+
+def choose_expected_delay(rng, views, edges):
+    def score(i):
+        view = views[i]
+        service_ms = view.mean_ms if view.mean_ms is not None else default_service_ms
+        delay = (view.in_flight + 1) * service_ms + edges[i].config.rtt * 1000
+        return delay / max(edges[i].config.trust, min_trust)
+
+    return min(range(len(edges)), key=score)
+
+
+policies: Dict[str, Callable] = {
+    "highest": choose_highest,
+    "proportional": choose_proportional,
+    "expected-delay": choose_expected_delay,
+}
+
+
+def simulate(policy: Callable, edge_configs: List[EdgeConfig], nodes: int, load: float,
+             tasks: int, workers: int, seed: int) -> List[float]:
+    rng = random.Random(seed)
+
+    edges = [Edge(config, workers) for config in edge_configs]
+    views = [[NodeView() for _ in edges] for _ in range(nodes)]
+
+    # Arrival rate as a fraction of the total capacity of all edges
+    capacity = sum(workers / config.mean_service for config in edge_configs)
+    node_rate = (load * capacity) / nodes
+
+    events = []
+    counter = itertools.count()
+
+    def schedule(time, kind, data):
+        heapq.heappush(events, (time, next(counter), kind, data))
+
+    def start(now, edge_idx, task):
+        edge = edges[edge_idx]
+        edge.busy += 1
+        schedule(now + task.service, "done", task)
+
+    for node in range(nodes):
+        schedule(rng.expovariate(node_rate), "submit", node)
+
+    latencies = []
+    submitted = 0
+
+    while events and len(latencies) < tasks:
+        (now, _, kind, data) = heapq.heappop(events)
+
+        if kind == "submit":
+            node = data
+
+            if submitted < tasks:
+                submitted += 1
+                schedule(now + rng.expovariate(node_rate), "submit", node)
+
+                edge_idx = policy(rng, views[node], edges)
+                config = edge_configs[edge_idx]
+
+                views[node][edge_idx].in_flight += 1
+
+                task = Task(node, edge_idx, now, rng.expovariate(1 / config.mean_service))
+
+                # Task arrives at the edge half a round trip later
+                schedule(now + config.rtt / 2, "arrive", task)
+
+                # The acknowledgement carries the edge's stats at the time the task arrived
+                schedule(now + config.rtt, "ack", (node, edge_idx, edges[edge_idx].stats.mean()))
+
+        elif kind == "arrive":
+            edge = edges[data.edge]
+            if edge.busy < edge.workers:
+                start(now, data.edge, data)
+            else:
+                edge.queue.append(data)
+
+        elif kind == "ack":
+            (node, edge_idx, mean) = data
+            if mean is not None:
+                views[node][edge_idx].mean_ms = mean * 1000
+
+        elif kind == "done":
+            task = data
+            edge = edges[task.edge]
+            edge.busy -= 1
+            edge.stats.push(task.service)
+
+            if edge.queue:
+                start(now, task.edge, edge.queue.pop(0))
+
+            schedule(now + edge.config.rtt / 2, "result", task)
+
+        elif kind == "result":
+            task = data
+            views[task.node][task.edge].in_flight -= 1
+            latencies.append(now - task.submitted)
+
+    return latencies
+
+
+def percentile(values: List[float], p: float) -> float:
+    values = sorted(values)
+    k = (len(values) - 1) * p
+    f = math.floor(k)
+    c = math.ceil(k)
+    if f == c:
+        return values[int(k)]
+    return values[f] * (c - k) + values[c] * (k - f)
+
+
+def main(args):
+    print("Task latency in seconds")
+    print(f"{'policy':>16} {'load':>5} {'p50':>8} {'p95':>8} {'p99':>8}")
+
+    for load in args.loads:
+        for (name, policy) in policies.items():
+            latencies = []
+            for seed in range(args.seeds):
+                latencies.extend(simulate(policy, default_edges, args.nodes, load, args.tasks, args.workers, seed))
+
+            print(f"{name:>16} {load:>5.2f} "
+                  f"{percentile(latencies, 0.5):>8.2f} "
+                  f"{percentile(latencies, 0.95):>8.2f} "
+                  f"{percentile(latencies, 0.99):>8.2f}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Simulate task latency under the trust choose policies')
+    parser.add_argument('--loads', nargs="+", type=float, default=[0.1, 0.3, 0.5], help='Offered load as a fraction of total edge capacity')
+    parser.add_argument('--nodes', type=int, default=8, help='Number of IoT nodes submitting tasks')
+    parser.add_argument('--tasks', type=int, default=20000, help='Tasks to simulate per run')
+    parser.add_argument('--workers', type=int, default=2, help='Tasks each edge processes concurrently')
+    parser.add_argument('--seeds', type=int, default=5, help='Number of runs to pool latencies over')
+
+    args = parser.parse_args()
+
+    main(args)
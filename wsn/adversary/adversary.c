@@ -2,7 +2,11 @@
 #include "sys/log.h"
 
 #include "timed-unlock.h"
+#include "timer-wheel.h"
 #include "root-endpoint.h"
+#include "memb-stats.h"
+#include "prof.h"
+#include "event-log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "attack"
 #define LOG_LEVEL LOG_LEVEL_DBG
@@ -26,8 +30,12 @@ PROCESS_THREAD(adversary, ev, data)
     LOG_INFO("BUILD NUMBER = %u\n", BUILD_NUMBER);
 #endif
 
+    timer_wheel_init();
     timed_unlock_global_init();
     root_endpoint_init();
+    memb_stats_init();
+    prof_init();
+    event_log_init();
 
     PROCESS_END();
 }
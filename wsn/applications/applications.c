@@ -1,5 +1,6 @@
 #include "applications.h"
 #include "keystore.h"
+#include "scratch.h"
 
 #include "os/sys/log.h"
 #include "os/lib/assert.h"
@@ -17,6 +18,23 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Each application sends one request at a time, so can have one buffer live in the scratch arena
+#ifdef APPLICATION_MONITORING
+#define SCRATCH_MONITORING_LEN MONITORING_MSG_BUF_LEN
+#else
+#define SCRATCH_MONITORING_LEN 0
+#endif
+
+#ifdef APPLICATION_CHALLENGE_RESPONSE
+#define SCRATCH_CHALLENGE_RESPONSE_LEN CHALLENGE_RESPONSE_MSG_BUF_LEN
+#else
+#define SCRATCH_CHALLENGE_RESPONSE_LEN 0
+#endif
+
+// Each allocation is padded to SCRATCH_ALIGN, as scratch.h requires
+_Static_assert(SCRATCH_ALIGN(SCRATCH_MONITORING_LEN) + SCRATCH_ALIGN(SCRATCH_CHALLENGE_RESPONSE_LEN) <= SCRATCH_SIZE,
+               "SCRATCH_SIZE is too small for the application buffers that can be live at once");
+/*-------------------------------------------------------------------------------------------------------------------*/
 struct process* find_process_with_name(const char* name)
 {
 	for (struct process* iter = PROCESS_LIST(); iter != NULL; iter = iter->next)
@@ -102,16 +120,17 @@ void application_stats_init(application_stats_t* application_stats)
     application_stats->variance = 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int application_stats_serialise(const application_stats_t* application_stats, uint8_t* buffer, size_t len)
+int application_stats_serialise(const application_stats_t* application_stats, uint16_t queue_depth, uint8_t* buffer, size_t len)
 {
     nanocbor_encoder_t enc;
     nanocbor_encoder_init(&enc, buffer, len);
 
-    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 4));
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 5));
     NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, application_stats->mean));
     NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, application_stats->maximum));
     NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, application_stats->minimum));
     NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, application_stats->variance));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, queue_depth));
 
     return nanocbor_encoded_len(&enc);
 }
@@ -126,7 +145,7 @@ int application_stats_nil_serialise(uint8_t* buffer, size_t len)
     return nanocbor_encoded_len(&enc);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int application_stats_deserialise(nanocbor_value_t* dec, application_stats_t* application_stats)
+int application_stats_deserialise(nanocbor_value_t* dec, application_stats_t* application_stats, uint16_t* queue_depth)
 {
     nanocbor_value_t arr;
     NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
@@ -136,6 +155,18 @@ int application_stats_deserialise(nanocbor_value_t* dec, application_stats_t* ap
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &application_stats->minimum));
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &application_stats->variance));
 
+    // The resource rich node does not include a queue depth, only edges do
+    uint16_t depth = 0;
+    if (!nanocbor_at_end(&arr))
+    {
+        NANOCBOR_CHECK(nanocbor_get_uint16(&arr, &depth));
+    }
+
+    if (queue_depth != NULL)
+    {
+        *queue_depth = depth;
+    }
+
     if (!nanocbor_at_end(&arr))
     {
         LOG_ERR("!nanocbor_at_end\n");
@@ -29,6 +29,7 @@ void edge_capability_add_common(edge_resource_t* edge);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_capability_remove_common(edge_resource_t* edge);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Durations of tasks processed by the edge in milliseconds (variance in milliseconds^2)
 typedef struct {
     uint32_t mean;
     uint32_t maximum;
@@ -38,10 +39,12 @@ typedef struct {
 /*-------------------------------------------------------------------------------------------------------------------*/
 void application_stats_init(application_stats_t* application_stats);
 /*-------------------------------------------------------------------------------------------------------------------*/
-#define APPLICATION_STATS_MAX_CBOR_LENGTH ((1) + (1 + 4)*4)
+// Edges append how many tasks they have queued for the application to the stats they send to nodes
+#define APPLICATION_STATS_MAX_CBOR_LENGTH ((1) + (1 + 4)*4 + (1 + 2))
 
-int application_stats_serialise(const application_stats_t* application_stats, uint8_t* buffer, size_t len);
+int application_stats_serialise(const application_stats_t* application_stats, uint16_t queue_depth, uint8_t* buffer, size_t len);
 int application_stats_nil_serialise(uint8_t* buffer, size_t len);
 /*-------------------------------------------------------------------------------------------------------------------*/
-int application_stats_deserialise(nanocbor_value_t* dec, application_stats_t* application_stats);
+// queue_depth may be NULL, it is set to 0 when the stats do not include it
+int application_stats_deserialise(nanocbor_value_t* dec, application_stats_t* application_stats, uint16_t* queue_depth);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -63,3 +63,18 @@ int nanocbor_get_challenge_response(const uint8_t* buf, size_t buf_len, challeng
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+bool challenge_response_missed(clock_time_t generated, clock_time_t received, clock_time_t deadline,
+                               bool* never_received, bool* received_late)
+{
+    *never_received = received <= generated;
+    *received_late = received > generated + deadline;
+
+    // Only check if we have previously sent a challenge
+    return generated != 0 && (*never_received || *received_late);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool challenge_response_late(clock_time_t generated, clock_time_t received, clock_time_t deadline)
+{
+    return (received - generated) > deadline;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
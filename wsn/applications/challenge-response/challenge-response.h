@@ -1,9 +1,34 @@
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+
+#include "contiki.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define CHALLENGE_RESPONSE_APPLICATION_NAME "cr"
 #define CHALLENGE_RESPONSE_APPLICATION_URI "cr"
+
+// The node's challenge, held in the scratch arena while it is sent
+#define CHALLENGE_RESPONSE_MSG_BUF_LEN ((1) + (1 + sizeof(uint32_t)) + (1 + 32))
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The number of bytes that will be checked for being 0 at the start of the hash
+// Note this differs from blockchain mining difficulty, which checks the number of '0' characters at the start of the
+// hex representation of the hash. So our difficulty is actually twice as hard as the same blockchain difficulty.
+#ifndef CHALLENGE_DIFFICULTY
+#define CHALLENGE_DIFFICULTY 2
+#endif
+
+// Must be in actual seconds and not in ticks for this sensor node, as we will send this duration to the edge node
+#ifndef CHALLENGE_DURATION
+#define CHALLENGE_DURATION (40) // seconds
+#endif
+
+#ifndef CHALLENGE_PERIOD
+#define CHALLENGE_PERIOD (clock_time_t)(2 * 60 * CLOCK_SECOND)
+#endif
+
+_Static_assert(CHALLENGE_DURATION * CLOCK_SECOND < CHALLENGE_PERIOD,
+    "Challenge duration must be less than the challenge period");
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
     uint8_t data[32];
@@ -21,3 +46,11 @@ int nanocbor_fmt_challenge(uint8_t* buf, size_t buf_len, const challenge_t* c);
 /*-------------------------------------------------------------------------------------------------------------------*/
 int nanocbor_get_challenge_response(const uint8_t* buf, size_t buf_len, challenge_response_t* cr);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Was the response to a challenge sent at generated (0 if none was sent) not received within deadline,
+// either because it never arrived or because it arrived late
+bool challenge_response_missed(clock_time_t generated, clock_time_t received, clock_time_t deadline,
+                               bool* never_received, bool* received_late);
+
+// Did a response received at received take longer than deadline
+bool challenge_response_late(clock_time_t generated, clock_time_t received, clock_time_t deadline);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -20,6 +20,7 @@
 #include "base64.h"
 #include "serial-helpers.h"
 #include "timed-unlock.h"
+#include "edge.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" CHALLENGE_RESPONSE_APPLICATION_NAME
 #ifdef APP_CHALLENGE_RESPONSE_LOG_LEVEL
@@ -46,7 +47,7 @@ process_task_stats(const char* data, const char* data_end)
     nanocbor_value_t dec;
     nanocbor_decoder_init(&dec, buffer, buffer_len);
 
-    NANOCBOR_CHECK(application_stats_deserialise(&dec, &scn));
+    NANOCBOR_CHECK(application_stats_deserialise(&dec, &scn, NULL));
 
     if (!nanocbor_at_end(&dec))
     {
@@ -212,6 +213,9 @@ cr_taskresp_process_serial_input(const char* data)
     {
         data += strlen("stats" SERIAL_SEP);
         process_task_stats(data, data_end);
+
+        // The resource rich node sends stats once it has finished each task
+        application_queue_task_finished(CHALLENGE_RESPONSE_APPLICATION_NAME);
         ack_serial_input();
     }
     else if (match_action(data, data_end, "resp" SERIAL_SEP))
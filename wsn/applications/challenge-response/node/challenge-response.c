@@ -7,6 +7,7 @@
 #include "os/lib/assert.h"
 #include "list.h"
 #include "memb.h"
+#include "memb-stats.h"
 
 #include "platform-crypto-support.h"
 
@@ -25,30 +26,18 @@
 #include "applications.h"
 #include "serial-helpers.h"
 #include "timed-unlock.h"
+#include "offload-scheduler.h"
+#include "timer-wheel.h"
 
 #ifdef WITH_OSCORE
 #include "oscore.h"
 #include "keystore-oscore.h"
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-// The number of bytes that will be checked for being 0 at the start of the hash
-// Note this differs from blockchain mining difficulty, which checks the number of '0' characters at the start of the
-// hex representation of the hash. So our difficulty is actually twice as hard as the same blockchain difficulty.
-#ifndef CHALLENGE_DIFFICULTY
-#define CHALLENGE_DIFFICULTY 2
-#endif
-/*-------------------------------------------------------------------------------------------------------------------*/
-// Must be in actual seconds and not in ticks for this sensor node, as we will send this duration to the edge node
-#ifndef CHALLENGE_DURATION
-#define CHALLENGE_DURATION (40) // seconds
-#endif
-/*-------------------------------------------------------------------------------------------------------------------*/
-#ifndef CHALLENGE_PERIOD
-#define CHALLENGE_PERIOD (clock_time_t)(2 * 60 * CLOCK_SECOND)
-#endif
-/*-------------------------------------------------------------------------------------------------------------------*/
-_Static_assert(CHALLENGE_DURATION * CLOCK_SECOND < CHALLENGE_PERIOD,
-    "Challenge duration must be less than the challenge period");
+// A challenge not sent by the time the next is due is replaced by it
+#define CHALLENGE_DEADLINE CHALLENGE_PERIOD
+#define CHALLENGE_PRIORITY 3
+#define CHALLENGE_TASK_KIND 0
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" CHALLENGE_RESPONSE_APPLICATION_NAME
 #ifdef APP_CHALLENGE_RESPONSE_LOG_LEVEL
@@ -79,11 +68,13 @@ static coap_message_t msg;
 static coap_endpoint_t ep;
 static coap_callback_request_state_t coap_callback;
 static timed_unlock_t coap_callback_in_use;
-static uint8_t msg_buf[(1) + (1 + sizeof(uint32_t)) + (1 + 32)];
+static offload_task_t* sched_task;
+
+#define MSG_BUF_LEN CHALLENGE_RESPONSE_MSG_BUF_LEN
 /*-------------------------------------------------------------------------------------------------------------------*/
 static edge_challenger_t* next_challenge;
-static struct etimer challenge_timer;
-static struct etimer challenge_response_timer;
+static wheel_timer_t challenge_timer;
+static wheel_timer_t challenge_response_timer;
 /*-------------------------------------------------------------------------------------------------------------------*/
 static edge_challenger_t*
 find_edge_challenger(edge_resource_t* edge)
@@ -138,7 +129,7 @@ move_to_next_challenge(void)
     // Either we are on a new challenge, or
     // the final challenge might have been removed,
     // in either case we need to stop the timeout timer
-    etimer_stop(&challenge_response_timer);
+    wheel_timer_stop(&challenge_response_timer);
 
     LOG_DBG_("\n");
 }
@@ -151,6 +142,13 @@ generate_challenge(challenge_t* ch, uint8_t difficulty, uint32_t max_duration_se
     ch->max_duration_secs = max_duration_secs;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+// How long to wait for the challenge response, allowing for the round trip time to the edge
+static clock_time_t
+challenge_deadline(const edge_challenger_t* challenger)
+{
+    return edge_info_deadline(challenger->edge, challenger->ch.max_duration_secs * CLOCK_SECOND);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 send_callback(coap_callback_request_state_t* callback_state)
 {
@@ -172,7 +170,7 @@ send_callback(coap_callback_request_state_t* callback_state)
 
             // Set a timer for when we expect a response by
             PROCESS_CONTEXT_BEGIN(&challenge_response_process);
-            etimer_set(&challenge_response_timer, next_challenge->ch.max_duration_secs * CLOCK_SECOND);
+            wheel_timer_set_event(&challenge_response_timer, challenge_deadline(next_challenge));
             PROCESS_CONTEXT_END(&challenge_response_process);
         }
         else
@@ -187,6 +185,8 @@ send_callback(coap_callback_request_state_t* callback_state)
     case COAP_REQUEST_STATUS_FINISHED:
     {
         timed_unlock_unlock(&coap_callback_in_use);
+        offload_sched_task_done(sched_task);
+        sched_task = NULL;
     } break;
 
     default:
@@ -194,6 +194,8 @@ send_callback(coap_callback_request_state_t* callback_state)
         LOG_ERR("Failed to send message due to %s(%d)\n",
             coap_request_status_to_string(callback_state->state.status), callback_state->state.status);
         timed_unlock_unlock(&coap_callback_in_use);
+        offload_sched_task_done(sched_task);
+        sched_task = NULL;
     } break;
     }
 
@@ -206,6 +208,11 @@ send_callback(coap_callback_request_state_t* callback_state)
         return;
     }
 
+    if (callback_state->state.status == COAP_REQUEST_STATUS_RESPONSE && next_challenge != NULL)
+    {
+        edge_info_rtt_update(edge, clock_time() - next_challenge->generated);
+    }
+
     tm_update_challenge_response(edge, &info);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -215,13 +222,11 @@ challenge_response_timed_out(void)
     // Was there a previous challenge request and did we get a response?
     if (next_challenge != NULL)
     {
-        const clock_time_t duration = next_challenge->ch.max_duration_secs * CLOCK_SECOND;
-
-        const bool never_received = next_challenge->received <= next_challenge->generated;
-        const bool received_late = next_challenge->received > next_challenge->generated + duration;
+        const clock_time_t duration = challenge_deadline(next_challenge);
 
-        // Only check if we have previously sent a challenge
-        if (next_challenge->generated != 0 && (never_received || received_late))
+        bool never_received, received_late;
+        if (challenge_response_missed(next_challenge->generated, next_challenge->received, duration,
+                                      &never_received, &received_late))
         {
             LOG_WARN("Failed to receive challenge response from ");
             LOG_WARN_6ADDR(&next_challenge->edge->ep.ipaddr);
@@ -248,13 +253,24 @@ challenge_response_timed_out(void)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
-periodic_action(void)
+dropped_action(offload_task_t* task)
+{
+    // Only dispatched tasks are kept, which are never dropped, but make sure a freed task is not kept
+    if (task == sched_task)
+    {
+        sched_task = NULL;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+periodic_action(offload_task_t* task)
 {
     int ret;
 
     if (timed_unlock_is_locked(&coap_callback_in_use))
     {
         LOG_WARN("Cannot generate a new message, as in process of sending one\n");
+        offload_sched_task_done(task);
         return;
     }
 
@@ -263,15 +279,27 @@ periodic_action(void)
     if (next_challenge == NULL)
     {
         LOG_WARN("No challenges possible\n");
+        offload_sched_task_done(task);
         return;
     }
 
     generate_challenge(&next_challenge->ch, CHALLENGE_DIFFICULTY, CHALLENGE_DURATION);
 
-    int len = nanocbor_fmt_challenge(msg_buf, sizeof(msg_buf), &next_challenge->ch);
-    if (len <= 0 || len > sizeof(msg_buf))
+    // Freed when the lock is unlocked
+    uint8_t* msg_buf = timed_unlock_scratch_alloc(&coap_callback_in_use, MSG_BUF_LEN);
+    if (msg_buf == NULL)
+    {
+        LOG_WARN("Cannot generate a new challenge, as there is no scratch space\n");
+        offload_sched_task_done(task);
+        return;
+    }
+
+    int len = nanocbor_fmt_challenge(msg_buf, MSG_BUF_LEN, &next_challenge->ch);
+    if (len <= 0 || len > MSG_BUF_LEN)
     {
         LOG_ERR("Failed to generated message (%d)\n", len);
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
         return;
     }
 
@@ -317,7 +345,11 @@ periodic_action(void)
     ret = coap_send_request(&coap_callback, &ep, &msg, send_callback);
     if (ret)
     {
+        edge_info_set_coap_timeout(edge, &coap_callback.state);
+
         timed_unlock_lock(&coap_callback_in_use);
+        offload_sched_task_sent(task, edge);
+        sched_task = task;
         LOG_DBG("Message sent to ");
         LOG_DBG_COAP_EP(&ep);
         LOG_DBG_("\n");
@@ -325,6 +357,8 @@ periodic_action(void)
     else
     {
         LOG_ERR("Failed to send message with %d\n", ret);
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -449,7 +483,7 @@ res_coap_cr_post_handler(coap_message_t *request, coap_message_t *response, uint
     }
 
     // Received a response, so do not want to timeout now
-    etimer_stop(&challenge_response_timer);
+    wheel_timer_stop(&challenge_response_timer);
 
     // Record when the response was received
     challenger->received = received;
@@ -478,7 +512,8 @@ res_coap_cr_post_handler(coap_message_t *request, coap_message_t *response, uint
     info.challenge_successful = check_first_n_zeros(digest, sizeof(digest), challenger->ch.difficulty);
 
     // Record if this was received late
-    info.challenge_late = (challenger->received - challenger->generated) > (challenger->ch.max_duration_secs * CLOCK_SECOND);
+    info.challenge_late = challenge_response_late(challenger->generated, challenger->received,
+                                                  challenge_deadline(challenger));
 
     LOG_INFO("Challenge response from ");
     LOG_INFO_6ADDR(&edge->ep.ipaddr);
@@ -494,7 +529,7 @@ edge_capability_add(edge_resource_t* edge)
 {
     if (app_state_edge_capability_add(&app_state, edge))
     {
-        etimer_set(&challenge_timer, CHALLENGE_PERIOD);
+        wheel_timer_set_event(&challenge_timer, CHALLENGE_PERIOD);
     }
 
     // Check that we don't already have a challenger allocated
@@ -502,7 +537,7 @@ edge_capability_add(edge_resource_t* edge)
     edge_challenger_t* c = find_edge_challenger(edge);
     if (c == NULL)
     {
-        c = memb_alloc(&challengers_memb);
+        c = memb_stats_alloc(&challengers_memb);
         if (c == NULL)
         {
             LOG_ERR("Failed to allocate edge_challenger\n");
@@ -528,7 +563,7 @@ edge_capability_remove(edge_resource_t* edge)
 {
     if (app_state_edge_capability_remove(&app_state, edge))
     {
-        etimer_stop(&challenge_timer);
+        wheel_timer_stop(&challenge_timer);
     }
 
     edge_challenger_t* c = find_edge_challenger(edge);
@@ -562,6 +597,7 @@ init(void)
     timed_unlock_init(&coap_callback_in_use, "challenge-response", (1 * 60 * CLOCK_SECOND));
 
     memb_init(&challengers_memb);
+    MEMB_STATS_REGISTER(challengers_memb);
     list_init(challengers);
 
     next_challenge = NULL;
@@ -578,8 +614,21 @@ PROCESS_THREAD(challenge_response_process, ev, data)
         PROCESS_YIELD();
 
         if (ev == PROCESS_EVENT_TIMER && data == &challenge_timer) {
-            periodic_action();
-            etimer_reset(&challenge_timer);
+            // The edge to challenge is picked when the task is dispatched
+            if (offload_sched_enqueue(NULL, CHALLENGE_DEADLINE, CHALLENGE_PRIORITY,
+                                      CHALLENGE_TASK_KIND, OFFLOAD_SCHED_PERIODIC) == NULL)
+            {
+                LOG_ERR("Failed to enqueue challenge task\n");
+            }
+            wheel_timer_restart(&challenge_timer);
+        }
+
+        if (ev == pe_offload_task_dispatch) {
+            periodic_action((offload_task_t*)data);
+        }
+
+        if (ev == pe_offload_task_dropped) {
+            dropped_action((offload_task_t*)data);
         }
 
         if (ev == PROCESS_EVENT_TIMER && data == &challenge_response_timer) {
@@ -3,4 +3,10 @@
 #define MONITORING_APPLICATION_NAME "envmon"
 #define MONITORING_APPLICATION_URI "envmon"
 
+// The node's sensor reading, held in the scratch arena while it is sent
+#define MONITORING_MSG_BUF_LEN ((1) + (1 + sizeof(uint32_t)) + (1 + sizeof(int)) + (1 + sizeof(int)))
+
+// How often the node publishes a reading while there are edges to send it to
+#define MONITORING_PUBLISH_PERIOD (CLOCK_SECOND * 60 * 1)
+
 void init_trust_weights_monitoring(void);
@@ -29,6 +29,9 @@
 #include "applications.h"
 #include "keystore-oscore.h"
 #include "timed-unlock.h"
+#include "offload-scheduler.h"
+#include "timer-wheel.h"
+#include "prof.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" MONITORING_APPLICATION_NAME
 #ifdef APP_MONITORING_LOG_LEVEL
@@ -37,17 +40,24 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-#define LONG_PUBLISH_PERIOD (CLOCK_SECOND * 60 * 1)
 #define SHORT_PUBLISH_PERIOD (CLOCK_SECOND * 10)
 #define CONNECT_PERIOD (CLOCK_SECOND * 5)
+
+// A reading that has not been sent by the time the next one is due is obsolete
+#define PUBLISH_DEADLINE SHORT_PUBLISH_PERIOD
+#define PUBLISH_PRIORITY 2
+#define PUBLISH_TASK_KIND 0
 /*-------------------------------------------------------------------------------------------------------------------*/
 static app_state_t app_state;
 /*-------------------------------------------------------------------------------------------------------------------*/
+#define MSG_BUF_LEN MONITORING_MSG_BUF_LEN
+/*-------------------------------------------------------------------------------------------------------------------*/
 static coap_message_t msg;
 static coap_endpoint_t ep;
 static coap_callback_request_state_t coap_callback;
 static timed_unlock_t coap_callback_in_use;
-static uint8_t msg_buf[(1) + (1 + sizeof(uint32_t)) + (1 + sizeof(int)) + (1 + sizeof(int))];
+static clock_time_t sent_time;
+static offload_task_t* sched_task;
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
 generate_sensor_data(uint8_t* buf, size_t buf_len)
@@ -73,7 +83,7 @@ generate_sensor_data(uint8_t* buf, size_t buf_len)
     return nanocbor_encoded_len(&enc);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static struct etimer publish_periodic_timer, publish_short_timer;
+static wheel_timer_t publish_periodic_timer, publish_short_timer;
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
 send_callback(coap_callback_request_state_t* callback_state)
@@ -105,6 +115,8 @@ send_callback(coap_callback_request_state_t* callback_state)
     case COAP_REQUEST_STATUS_FINISHED:
     {
         timed_unlock_unlock(&coap_callback_in_use);
+        offload_sched_task_done(sched_task);
+        sched_task = NULL;
     } break;
 
     default:
@@ -112,6 +124,8 @@ send_callback(coap_callback_request_state_t* callback_state)
         LOG_ERR("Failed to send message due to %s(%d)\n",
             coap_request_status_to_string(callback_state->state.status), callback_state->state.status);
         timed_unlock_unlock(&coap_callback_in_use);
+        offload_sched_task_done(sched_task);
+        sched_task = NULL;
     } break;
     }
 
@@ -124,6 +138,11 @@ send_callback(coap_callback_request_state_t* callback_state)
         return;
     }
 
+    if (callback_state->state.status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        edge_info_rtt_update(edge, clock_time() - sent_time);
+    }
+
     // Find the information on the capability for this edge
     // If this capability no longer exists, then the Edge has informed us that it no longer
     // offers that capability
@@ -149,32 +168,56 @@ send_callback(coap_callback_request_state_t* callback_state)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
-periodic_action(void)
+dropped_action(offload_task_t* task)
+{
+    // Only dispatched tasks are kept, which are never dropped, but make sure a freed task is not kept
+    if (task == sched_task)
+    {
+        sched_task = NULL;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+periodic_action(offload_task_t* task)
 {
     int ret;
 
-    etimer_reset(&publish_periodic_timer);
-
     if (timed_unlock_is_locked(&coap_callback_in_use))
     {
         LOG_WARN("Cannot generate a new message, as in process of sending one\n");
+        offload_sched_task_done(task);
+        return;
+    }
+
+    // Freed when the lock is unlocked
+    uint8_t* msg_buf = timed_unlock_scratch_alloc(&coap_callback_in_use, MSG_BUF_LEN);
+    if (msg_buf == NULL)
+    {
+        LOG_WARN("Cannot generate a new message, as there is no scratch space\n");
+        offload_sched_task_done(task);
         return;
     }
 
-    int len = generate_sensor_data(msg_buf, sizeof(msg_buf));
-    if (len <= 0 || len > sizeof(msg_buf))
+    int len = generate_sensor_data(msg_buf, MSG_BUF_LEN);
+    if (len <= 0 || len > MSG_BUF_LEN)
     {
         LOG_ERR("Failed to generated message (%d)\n", len);
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
         return;
     }
 
     LOG_DBG("Generated message (len=%d)\n", len);
 
     // Choose an Edge node to send information to
+    PROF_BEGIN(CHOOSE_EDGE);
     edge_resource_t* edge = choose_edge(MONITORING_APPLICATION_NAME);
+    PROF_END(CHOOSE_EDGE);
     if (edge == NULL)
     {
         LOG_ERR("Failed to find an edge resource to send task to\n");
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
         return;
     }
 
@@ -192,7 +235,9 @@ periodic_action(void)
         coap_endpoint_connect(&ep);
 
         // Wait for a bit and then try sending again
-        etimer_set(&publish_short_timer, SHORT_PUBLISH_PERIOD);
+        wheel_timer_set_event(&publish_short_timer, SHORT_PUBLISH_PERIOD);
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
         return;
     }
 
@@ -207,10 +252,16 @@ periodic_action(void)
     keystore_protect_coap_with_oscore(&msg, &ep);
 #endif
 
+    sent_time = clock_time();
+
     ret = coap_send_request(&coap_callback, &ep, &msg, send_callback);
     if (ret)
     {
+        edge_info_set_coap_timeout(edge, &coap_callback.state);
+
         timed_unlock_lock(&coap_callback_in_use);
+        offload_sched_task_sent(task, edge);
+        sched_task = task;
         LOG_DBG("Message sent to ");
         LOG_DBG_COAP_EP(&ep);
         LOG_DBG_("\n");
@@ -220,6 +271,17 @@ periodic_action(void)
     else
     {
         LOG_ERR("Failed to send message with %d\n", ret);
+        timed_unlock_scratch_free(&coap_callback_in_use);
+        offload_sched_task_done(task);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+publish(void)
+{
+    if (offload_sched_enqueue(NULL, PUBLISH_DEADLINE, PUBLISH_PRIORITY, PUBLISH_TASK_KIND, OFFLOAD_SCHED_PERIODIC) == NULL)
+    {
+        LOG_ERR("Failed to enqueue publish task\n");
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -231,7 +293,7 @@ edge_capability_add(edge_resource_t* edge)
         LOG_INFO("Starting periodic timer to send information\n");
 
         // Setup a periodic timer that expires after PERIOD seconds.
-        etimer_set(&publish_periodic_timer, LONG_PUBLISH_PERIOD);
+        wheel_timer_set_event(&publish_periodic_timer, MONITORING_PUBLISH_PERIOD);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -242,7 +304,7 @@ edge_capability_remove(edge_resource_t* edge)
     {
         LOG_INFO("Stop sending information, no edges to process it\n");
 
-        etimer_stop(&publish_periodic_timer);
+        wheel_timer_stop(&publish_periodic_timer);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -275,8 +337,21 @@ PROCESS_THREAD(monitoring_process, ev, data)
     {
         PROCESS_YIELD();
 
-        if (ev == PROCESS_EVENT_TIMER && (data == &publish_periodic_timer || data == &publish_short_timer)) {
-            periodic_action();
+        if (ev == PROCESS_EVENT_TIMER && data == &publish_periodic_timer) {
+            wheel_timer_restart(&publish_periodic_timer);
+            publish();
+        }
+
+        if (ev == PROCESS_EVENT_TIMER && data == &publish_short_timer) {
+            publish();
+        }
+
+        if (ev == pe_offload_task_dispatch) {
+            periodic_action((offload_task_t*)data);
+        }
+
+        if (ev == pe_offload_task_dropped) {
+            dropped_action((offload_task_t*)data);
         }
 
         if (ev == pe_edge_capability_add) {
@@ -0,0 +1,328 @@
+#include "offload-scheduler.h"
+
+#include "os/sys/log.h"
+#include "os/lib/assert.h"
+#include "list.h"
+#include "memb.h"
+#include "memb-stats.h"
+
+#include "crypto-support.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "offload"
+#ifdef OFFLOAD_SCHED_LOG_LEVEL
+#define LOG_LEVEL OFFLOAD_SCHED_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+process_event_t pe_offload_task_dispatch;
+process_event_t pe_offload_task_dropped;
+/*-------------------------------------------------------------------------------------------------------------------*/
+MEMB(offload_tasks_memb, offload_task_t, OFFLOAD_SCHED_MAX_TASKS);
+LIST(offload_tasks);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static offload_sched_stats_t stats[APPLICATION_NUM];
+/*-------------------------------------------------------------------------------------------------------------------*/
+static struct etimer retry_timer;
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS(offload_scheduler, "offload_scheduler");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static offload_sched_stats_t*
+find_stats(const struct process* process)
+{
+    for (uint8_t i = 0; i != APPLICATION_NUM; ++i)
+    {
+        if (stats[i].process == process)
+        {
+            return &stats[i];
+        }
+
+        if (stats[i].process == NULL)
+        {
+            stats[i].process = (struct process*)process;
+            return &stats[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const offload_sched_stats_t*
+offload_sched_stats(const struct process* process)
+{
+    return find_stats(process);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+stats_print(const offload_sched_stats_t* s)
+{
+    LOG_INFO("Offload stats: app=%s dispatched=%" PRIu32 " completed=%" PRIu32 " missed=%" PRIu32 " collapsed=%" PRIu32 "\n",
+        PROCESS_NAME_STRING(s->process), s->dispatched, s->completed, s->missed, s->collapsed);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+deadline_passed(const offload_task_t* task)
+{
+    // Deadlines are stored as absolute times, so compare in a wrap safe way
+    return (clock_time_t)(clock_time() - task->deadline) < ((clock_time_t)~0 / 2);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Is a before b in earliest deadline first order
+static bool
+task_before(const offload_task_t* a, const offload_task_t* b)
+{
+    const clock_time_t now = clock_time();
+
+    const clock_time_t a_remaining = a->deadline - now;
+    const clock_time_t b_remaining = b->deadline - now;
+
+    if (a_remaining != b_remaining)
+    {
+        return a_remaining < b_remaining;
+    }
+
+    return a->priority < b->priority;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+task_free(offload_task_t* task)
+{
+    list_remove(offload_tasks, task);
+    memb_free(&offload_tasks_memb, task);
+
+    // Capacity may now be available
+    process_poll(&offload_scheduler);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+offload_task_t*
+offload_sched_enqueue(struct edge_resource* edge, clock_time_t deadline, uint8_t priority, uint8_t kind, uint8_t flags)
+{
+    struct process* process = PROCESS_CURRENT();
+
+    offload_sched_stats_t* s = find_stats(process);
+
+    // An older periodic task of the same kind that is still waiting is obsolete, so reuse it
+    if (flags & OFFLOAD_SCHED_PERIODIC)
+    {
+        for (offload_task_t* iter = list_head(offload_tasks); iter != NULL; iter = list_item_next(iter))
+        {
+            if (iter->process == process && iter->kind == kind && !iter->dispatched &&
+                (iter->flags & OFFLOAD_SCHED_PERIODIC))
+            {
+                LOG_DBG("Collapsing waiting %s task of kind %" PRIu8 "\n", PROCESS_NAME_STRING(process), kind);
+
+                iter->edge = edge;
+                iter->deadline = clock_time() + deadline;
+                iter->priority = priority;
+
+                if (s != NULL)
+                {
+                    s->collapsed += 1;
+                }
+
+                process_poll(&offload_scheduler);
+
+                return iter;
+            }
+        }
+    }
+
+    offload_task_t* task = memb_stats_alloc(&offload_tasks_memb);
+    if (task == NULL)
+    {
+        LOG_WARN("No space to enqueue %s task\n", PROCESS_NAME_STRING(process));
+        return NULL;
+    }
+
+    task->process = process;
+    task->edge = edge;
+    task->deadline = clock_time() + deadline;
+    task->priority = priority;
+    task->kind = kind;
+    task->flags = flags;
+    task->dispatched = false;
+
+    list_add(offload_tasks, task);
+
+    process_poll(&offload_scheduler);
+
+    return task;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+offload_sched_task_sent(offload_task_t* task, struct edge_resource* edge)
+{
+    task->edge = edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+offload_sched_task_done(offload_task_t* task)
+{
+    offload_sched_stats_t* s = find_stats(task->process);
+    if (s != NULL)
+    {
+        s->completed += 1;
+
+        if (deadline_passed(task))
+        {
+            LOG_WARN("%s task completed after its deadline\n", PROCESS_NAME_STRING(task->process));
+            s->missed += 1;
+        }
+
+        stats_print(s);
+    }
+
+    task_free(task);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+offload_sched_cancel_edge(struct process* process, const struct edge_resource* edge)
+{
+    offload_task_t* iter = list_head(offload_tasks);
+    while (iter != NULL)
+    {
+        offload_task_t* next = list_item_next(iter);
+
+        // Dispatched tasks are freed by the application when they finish
+        if (iter->process == process && iter->edge == edge && !iter->dispatched)
+        {
+            task_free(iter);
+        }
+
+        iter = next;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t
+in_flight_to(const struct edge_resource* edge)
+{
+    uint8_t count = 0;
+
+    for (offload_task_t* iter = list_head(offload_tasks); iter != NULL; iter = list_item_next(iter))
+    {
+        if (iter->dispatched && (edge == NULL || iter->edge == edge))
+        {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Earliest deadline task that could be dispatched now
+static offload_task_t*
+next_task(void)
+{
+    offload_task_t* best = NULL;
+
+    for (offload_task_t* iter = list_head(offload_tasks); iter != NULL; iter = list_item_next(iter))
+    {
+        if (iter->dispatched)
+        {
+            continue;
+        }
+
+        if (iter->edge != NULL && in_flight_to(iter->edge) >= OFFLOAD_SCHED_MAX_PER_EDGE)
+        {
+            continue;
+        }
+
+        if (best == NULL || task_before(iter, best))
+        {
+            best = iter;
+        }
+    }
+
+    return best;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+drop_expired(void)
+{
+    offload_task_t* iter = list_head(offload_tasks);
+    while (iter != NULL)
+    {
+        offload_task_t* next = list_item_next(iter);
+
+        if (!iter->dispatched && deadline_passed(iter))
+        {
+            LOG_WARN("Dropping %s task as its deadline passed before it could be dispatched\n",
+                PROCESS_NAME_STRING(iter->process));
+
+            offload_sched_stats_t* s = find_stats(iter->process);
+            if (s != NULL)
+            {
+                s->missed += 1;
+                stats_print(s);
+            }
+
+            // The application may be keeping the task, so tell it before it is freed
+            process_post_synch(iter->process, pe_offload_task_dropped, iter);
+
+            task_free(iter);
+        }
+
+        iter = next;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+dispatch(void)
+{
+    drop_expired();
+
+    while (in_flight_to(NULL) < OFFLOAD_SCHED_MAX_IN_FLIGHT)
+    {
+        offload_task_t* task = next_task();
+        if (task == NULL)
+        {
+            return;
+        }
+
+        // Sending a task needs crypto (e.g., OSCORE), so let the crypto queue drain first
+        if (crypto_support_pending() >= OFFLOAD_SCHED_CRYPTO_BUSY)
+        {
+            LOG_DBG("Crypto queue busy, delaying dispatch\n");
+            etimer_set(&retry_timer, OFFLOAD_SCHED_RETRY_PERIOD);
+            return;
+        }
+
+        task->dispatched = true;
+
+        offload_sched_stats_t* s = find_stats(task->process);
+        if (s != NULL)
+        {
+            s->dispatched += 1;
+        }
+
+        LOG_DBG("Dispatching %s task of kind %" PRIu8 "\n", PROCESS_NAME_STRING(task->process), task->kind);
+
+        // The application either sends the task or marks it done straight away
+        process_post_synch(task->process, pe_offload_task_dispatch, task);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(offload_scheduler, ev, data)
+{
+    PROCESS_BEGIN();
+
+    pe_offload_task_dispatch = process_alloc_event();
+    pe_offload_task_dropped = process_alloc_event();
+
+    memb_init(&offload_tasks_memb);
+    MEMB_STATS_REGISTER(offload_tasks_memb);
+    list_init(offload_tasks);
+
+    while (1)
+    {
+        PROCESS_YIELD();
+
+        if (ev == PROCESS_EVENT_POLL || (ev == PROCESS_EVENT_TIMER && data == &retry_timer))
+        {
+            dispatch();
+        }
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
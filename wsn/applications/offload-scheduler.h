@@ -0,0 +1,97 @@
+#pragma once
+
+#include "contiki.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct edge_resource;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Applications on a node enqueue the tasks they want to offload here instead of sending them
+// straight away. Tasks are dispatched earliest deadline first, subject to a limit on how many
+// submissions may be in flight (overall and to each edge) and to the crypto queue not being backed up.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef OFFLOAD_SCHED_MAX_TASKS
+#define OFFLOAD_SCHED_MAX_TASKS 6
+#endif
+
+// Submissions that may be waiting on an acknowledgement at once
+#ifndef OFFLOAD_SCHED_MAX_IN_FLIGHT
+#define OFFLOAD_SCHED_MAX_IN_FLIGHT 2
+#endif
+
+#ifndef OFFLOAD_SCHED_MAX_PER_EDGE
+#define OFFLOAD_SCHED_MAX_PER_EDGE 1
+#endif
+
+// Hold tasks back while this many sign/verify requests are pending
+#ifndef OFFLOAD_SCHED_CRYPTO_BUSY
+#define OFFLOAD_SCHED_CRYPTO_BUSY 2
+#endif
+
+// How often to check again when the crypto queue is busy
+#ifndef OFFLOAD_SCHED_RETRY_PERIOD
+#define OFFLOAD_SCHED_RETRY_PERIOD (CLOCK_SECOND / 2)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define OFFLOAD_SCHED_NO_FLAGS 0
+// A newer task of the same kind replaces this one if it is still waiting to be dispatched
+#define OFFLOAD_SCHED_PERIODIC (1 << 0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct offload_task
+{
+    struct offload_task* next;
+
+    // The application process that performs the task, it is posted pe_offload_task_dispatch
+    struct process* process;
+
+    // The edge the task must be sent to, or NULL if the application chooses when dispatched
+    struct edge_resource* edge;
+
+    clock_time_t deadline;
+
+    // Lower values are more important, only used to break deadline ties
+    uint8_t priority;
+
+    // Application defined, used to find periodic tasks to collapse
+    uint8_t kind;
+
+    uint8_t flags;
+
+    bool dispatched;
+
+} offload_task_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct offload_sched_stats
+{
+    struct process* process;
+
+    uint32_t dispatched;
+    uint32_t completed;
+    uint32_t missed;
+    uint32_t collapsed;
+
+} offload_sched_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Posted synchronously to the task's process, the data is the offload_task_t
+extern process_event_t pe_offload_task_dispatch;
+
+// Posted synchronously to the task's process when a task is dropped because its deadline passed
+// before it could be dispatched. The data is the offload_task_t, which is freed once the event is handled.
+extern process_event_t pe_offload_task_dropped;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Must be called from the application's process. The deadline is relative to now.
+offload_task_t* offload_sched_enqueue(struct edge_resource* edge, clock_time_t deadline,
+                                      uint8_t priority, uint8_t kind, uint8_t flags);
+
+// The dispatched task was sent to this edge
+void offload_sched_task_sent(offload_task_t* task, struct edge_resource* edge);
+
+// The task has been acknowledged, failed or could not be sent, it must not be used afterwards
+void offload_sched_task_done(offload_task_t* task);
+
+// Remove any tasks an application has waiting that are for this edge (pe_offload_task_dropped is not posted)
+void offload_sched_cancel_edge(struct process* process, const struct edge_resource* edge);
+
+const offload_sched_stats_t* offload_sched_stats(const struct process* process);
+/*-------------------------------------------------------------------------------------------------------------------*/
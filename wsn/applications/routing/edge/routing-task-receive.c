@@ -16,6 +16,7 @@
 
 #include "application-serial.h"
 #include "serial-helpers.h"
+#include "edge.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" ROUTING_APPLICATION_NAME
 #ifdef APP_ROUTING_LOG_LEVEL
@@ -54,20 +55,28 @@ post_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer,
     LOG_DBG_COAP_EP(request->src_ep);
     LOG_DBG_(" sending to edge\n");
 
-    // Send data to connected edge node for processing
-    printf(APPLICATION_SERIAL_PREFIX ROUTING_APPLICATION_NAME SERIAL_SEP);
-    uiplib_ipaddr_print(&request->src_ep->ipaddr);
-    printf(SERIAL_SEP "%u" SERIAL_SEP, payload_len);
-    for (int i = 0; i != payload_len; ++i)
+    // Too many tasks are already waiting on the resource rich node, so ask the IoT node to try elsewhere
+    if (!application_queue_admit(ROUTING_APPLICATION_NAME))
     {
-        printf("%02X", payload[i]);
+        coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+        coap_set_header_max_age(response, EDGE_APPLICATION_OVERLOADED_MAX_AGE);
+    }
+    else
+    {
+        // Send data to connected edge node for processing
+        printf(APPLICATION_SERIAL_PREFIX ROUTING_APPLICATION_NAME SERIAL_SEP);
+        uiplib_ipaddr_print(&request->src_ep->ipaddr);
+        printf(SERIAL_SEP "%u" SERIAL_SEP, payload_len);
+        for (int i = 0; i != payload_len; ++i)
+        {
+            printf("%02X", payload[i]);
+        }
+        printf("\n");
     }
-    printf("\n");
-
-    // TODO: need to implement some sort of ack feature
 
-    // Set response - the stats of how long jobs might take
-    int len = application_stats_serialise(&routing_stats, response_buffer, sizeof(response_buffer));
+    // Set response - the stats of how long jobs might take and how many are queued
+    int len = application_stats_serialise(&routing_stats, application_queue_depth(ROUTING_APPLICATION_NAME),
+                                          response_buffer, sizeof(response_buffer));
     if (len <= 0)
     {
         LOG_ERR("Failed to include job stats in response\n");
@@ -20,6 +20,7 @@
 #include "base64.h"
 #include "serial-helpers.h"
 #include "timed-unlock.h"
+#include "edge.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" ROUTING_APPLICATION_NAME
 #ifdef APP_ROUTING_LOG_LEVEL
@@ -46,7 +47,7 @@ process_task_stats(const char* data, const char* data_end)
     nanocbor_value_t dec;
     nanocbor_decoder_init(&dec, buffer, buffer_len);
 
-    NANOCBOR_CHECK(application_stats_deserialise(&dec, &scn));
+    NANOCBOR_CHECK(application_stats_deserialise(&dec, &scn, NULL));
 
     if (!nanocbor_at_end(&dec))
     {
@@ -369,6 +370,9 @@ routing_taskresp_process_serial_input(const char* data)
     {
         data += strlen("stats" SERIAL_SEP);
         process_task_stats(data, data_end);
+
+        // The resource rich node sends stats once it has finished each task
+        application_queue_task_finished(ROUTING_APPLICATION_NAME);
     }
     else if (match_action(data, data_end, "resp1" SERIAL_SEP))
     {
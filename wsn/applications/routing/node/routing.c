@@ -15,6 +15,7 @@
 #include "nanocbor-helper.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "edge-info.h"
 #include "trust.h"
@@ -24,6 +25,9 @@
 #include "serial-helpers.h"
 #include "float-helpers.h"
 #include "timed-unlock.h"
+#include "offload-scheduler.h"
+#include "memb-stats.h"
+#include "prof.h"
 
 #ifdef WITH_OSCORE
 #include "oscore.h"
@@ -42,17 +46,217 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Routing requests are made by a user waiting on the result, so are dispatched ahead of periodic work
+#ifndef ROUTING_DISPATCH_DEADLINE
+#define ROUTING_DISPATCH_DEADLINE (5 * CLOCK_SECOND)
+#endif
+#define ROUTING_PRIORITY 0
+#define ROUTING_TASK_KIND 0
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef ROUTING_HEDGING
+// Tasks can be outstanding at the primary edge and one other edge
+#define ROUTING_TASK_ATTEMPTS 2
+
+// How long to wait before hedging when the primary edge has not reported how long its tasks take
+#ifndef ROUTING_HEDGE_DEFAULT_DELAY
+#define ROUTING_HEDGE_DEFAULT_DELAY (10 * CLOCK_SECOND)
+#endif
+
+// Never hedge sooner than this after submitting a task
+#ifndef ROUTING_HEDGE_MIN_DELAY
+#define ROUTING_HEDGE_MIN_DELAY (2 * CLOCK_SECOND)
+#endif
+#else
+#define ROUTING_TASK_ATTEMPTS 1
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 static app_state_t app_state;
 /*-------------------------------------------------------------------------------------------------------------------*/
-static coap_message_t msg;
-static coap_endpoint_t ep;
-static coap_callback_request_state_t coap_callback;
-static timed_unlock_t coap_callback_in_use;
-static uint8_t msg_buf[(1) + (1 + sizeof(uint32_t)) + (1 + (1 + sizeof(float)) * 2) * 2];
+// Checks a route as each Block1 block arrives, so only the state needed to judge
+// the result is kept no matter how long the route is
+typedef struct route_decoder
+{
+    coordinate_t first, last;
+    uint32_t next_block;
+    uint32_t points;
+    bool valid;
+} route_decoder_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A task submitted to a single edge
+typedef struct routing_attempt
+{
+    coap_message_t msg;
+    coap_endpoint_t ep;
+    coap_callback_request_state_t coap_callback;
+    timed_unlock_t coap_callback_in_use;
+    timed_unlock_t task_in_use;
+    clock_time_t sent_time;
+    uint8_t msg_buf[(1) + (1 + sizeof(uint32_t)) + (1 + (1 + sizeof(float)) * 2) * 2];
+
+    coordinate_t src, dest;
+    route_decoder_t route;
+
+    // Only set for the attempt the scheduler dispatched, until the submission is acknowledged
+    offload_task_t* sched_task;
+
+#ifdef ROUTING_HEDGING
+    uint32_t task_id;
+    bool hedge;
+#endif
+} routing_attempt_t;
+
+static routing_attempt_t attempts[ROUTING_TASK_ATTEMPTS];
+
+// Used to submit a task rejected by an overloaded edge to another edge
+static struct ctimer redirect_timer;
 /*-------------------------------------------------------------------------------------------------------------------*/
-static timed_unlock_t task_in_use;
 static coordinate_t task_src, task_dest;
-static bool first_src_isclose;
+
+// A parsed request waiting for the scheduler to dispatch it
+static offload_task_t* pending_task;
+static coordinate_t pending_src, pending_dest;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef ROUTING_HEDGING
+typedef struct routing_hedge_stats
+{
+    uint32_t tasks;
+    uint32_t hedged;
+    uint32_t hedge_won;
+    uint32_t latency_saved_ms;
+} routing_hedge_stats_t;
+
+static struct ctimer hedge_timer;
+static uint32_t task_id;
+static bool task_complete;
+static bool task_won_by_hedge;
+static clock_time_t task_completed;
+static routing_hedge_stats_t hedge_stats;
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static routing_attempt_t*
+attempt_find_free(void)
+{
+    for (uint8_t i = 0; i != ROUTING_TASK_ATTEMPTS; ++i)
+    {
+        routing_attempt_t* a = &attempts[i];
+
+        if (!timed_unlock_is_locked(&a->coap_callback_in_use) && !timed_unlock_is_locked(&a->task_in_use))
+        {
+            return a;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Find the attempt waiting on a response from this edge
+static routing_attempt_t*
+attempt_find_addr(const uip_ipaddr_t* addr)
+{
+    for (uint8_t i = 0; i != ROUTING_TASK_ATTEMPTS; ++i)
+    {
+        routing_attempt_t* a = &attempts[i];
+
+        if (timed_unlock_is_locked(&a->task_in_use) && uip_ipaddr_cmp(&a->ep.ipaddr, addr))
+        {
+            return a;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static routing_attempt_t*
+attempt_find_callback(const coap_callback_request_state_t* callback_state)
+{
+    for (uint8_t i = 0; i != ROUTING_TASK_ATTEMPTS; ++i)
+    {
+        if (&attempts[i].coap_callback == callback_state)
+        {
+            return &attempts[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static routing_attempt_t*
+attempt_find_task_in_use(const timed_unlock_t* lock)
+{
+    for (uint8_t i = 0; i != ROUTING_TASK_ATTEMPTS; ++i)
+    {
+        if (&attempts[i].task_in_use == lock)
+        {
+            return &attempts[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef ROUTING_HEDGING
+static uint32_t
+ticks_to_ms(clock_time_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000) / CLOCK_SECOND);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+hedge_stats_print(void)
+{
+    LOG_INFO("Hedge stats: tasks=%" PRIu32 " hedged=%" PRIu32 " hedge_won=%" PRIu32 " latency_saved=%" PRIu32 "ms\n",
+        hedge_stats.tasks, hedge_stats.hedged, hedge_stats.hedge_won, hedge_stats.latency_saved_ms);
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Called when an attempt will receive no more responses.
+// The first valid result completes the task, any other attempt at the same task is left to finish
+// so the trust model of that edge is still updated, but its result is ignored.
+static void
+attempt_finished(routing_attempt_t* a, bool valid)
+{
+#ifdef ROUTING_HEDGING
+    if (a->task_id != task_id)
+    {
+        // Loser of a previous task
+        return;
+    }
+
+    if (!task_complete)
+    {
+        if (valid)
+        {
+            task_complete = true;
+            task_won_by_hedge = a->hedge;
+            task_completed = clock_time();
+
+            ctimer_stop(&hedge_timer);
+
+            if (a->hedge)
+            {
+                hedge_stats.hedge_won += 1;
+            }
+
+            LOG_INFO("Task %" PRIu32 " completed by %s edge ", task_id, a->hedge ? "hedge" : "primary");
+            LOG_INFO_6ADDR(&a->ep.ipaddr);
+            LOG_INFO_(" after %" PRIu32 "ms\n", ticks_to_ms(task_completed - a->sent_time));
+
+            hedge_stats_print();
+        }
+    }
+    else
+    {
+        // This attempt lost, if it was to the primary edge then the hedge saved
+        // the time between the hedge completing and now
+        if (task_won_by_hedge)
+        {
+            hedge_stats.latency_saved_ms += ticks_to_ms(clock_time() - task_completed);
+
+            hedge_stats_print();
+        }
+    }
+#endif
+}
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
 generate_routing_request(uint8_t* buf, size_t buf_len, const coordinate_t* source, const coordinate_t* destination)
@@ -94,50 +298,150 @@ nanocbor_get_coordinate(nanocbor_value_t* dec, coordinate_t* coord)
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static int
-nanocbor_get_coordinate_from_payload(nanocbor_value_t* dec, coordinate_t* coord, int pos)
+static bool
+coordinate_is_valid(const coordinate_t* coord)
 {
-    nanocbor_value_t arr;
-    NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
+    // Also false for NaN
+    return coord->latitude >= -90.0f && coord->latitude <= 90.0f &&
+           coord->longitude >= -180.0f && coord->longitude <= 180.0f;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+route_decoder_init(route_decoder_t* route)
+{
+    memset(route, 0, sizeof(*route));
+    route->valid = true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Each block is an array of the coordinates that follow on from the previous block
+static void
+route_decoder_block(route_decoder_t* route, uint32_t num, const uint8_t* payload, int payload_len)
+{
+    if (num < route->next_block)
+    {
+        LOG_DBG("Ignoring repeated route block %" PRIu32 "\n", num);
+        return;
+    }
 
-    if (nanocbor_at_end(&arr))
+    if (num != route->next_block)
     {
-        return -1;
+        LOG_WARN("Missing route blocks %" PRIu32 " to %" PRIu32 "\n", route->next_block, num - 1);
+        route->valid = false;
     }
 
-    if (pos == 1)
+    route->next_block = num + 1;
+
+    if (!route->valid)
     {
-        NANOCBOR_CHECK(nanocbor_get_coordinate(&arr, coord));
+        return;
     }
-    else if (pos == -1)
+
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, payload, payload_len);
+
+    nanocbor_value_t arr;
+    if (nanocbor_enter_array(&dec, &arr) < 0)
     {
-        // This should be at least 1, due to the previous check of nanocbor_at_end
-        uint32_t remaining = arr.remaining;
+        LOG_WARN("Route block %" PRIu32 " is not an array\n", num);
+        route->valid = false;
+        return;
+    }
 
-        // Skip all but the last items
-        for (uint32_t i = 0; i < remaining - 1; ++i)
+    while (!nanocbor_at_end(&arr))
+    {
+        coordinate_t coord;
+        if (nanocbor_get_coordinate(&arr, &coord) < 0 || !coordinate_is_valid(&coord))
         {
-            NANOCBOR_CHECK(nanocbor_skip(&arr));
+            LOG_WARN("Invalid coordinate %" PRIu32 " in route block %" PRIu32 "\n", route->points, num);
+            route->valid = false;
+            return;
         }
 
-        NANOCBOR_CHECK(nanocbor_get_coordinate(&arr, coord));
+        if (route->points == 0)
+        {
+            route->first = coord;
+        }
+
+        route->last = coord;
+        route->points += 1;
     }
-    else
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A good route is well formed and goes from the source to the destination that were asked for
+static bool
+route_decoder_good(const route_decoder_t* route, const coordinate_t* src, const coordinate_t* dest)
+{
+    if (!route->valid || route->points == 0)
     {
-        assert(false);
+        return false;
     }
 
-    return NANOCBOR_OK;
+    bool good = true;
+
+    if (!isclose(route->first.latitude, src->latitude) || !isclose(route->first.longitude, src->longitude))
+    {
+        LOG_WARN("Bad result from edge first=(%f,%f) src=(%f,%f) not close enough\n",
+            route->first.latitude, route->first.longitude,
+            src->latitude, src->longitude
+        );
+        good = false;
+    }
+
+    if (!isclose(route->last.latitude, dest->latitude) || !isclose(route->last.longitude, dest->longitude))
+    {
+        LOG_WARN("Bad result from edge last=(%f,%f) dest=(%f,%f) not close enough\n",
+            route->last.latitude, route->last.longitude,
+            dest->latitude, dest->longitude
+        );
+        good = false;
+    }
+
+    return good;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The edge includes how long its routing tasks take and how many it has queued in the acknowledgement
+static bool
+decode_task_stats(const coap_message_t* response, application_stats_t* stats, uint16_t* queue_depth)
+{
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, response->payload, response->payload_len);
+
+    // Edges that failed to serialise their stats send null
+    if (nanocbor_get_null(&dec) == NANOCBOR_OK)
+    {
+        return false;
+    }
+
+    if (application_stats_deserialise(&dec, stats, queue_depth) != NANOCBOR_OK)
+    {
+        LOG_WARN("Failed to decode task stats from acknowledgement\n");
+        return false;
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+redirect_timer_callback(void* data);
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 send_callback(coap_callback_request_state_t* callback_state)
 {
+    routing_attempt_t* a = attempt_find_callback(callback_state);
+    assert(a != NULL);
+
     tm_task_submission_info_t info = {
         .coap_status = NO_ERROR,
         .coap_request_status = callback_state->state.status
     };
 
+    application_stats_t stats;
+    uint16_t queue_depth = 0;
+    bool has_stats = false;
+    bool task_finished = false;
+    bool accepted = false;
+    clock_time_t overloaded_for = 0;
+
     switch (callback_state->state.status)
     {
     case COAP_REQUEST_STATUS_RESPONSE:
@@ -147,12 +451,32 @@ send_callback(coap_callback_request_state_t* callback_state)
         if (response->code == CONTENT_2_05)
         {
             LOG_DBG("Message send complete with code CONTENT_2_05 (len=%d)\n", response->payload_len);
+
+            has_stats = decode_task_stats(response, &stats, &queue_depth);
+            accepted = true;
+        }
+        else if (response->code == SERVICE_UNAVAILABLE_5_03)
+        {
+            // The edge has too many tasks queued, Max-Age says how long to stay away for
+            uint32_t max_age;
+            coap_get_header_max_age(response, &max_age);
+
+            LOG_INFO("Edge ");
+            LOG_INFO_COAP_EP(&a->ep);
+            LOG_INFO_(" is overloaded for the next %" PRIu32 "s\n", max_age);
+
+            has_stats = decode_task_stats(response, &stats, &queue_depth);
+            overloaded_for = max_age * CLOCK_SECOND;
+
+            timed_unlock_unlock(&a->task_in_use);
+            task_finished = true;
         }
         else
         {
             LOG_WARN("Message send failed with code (%u) '%.*s' (len=%d)\n",
                 response->code, response->payload_len, response->payload, response->payload_len);
-            timed_unlock_unlock(&task_in_use);
+            timed_unlock_unlock(&a->task_in_use);
+            task_finished = true;
         }
 
         info.coap_status = response->code;
@@ -160,27 +484,51 @@ send_callback(coap_callback_request_state_t* callback_state)
 
     case COAP_REQUEST_STATUS_FINISHED:
     {
-        timed_unlock_unlock(&coap_callback_in_use);
+        timed_unlock_unlock(&a->coap_callback_in_use);
     } break;
 
     default:
     {
         LOG_ERR("Failed to send message due to %s(%d)\n",
             coap_request_status_to_string(callback_state->state.status), callback_state->state.status);
-        timed_unlock_unlock(&coap_callback_in_use);
-        timed_unlock_unlock(&task_in_use);
+        timed_unlock_unlock(&a->coap_callback_in_use);
+        timed_unlock_unlock(&a->task_in_use);
+        task_finished = true;
     } break;
     }
 
-    edge_resource_t* edge = edge_info_find_addr(&ep.ipaddr);
+    // The submission is over, so let the scheduler dispatch the next task
+    if (!timed_unlock_is_locked(&a->coap_callback_in_use) && a->sched_task != NULL)
+    {
+        offload_sched_task_done(a->sched_task);
+        a->sched_task = NULL;
+    }
+
+    if (task_finished)
+    {
+        attempt_finished(a, false);
+    }
+
+    // Submit the rejected task elsewhere once this request has finished
+    if (overloaded_for != 0)
+    {
+        ctimer_set(&redirect_timer, 0, redirect_timer_callback, a);
+    }
+
+    edge_resource_t* edge = edge_info_find_addr(&a->ep.ipaddr);
     if (edge == NULL)
     {
         LOG_WARN("Edge ");
-        LOG_WARN_COAP_EP(&ep);
+        LOG_WARN_COAP_EP(&a->ep);
         LOG_WARN_(" was removed between sending a task and receiving a acknowledgement\n");
         return;
     }
 
+    if (callback_state->state.status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        edge_info_rtt_update(edge, clock_time() - a->sent_time);
+    }
+
     // Find the information on the capability for this edge
     // If this capability no longer exists, then the Edge has informed us that it no longer
     // offers that capability
@@ -188,11 +536,32 @@ send_callback(coap_callback_request_state_t* callback_state)
     if (cap == NULL)
     {
         LOG_WARN("Edge ");
-        LOG_WARN_COAP_EP(&ep);
+        LOG_WARN_COAP_EP(&a->ep);
         LOG_WARN_(" removed capability " ROUTING_APPLICATION_NAME " between sending a task and receiving a acknowledgement\n");
         return;
     }
 
+    if (task_finished)
+    {
+        edge_capability_task_finished(cap);
+    }
+
+    if (has_stats)
+    {
+        // An edge that has not yet completed a task reports all zeros
+        if (stats.maximum != 0)
+        {
+            edge_capability_load_stats(cap, stats.mean, stats.variance);
+        }
+
+        edge_capability_queue_depth(cap, queue_depth);
+    }
+
+    if (accepted || overloaded_for != 0)
+    {
+        edge_capability_overloaded(cap, overloaded_for);
+    }
+
     tm_update_task_submission(edge, cap, &info);
 
 #ifdef APPLICATIONS_MONITOR_THROUGHPUT
@@ -274,24 +643,222 @@ end:
     return result;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static void
-event_triggered_action(const char* data)
+// Submit the current task to an edge
+static bool
+attempt_send(routing_attempt_t* a, edge_resource_t* edge)
 {
     int ret;
 
-    if (timed_unlock_is_locked(&coap_callback_in_use))
+    a->src = task_src;
+    a->dest = task_dest;
+    a->sched_task = NULL;
+
+    route_decoder_init(&a->route);
+
+    int len = generate_routing_request(a->msg_buf, sizeof(a->msg_buf), &a->src, &a->dest);
+    if (len <= 0 || len > sizeof(a->msg_buf))
+    {
+        LOG_ERR("Failed to generated message (%d)\n", len);
+        return false;
+    }
+
+    LOG_DBG("Generated message (len=%d) for path from (%f,%f) to (%f,%f)\n",
+        len,
+        a->src.latitude, a->src.longitude,
+        a->dest.latitude, a->dest.longitude);
+
+    // We need to store a local copy of the edge target
+    // As the edge resource object may be removed by the time we receive a response
+    coap_endpoint_copy(&a->ep, &edge->ep);
+
+    if (!coap_endpoint_is_connected(&a->ep))
+    {
+        LOG_DBG("We are not connected to ");
+        LOG_DBG_COAP_EP(&a->ep);
+        LOG_DBG_(", so will initiate a connection to it.\n");
+
+        // Initiate a connect
+        coap_endpoint_connect(&a->ep);
+
+        // Wait for a bit and then try sending again
+        //etimer_set(&publish_short_timer, SHORT_PUBLISH_PERIOD);
+        //return;
+    }
+
+    coap_init_message(&a->msg, COAP_TYPE_CON, COAP_POST, 0);
+    coap_set_header_uri_path(&a->msg, ROUTING_APPLICATION_URI);
+    coap_set_header_content_format(&a->msg, APPLICATION_CBOR);
+    coap_set_payload(&a->msg, a->msg_buf, len);
+
+    coap_set_random_token(&a->msg);
+
+#ifdef WITH_OSCORE
+    keystore_protect_coap_with_oscore(&a->msg, &a->ep);
+#endif
+
+    // Allow slower edges longer to respond
+    timed_unlock_set_duration(&a->task_in_use, edge_info_deadline(edge, ROUTING_TASK_PROCESSING_TIME));
+
+    a->sent_time = clock_time();
+
+    ret = coap_send_request(&a->coap_callback, &a->ep, &a->msg, send_callback);
+    if (ret)
+    {
+        edge_info_set_coap_timeout(edge, &a->coap_callback.state);
+
+        timed_unlock_lock(&a->task_in_use);
+        timed_unlock_lock(&a->coap_callback_in_use);
+
+        edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+        if (cap != NULL)
+        {
+            edge_capability_task_started(cap);
+        }
+
+        app_state_throughput_start_out(&app_state, len);
+    }
+    else
+    {
+        LOG_ERR("Failed to send message with %d\n", ret);
+    }
+
+    return ret != 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The edge the attempt was sent to rejected it as overloaded, so submit the task to the next best edge.
+// Overloaded edges are not chosen, so this stops once every edge is overloaded.
+static void
+redirect_timer_callback(void* data)
+{
+    routing_attempt_t* a = (routing_attempt_t*)data;
+
+#ifdef ROUTING_HEDGING
+    if (task_complete || a->task_id != task_id)
     {
-        LOG_WARN("Cannot generate a new message, as in process of sending one\n");
         return;
     }
+#endif
+
+    // A new task may have been submitted using this attempt in the meantime
+    if (timed_unlock_is_locked(&a->coap_callback_in_use) || timed_unlock_is_locked(&a->task_in_use))
+    {
+        return;
+    }
+
+    const edge_resource_t* overloaded_edge = edge_info_find_addr(&a->ep.ipaddr);
+
+    edge_resource_t* edge = choose_next_best_edge(ROUTING_APPLICATION_NAME, overloaded_edge);
+    if (edge == NULL)
+    {
+        LOG_WARN("No other edge available to redirect the rejected task to\n");
+        return;
+    }
+
+    if (attempt_find_addr(&edge->ep.ipaddr) != NULL)
+    {
+        LOG_INFO("Edge %s is still processing a task, so not redirecting the rejected task\n", edge_info_name(edge));
+        return;
+    }
+
+    if (attempt_send(a, edge))
+    {
+        LOG_INFO("Redirected rejected task to ");
+        LOG_INFO_COAP_EP(&a->ep);
+        LOG_INFO_("\n");
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef ROUTING_HEDGING
+// No result from the primary edge yet, so submit the same task to the next best edge
+static void
+hedge_timer_callback(void* data)
+{
+    const routing_attempt_t* primary = (const routing_attempt_t*)data;
 
-    if (timed_unlock_is_locked(&task_in_use))
+    if (task_complete || primary->task_id != task_id)
     {
-        LOG_WARN("Cannot generate a new task, as in process of processing one\n");
         return;
     }
 
-    if (!parse_input(data, &task_src, &task_dest))
+    // The primary edge may have been removed since the task was submitted to it
+    const edge_resource_t* primary_edge = edge_info_find_addr(&primary->ep.ipaddr);
+
+    edge_resource_t* edge = choose_next_best_edge(ROUTING_APPLICATION_NAME, primary_edge);
+    if (edge == NULL)
+    {
+        LOG_INFO("No other edge available to hedge task %" PRIu32 " with\n", task_id);
+        return;
+    }
+
+    if (attempt_find_addr(&edge->ep.ipaddr) != NULL)
+    {
+        LOG_INFO("Edge %s is still processing a task, so not hedging task %" PRIu32 "\n", edge_info_name(edge), task_id);
+        return;
+    }
+
+    routing_attempt_t* a = attempt_find_free();
+    if (a == NULL)
+    {
+        LOG_WARN("No space to hedge task %" PRIu32 "\n", task_id);
+        return;
+    }
+
+    a->task_id = task_id;
+    a->hedge = true;
+
+    if (attempt_send(a, edge))
+    {
+        hedge_stats.hedged += 1;
+
+        LOG_INFO("Hedged message sent to ");
+        LOG_INFO_COAP_EP(&a->ep);
+        LOG_INFO_("\n");
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+hedge_start(routing_attempt_t* primary, edge_resource_t* edge)
+{
+    clock_time_t delay = ROUTING_HEDGE_DEFAULT_DELAY;
+
+    const edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    if (cap != NULL)
+    {
+        const clock_time_t p90 = edge_capability_latency_p90(edge, cap);
+        if (p90 != 0)
+        {
+            delay = p90;
+        }
+    }
+
+    if (delay < ROUTING_HEDGE_MIN_DELAY)
+    {
+        delay = ROUTING_HEDGE_MIN_DELAY;
+    }
+
+    LOG_DBG("Will hedge task %" PRIu32 " in %lu ticks\n", task_id, (unsigned long)delay);
+
+    ctimer_set(&hedge_timer, delay, hedge_timer_callback, primary);
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+event_triggered_action(const char* data)
+{
+    // Not a routing request
+    if (match_action(data, data + strlen(data), MEMB_STATS_SERIAL_COMMAND) ||
+        match_action(data, data + strlen(data), PROF_SERIAL_COMMAND))
+    {
+        return;
+    }
+
+    if (pending_task != NULL)
+    {
+        LOG_WARN("Cannot generate a new task, as one is waiting to be dispatched\n");
+        return;
+    }
+
+    if (!parse_input(data, &pending_src, &pending_dest))
     {
         LOG_WARN("Invalid command '%s'\n", data);
         return;
@@ -303,69 +870,89 @@ event_triggered_action(const char* data)
         return;
     }
 
-    int len = generate_routing_request(msg_buf, sizeof(msg_buf), &task_src, &task_dest);
-    if (len <= 0 || len > sizeof(msg_buf))
+    pending_task = offload_sched_enqueue(NULL, ROUTING_DISPATCH_DEADLINE, ROUTING_PRIORITY,
+                                         ROUTING_TASK_KIND, OFFLOAD_SCHED_NO_FLAGS);
+    if (pending_task == NULL)
     {
-        LOG_ERR("Failed to generated message (%d)\n", len);
-        return;
+        LOG_WARN("Cannot generate a new task, as the offload scheduler is full\n");
     }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+dispatch_action(offload_task_t* task)
+{
+    pending_task = NULL;
 
-    LOG_DBG("Generated message (len=%d) for path from (%f,%f) to (%f,%f)\n",
-        len,
-        task_src.latitude, task_src.longitude,
-        task_dest.latitude, task_dest.longitude);
+    routing_attempt_t* a = attempt_find_free();
+    if (a == NULL)
+    {
+        LOG_WARN("Cannot generate a new task, as in process of sending or processing one\n");
+        offload_sched_task_done(task);
+        return;
+    }
 
     // Choose an Edge node to send information to
+    PROF_BEGIN(CHOOSE_EDGE);
     edge_resource_t* edge = choose_edge(ROUTING_APPLICATION_NAME);
+    PROF_END(CHOOSE_EDGE);
     if (edge == NULL)
     {
         LOG_ERR("Failed to find an edge resource to send task to\n");
+        offload_sched_task_done(task);
         return;
     }
 
-    // We need to store a local copy of the edge target
-    // As the edge resource object may be removed by the time we receive a response
-    coap_endpoint_copy(&ep, &edge->ep);
-
-    if (!coap_endpoint_is_connected(&ep))
+    // Responses are matched to tasks by the edge they came from
+    if (attempt_find_addr(&edge->ep.ipaddr) != NULL)
     {
-        LOG_DBG("We are not connected to ");
-        LOG_DBG_COAP_EP(&ep);
-        LOG_DBG_(", so will initiate a connection to it.\n");
-
-        // Initiate a connect
-        coap_endpoint_connect(&ep);
-
-        // Wait for a bit and then try sending again
-        //etimer_set(&publish_short_timer, SHORT_PUBLISH_PERIOD);
-        //return;
+        LOG_WARN("Cannot generate a new task, as edge %s is still processing one\n", edge_info_name(edge));
+        offload_sched_task_done(task);
+        return;
     }
 
-    coap_init_message(&msg, COAP_TYPE_CON, COAP_POST, 0);
-    coap_set_header_uri_path(&msg, ROUTING_APPLICATION_URI);
-    coap_set_header_content_format(&msg, APPLICATION_CBOR);
-    coap_set_payload(&msg, msg_buf, len);
+    task_src = pending_src;
+    task_dest = pending_dest;
 
-    coap_set_random_token(&msg);
+#ifdef ROUTING_HEDGING
+    // Any attempt still outstanding for the previous task will be ignored
+    ctimer_stop(&hedge_timer);
 
-#ifdef WITH_OSCORE
-    keystore_protect_coap_with_oscore(&msg, &ep);
+    task_id += 1;
+    task_complete = false;
+    task_won_by_hedge = false;
+
+    a->task_id = task_id;
+    a->hedge = false;
 #endif
 
-    ret = coap_send_request(&coap_callback, &ep, &msg, send_callback);
-    if (ret)
+    if (attempt_send(a, edge))
     {
-        timed_unlock_lock(&task_in_use);
-        timed_unlock_lock(&coap_callback_in_use);
         LOG_DBG("Message sent to ");
-        LOG_DBG_COAP_EP(&ep);
+        LOG_DBG_COAP_EP(&a->ep);
         LOG_DBG_("\n");
 
-        app_state_throughput_start_out(&app_state, len);
+        offload_sched_task_sent(task, edge);
+        a->sched_task = task;
+
+#ifdef ROUTING_HEDGING
+        hedge_stats.tasks += 1;
+
+        hedge_start(a, edge);
+#endif
     }
     else
     {
-        LOG_ERR("Failed to send message with %d\n", ret);
+        offload_sched_task_done(task);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+dropped_action(offload_task_t* task)
+{
+    if (task == pending_task)
+    {
+        LOG_WARN("Task was dropped as it could not be dispatched before its deadline\n");
+        pending_task = NULL;
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -428,15 +1015,17 @@ routing_response_process_status(coap_message_t *request)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
-routing_process_task_timeout(void)
+routing_process_task_timeout(routing_attempt_t* a)
 {
     LOG_WARN("Timed out while waiting for response for the routing task\n");
 
-    edge_resource_t* edge = edge_info_find_addr(&ep.ipaddr);
+    attempt_finished(a, false);
+
+    edge_resource_t* edge = edge_info_find_addr(&a->ep.ipaddr);
     if (!edge)
     {
         LOG_ERR("Unable to find edge this task was sent to: ");
-        LOG_ERR_COAP_EP(coap_callback.state.remote_endpoint);
+        LOG_ERR_COAP_EP(&a->ep);
         LOG_ERR_("\n");
         return;
     }
@@ -445,11 +1034,13 @@ routing_process_task_timeout(void)
     if (!cap)
     {
         LOG_ERR("Failed to find capability " ROUTING_APPLICATION_NAME " for edge ");
-        LOG_ERR_COAP_EP(coap_callback.state.remote_endpoint);
+        LOG_ERR_COAP_EP(&a->ep);
         LOG_ERR_("\n");
         return;
     }
 
+    edge_capability_task_finished(cap);
+
     // When the response times out, we need to log that an error occurred
     const tm_task_result_info_t info = {
         .result = TM_TASK_RESULT_INFO_TIMEOUT
@@ -458,13 +1049,15 @@ routing_process_task_timeout(void)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
-routing_process_task_result(coap_message_t *request, const tm_result_quality_info_t* info)
+routing_process_task_result(routing_attempt_t* a, coap_message_t *request, const tm_result_quality_info_t* info)
 {
+    attempt_finished(a, info->good);
+
     edge_resource_t* edge = edge_info_find_addr(&request->src_ep->ipaddr);
     if (!edge)
     {
         LOG_ERR("Unable to find edge this task was sent to: ");
-        LOG_ERR_COAP_EP(coap_callback.state.remote_endpoint);
+        LOG_ERR_COAP_EP(&a->ep);
         LOG_ERR_("\n");
         return;
     }
@@ -473,11 +1066,13 @@ routing_process_task_result(coap_message_t *request, const tm_result_quality_inf
     if (!cap)
     {
         LOG_ERR("Failed to find capability " ROUTING_APPLICATION_NAME " for edge ");
-        LOG_ERR_COAP_EP(coap_callback.state.remote_endpoint);
+        LOG_ERR_COAP_EP(&a->ep);
         LOG_ERR_("\n");
         return;
     }
 
+    edge_capability_task_finished(cap);
+
     tm_update_result_quality(edge, cap, info);
 
 #ifdef APPLICATIONS_MONITOR_THROUGHPUT
@@ -520,7 +1115,8 @@ res_coap_routing_post_handler(coap_message_t *request, coap_message_t *response,
 
     // Check if we are expecting a response
     // We might have timed out
-    if (!timed_unlock_is_locked(&task_in_use))
+    routing_attempt_t* a = attempt_find_addr(&request->src_ep->ipaddr);
+    if (a == NULL)
     {
         LOG_ERR("Received a task response that we were not expecting\n");
 
@@ -530,7 +1126,7 @@ res_coap_routing_post_handler(coap_message_t *request, coap_message_t *response,
     }
 
     // Got a response within the time limit, so restart the timer for the next packet
-    timed_unlock_restart_timer(&task_in_use);
+    timed_unlock_restart_timer(&a->task_in_use);
 
     if (!coap_is_option(request, COAP_OPTION_BLOCK1))
     {
@@ -574,56 +1170,20 @@ res_coap_routing_post_handler(coap_message_t *request, coap_message_t *response,
 #endif
 
         // Update trust model with success if the start and end are as expected
-
-        // First block
-        if (b1_num == 0)
-        {
-            // Check first item (origin) is as expected
-            nanocbor_value_t dec;
-            nanocbor_decoder_init(&dec, payload, payload_len);
-
-            coordinate_t first;
-            nanocbor_get_coordinate_from_payload(&dec, &first, 1);
-
-            first_src_isclose = isclose(first.latitude, task_src.latitude) && isclose(first.longitude, task_src.longitude);
-
-            if (!first_src_isclose)
-            {
-                LOG_WARN("Bad result from edge first=(%f,%f) src=(%f,%f) not close enough\n",
-                    first.latitude, first.longitude,
-                    task_src.latitude, task_src.longitude
-                );
-            }
-        }
+        route_decoder_block(&a->route, b1_num, payload, payload_len);
 
         // last block
         if (!b1_more)
         {
-            // Check last item (destination) is as expected
-            nanocbor_value_t dec;
-            nanocbor_decoder_init(&dec, payload, payload_len);
-
-            coordinate_t last;
-            nanocbor_get_coordinate_from_payload(&dec, &last, -1);
-
-            // Update trust model
-            const bool last_dest_isclose = isclose(last.latitude, task_dest.latitude) && isclose(last.longitude, task_dest.longitude);
-
-            if (!last_dest_isclose)
-            {
-                LOG_WARN("Bad result from edge last=(%f,%f) dest=(%f,%f) not close enough\n",
-                    last.latitude, last.longitude,
-                    task_dest.latitude, task_dest.longitude
-                );
-            }
+            LOG_DBG("Received route with %" PRIu32 " points\n", a->route.points);
 
             const tm_result_quality_info_t info = {
-                .good = (first_src_isclose && last_dest_isclose)
+                .good = route_decoder_good(&a->route, &a->src, &a->dest)
             };
 
-            routing_process_task_result(request, &info);
+            timed_unlock_unlock(&a->task_in_use);
 
-            timed_unlock_unlock(&task_in_use);
+            routing_process_task_result(a, request, &info);
         }
 
         // TODO: output this information for the client
@@ -657,8 +1217,20 @@ init(void)
 
     app_state_init(&app_state, ROUTING_APPLICATION_NAME, ROUTING_APPLICATION_URI);
 
-    timed_unlock_init(&coap_callback_in_use, "routing-coap", (1 * 60 * CLOCK_SECOND));
-    timed_unlock_init(&task_in_use, "routing-task", (2 * 60 * CLOCK_SECOND));
+    for (uint8_t i = 0; i != ROUTING_TASK_ATTEMPTS; ++i)
+    {
+        timed_unlock_init(&attempts[i].coap_callback_in_use, "routing-coap", (1 * 60 * CLOCK_SECOND));
+        timed_unlock_init(&attempts[i].task_in_use, "routing-task", (2 * 60 * CLOCK_SECOND)); // Duration set per edge
+        attempts[i].sched_task = NULL;
+    }
+
+    pending_task = NULL;
+
+#ifdef ROUTING_HEDGING
+    task_id = 0;
+    task_complete = true;
+    memset(&hedge_stats, 0, sizeof(hedge_stats));
+#endif
 
 #ifdef ROUTING_PERIODIC_TEST
     routing_periodic_test_init();
@@ -679,6 +1251,14 @@ PROCESS_THREAD(routing_process, ev, data)
             event_triggered_action((const char*)data);
         }
 
+        if (ev == pe_offload_task_dispatch) {
+            dispatch_action((offload_task_t*)data);
+        }
+
+        if (ev == pe_offload_task_dropped) {
+            dropped_action((offload_task_t*)data);
+        }
+
         if (ev == pe_edge_capability_add) {
             edge_capability_add((edge_resource_t*)data);
         }
@@ -687,8 +1267,11 @@ PROCESS_THREAD(routing_process, ev, data)
             edge_capability_remove((edge_resource_t*)data);
         }
 
-        if (ev == pe_timed_unlock_unlocked && data == &task_in_use) {
-            routing_process_task_timeout();
+        if (ev == pe_timed_unlock_unlocked) {
+            routing_attempt_t* a = attempt_find_task_in_use((const timed_unlock_t*)data);
+            if (a != NULL) {
+                routing_process_task_timeout(a);
+            }
         }
     }
 
@@ -10,20 +10,11 @@
 #include "routing.h"
 #include "applications.h"
 #include "application-serial.h"
-#include "random-helpers.h"
 
 #ifndef ROUTING_PERIODIC_TEST
 #error "Must define ROUTING_PERIODIC_TEST to use"
 #endif
 
-/*-------------------------------------------------------------------------------------------------------------------*/
-#ifndef GENERATE_ROUTE_MIN_PERIOD
-#define GENERATE_ROUTE_MIN_PERIOD (2 * 60)
-#endif
-/*-------------------------------------------------------------------------------------------------------------------*/
-#ifndef GENERATE_ROUTE_MAX_PERIOD
-#define GENERATE_ROUTE_MAX_PERIOD (3 * 60)
-#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "A-" ROUTING_APPLICATION_NAME
 #ifdef APP_ROUTING_LOG_LEVEL
@@ -44,7 +35,7 @@ void routing_periodic_test_init(void)
 /*-------------------------------------------------------------------------------------------------------------------*/
 static bool init(void)
 {
-    uint16_t rnd_period = random_in_range_unbiased(GENERATE_ROUTE_MIN_PERIOD, GENERATE_ROUTE_MAX_PERIOD);
+    uint16_t rnd_period = routing_generate_route_period();
     etimer_set(&generate_route_timer, rnd_period * CLOCK_SECOND);
 
     LOG_INFO("Started timer to generate route request in %" PRIu16 " seconds\n", rnd_period);
@@ -70,7 +61,7 @@ static void periodic_event(void)
     process_post_synch(routing_application, serial_line_event_message, (process_data_t)buf);
 
     // Restart timer
-    uint16_t rnd_period = random_in_range_unbiased(GENERATE_ROUTE_MIN_PERIOD, GENERATE_ROUTE_MAX_PERIOD);
+    uint16_t rnd_period = routing_generate_route_period();
     etimer_reset_with_new_interval(&generate_route_timer, rnd_period * CLOCK_SECOND);
 
     LOG_INFO("Restarted timer to generate route request in %" PRIu16 " seconds\n", rnd_period);
@@ -0,0 +1,9 @@
+#include "routing.h"
+
+#include "random-helpers.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t routing_generate_route_period(void)
+{
+    return random_in_range_unbiased(GENERATE_ROUTE_MIN_PERIOD, GENERATE_ROUTE_MAX_PERIOD);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
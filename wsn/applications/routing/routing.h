@@ -1,12 +1,31 @@
 #pragma once
 
+#include <stdint.h>
+
 #define ROUTING_APPLICATION_NAME "routing"
 #define ROUTING_APPLICATION_URI "routing"
 
 #define ROUTING_SUBMIT_TASK "submit-task:route-req:"
 
+// How long an edge is expected to take to process a routing task,
+// the deadline for each response also allows for the round trip time to the edge
+#ifndef ROUTING_TASK_PROCESSING_TIME
+#define ROUTING_TASK_PROCESSING_TIME (100 * CLOCK_SECOND)
+#endif
+
+// Seconds between the routing requests generated when testing (see routing-periodic-test.c)
+#ifndef GENERATE_ROUTE_MIN_PERIOD
+#define GENERATE_ROUTE_MIN_PERIOD (2 * 60)
+#endif
+#ifndef GENERATE_ROUTE_MAX_PERIOD
+#define GENERATE_ROUTE_MAX_PERIOD (3 * 60)
+#endif
+
 void init_trust_weights_routing(void);
 
+// Seconds until the next generated routing request
+uint16_t routing_generate_route_period(void);
+
 typedef struct {
     float latitude;
     float longitude;
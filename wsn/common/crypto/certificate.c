@@ -1,6 +1,7 @@
 #include "certificate.h"
 
 #include "nanocbor-helper.h"
+#include "prof.h"
 
 #include "cc.h"
 #include "os/sys/log.h"
@@ -108,7 +109,7 @@ static int certificate_decode_tbs(nanocbor_value_t* dec, certificate_t* certific
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int certificate_decode(nanocbor_value_t* dec, certificate_t* certificate)
+static int certificate_decode_internal(nanocbor_value_t* dec, certificate_t* certificate)
 {
     nanocbor_value_t arr;
     nanocbor_enter_array(dec, &arr);
@@ -129,3 +130,12 @@ int certificate_decode(nanocbor_value_t* dec, certificate_t* certificate)
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+int certificate_decode(nanocbor_value_t* dec, certificate_t* certificate)
+{
+    PROF_BEGIN(CERTIFICATE_DECODE);
+    const int ret = certificate_decode_internal(dec, certificate);
+    PROF_END(CERTIFICATE_DECODE);
+
+    return ret;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -5,6 +5,8 @@
 #include "os/lib/assert.h"
 #include "os/lib/queue.h"
 #include "os/lib/memb.h"
+#include "memb-stats.h"
+#include "prof.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef MESSAGES_TO_SIGN_SIZE
 #define MESSAGES_TO_SIGN_SIZE 3
@@ -51,7 +53,7 @@ MEMB(messages_to_verify_memb, messages_to_verify_entry_t, MESSAGES_TO_VERIFY_SIZ
 bool queue_message_to_sign(struct process* process, void* data,
                            uint8_t* message, uint16_t message_buffer_len, uint16_t message_len)
 {
-    messages_to_sign_entry_t* item = memb_alloc(&messages_to_sign_memb);
+    messages_to_sign_entry_t* item = memb_stats_alloc(&messages_to_sign_memb);
     if (!item)
     {
         LOG_WARN("queue_message_to_sign: out of memory\n");
@@ -63,6 +65,7 @@ bool queue_message_to_sign(struct process* process, void* data,
     item->message = message;
     item->message_buffer_len = message_buffer_len;
     item->message_len = message_len;
+    PROF_STAMP(item->prof_stamp);
 
     queue_enqueue(messages_to_sign, item);
 
@@ -82,6 +85,7 @@ PROCESS_THREAD(signer, ev, data)
 
     queue_init(messages_to_sign);
     memb_init(&messages_to_sign_memb);
+    MEMB_STATS_REGISTER(messages_to_sign_memb);
 
     while (1)
     {
@@ -90,10 +94,15 @@ PROCESS_THREAD(signer, ev, data)
         static messages_to_sign_entry_t* sitem;
         sitem = (messages_to_sign_entry_t*)queue_dequeue(messages_to_sign);
 
+        PROF_SINCE(SIGN_QUEUE, sitem->prof_stamp);
+        PROF_STAMP(sitem->prof_stamp);
+
         static sign_state_t sign_state;
         ECC_SIGN_GET_PROCESS(sign_state) = &signer;
         PROCESS_PT_SPAWN(&sign_state.pt, ecc_sign(&sign_state, sitem->message, sitem->message_buffer_len, sitem->message_len));
 
+        PROF_SINCE(SIGN, sitem->prof_stamp);
+
         sitem->result = ECC_SIGN_GET_RESULT(sign_state);
 
         if (process_post(sitem->process, pe_message_signed, sitem) != PROCESS_ERR_OK)
@@ -112,7 +121,7 @@ bool queue_message_to_verify(struct process* process, void* data,
                              const uint8_t* message, uint16_t message_len,
                              const ecdsa_secp256r1_pubkey_t* pubkey)
 {
-    messages_to_verify_entry_t* item = memb_alloc(&messages_to_verify_memb);
+    messages_to_verify_entry_t* item = memb_stats_alloc(&messages_to_verify_memb);
     if (!item)
     {
         LOG_WARN("queue_message_to_verify: out of memory\n");
@@ -124,6 +133,7 @@ bool queue_message_to_verify(struct process* process, void* data,
     item->message = message;
     item->message_len = message_len;
     item->pubkey = pubkey;
+    PROF_STAMP(item->prof_stamp);
 
     queue_enqueue(messages_to_verify, item);
 
@@ -143,6 +153,7 @@ PROCESS_THREAD(verifier, ev, data)
 
     queue_init(messages_to_verify);
     memb_init(&messages_to_verify_memb);
+    MEMB_STATS_REGISTER(messages_to_verify_memb);
 
     while (1)
     {
@@ -151,10 +162,15 @@ PROCESS_THREAD(verifier, ev, data)
         static messages_to_verify_entry_t* vitem;
         vitem = (messages_to_verify_entry_t*)queue_dequeue(messages_to_verify);
 
+        PROF_SINCE(VERIFY_QUEUE, vitem->prof_stamp);
+        PROF_STAMP(vitem->prof_stamp);
+
         static verify_state_t verify_state;
         ECC_VERIFY_GET_PROCESS(verify_state) = &verifier;
         PROCESS_PT_SPAWN(&verify_state.pt, ecc_verify(&verify_state, vitem->pubkey, vitem->message, vitem->message_len));
 
+        PROF_SINCE(VERIFY, vitem->prof_stamp);
+
         vitem->result = ECC_VERIFY_GET_RESULT(verify_state);
 
         if (process_post(vitem->process, pe_message_verified, vitem) != PROCESS_ERR_OK)
@@ -169,3 +185,10 @@ PROCESS_THREAD(verifier, ev, data)
     PROCESS_END();
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+uint8_t
+crypto_support_pending(void)
+{
+    return (MESSAGES_TO_SIGN_SIZE - memb_numfree(&messages_to_sign_memb)) +
+           (MESSAGES_TO_VERIFY_SIZE - memb_numfree(&messages_to_verify_memb));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -8,6 +8,7 @@
 #include "platform-crypto-support.h"
 
 #include "contiki.h"
+#include "os/sys/rtimer.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef SHA256_DIGEST_LEN_BYTES
 #define SHA256_DIGEST_LEN_BYTES (256 / 8)
@@ -32,6 +33,10 @@ typedef struct messages_to_sign_entry
     // The result of signing
     uint8_t result;
 
+#ifdef PROF_ENABLED
+    rtimer_clock_t prof_stamp;
+#endif
+
 } messages_to_sign_entry_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool queue_message_to_sign(struct process* process, void* data,
@@ -56,6 +61,10 @@ typedef struct messages_to_verify_entry
     // User supplied data
     void* data;
 
+#ifdef PROF_ENABLED
+    rtimer_clock_t prof_stamp;
+#endif
+
 } messages_to_verify_entry_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool queue_message_to_verify(struct process* process, void* data,
@@ -66,3 +75,6 @@ void queue_message_to_verify_done(messages_to_verify_entry_t* item);
 extern process_event_t pe_message_signed;
 extern process_event_t pe_message_verified;
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Number of sign and verify requests that are queued or in progress
+uint8_t crypto_support_pending(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
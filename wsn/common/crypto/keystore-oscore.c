@@ -54,6 +54,11 @@ bool keystore_protect_coap_with_oscore(coap_message_t* request, const coap_endpo
             LOG_WARN("Failed to find oscore context for ");
             LOG_WARN_6ADDR(&ep->ipaddr);
             LOG_WARN_(", request will not be protected.\n");
+
+#ifdef KEYSTORE_LAZY_VERIFICATION
+            // The context is needed, so start verifying the certificate (or obtain it)
+            request_public_key(&ep->ipaddr);
+#endif
         }
 
         return pubkeyitem != NULL;
@@ -2,6 +2,7 @@
 
 #include "os/lib/assert.h"
 #include "os/lib/memb.h"
+#include "memb-stats.h"
 #include "os/lib/list.h"
 #include "os/sys/log.h"
 #include "os/net/ipv6/uiplib.h"
@@ -24,9 +25,38 @@
 PROCESS(keystore_add_verifier, "keystore_add_verifier"); // Processes verifying the certificate
 /*-------------------------------------------------------------------------------------------------------------------*/
 MEMB(public_keys_memb, public_key_item_t, PUBLIC_KEYSTORE_SIZE);
-LIST(public_keys);
+LIST(public_keys); // Most recently used at the head
 LIST(public_keys_to_verify);
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef KEYSTORE_LAZY_VERIFICATION
+// Certificates that have been received, but will only be verified when needed.
+// These do not need an OSCORE context, so are stored separately to public_key_item_t.
+typedef struct keystore_unverified {
+    struct keystore_unverified *next;
+
+    certificate_t cert;
+} keystore_unverified_t;
+
+MEMB(unverified_memb, keystore_unverified_t, KEYSTORE_UNVERIFIED_SIZE);
+LIST(public_keys_unverified); // Most recently received at the head
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Shared secrets are kept after a certificate is evicted, so that when the peer is
+// re-admitted the same certificate does not need to be verified and ECDH performed again.
+typedef struct keystore_secret {
+    struct keystore_secret *next;
+
+    uint8_t eui64[EUI64_LENGTH];
+
+    // Truncated SHA-256 of the verified certificate (TBS + signature)
+    uint8_t cert_hash[KEYSTORE_SECRET_CACHE_HASH_LEN];
+
+    uint8_t shared_secret[DTLS_EC_KEY_SIZE];
+} keystore_secret_t;
+
+MEMB(secret_cache_memb, keystore_secret_t, KEYSTORE_SECRET_CACHE_SIZE);
+LIST(secret_cache); // Most recently used at the head
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 uip_ip6addr_normalise(const uip_ip6addr_t* in, uip_ip6addr_t* out)
 {
@@ -44,7 +74,7 @@ uip_ip6addr_normalise(const uip_ip6addr_t* in, uip_ip6addr_t* out)
 static public_key_item_t*
 keystore_find_in_list(const uint8_t* eui64, list_t l)
 {
-    for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
+    for (public_key_item_t* iter = list_head(l); iter != NULL; iter = list_item_next(iter))
     {
         if (memcmp(&iter->cert.subject, eui64, EUI64_LENGTH) == 0)
         {
@@ -73,6 +103,13 @@ keystore_find_addr(const uip_ip6addr_t* addr)
     return keystore_find(eui64);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static void
+keystore_mark_used(public_key_item_t* item)
+{
+    list_remove(public_keys, item);
+    list_push(public_keys, item);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 const ecdsa_secp256r1_pubkey_t* keystore_find_pubkey(const uip_ip6addr_t* addr)
 {
     public_key_item_t* item = keystore_find_addr(addr);
@@ -81,6 +118,8 @@ const ecdsa_secp256r1_pubkey_t* keystore_find_pubkey(const uip_ip6addr_t* addr)
         return NULL;
     }
 
+    keystore_mark_used(item);
+
     return &item->cert.public_key;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -104,6 +143,16 @@ bool keystore_certificate_contains_tags(const stereotype_tags_t* tags)
         }
     }
 
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    for (keystore_unverified_t* iter = list_head(public_keys_unverified); iter != NULL; iter = list_item_next(iter))
+    {
+        if (stereotype_tags_equal(tags, &iter->cert.tags))
+        {
+            return true;
+        }
+    }
+#endif
+
     return false;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -136,6 +185,8 @@ static bool
 keystore_free_up_space(void)
 {
     // We need to try to free up space for a new certificate.
+    // The least recently used certificate that can be evicted is the last one in the list.
+    public_key_item_t* lru = NULL;
 
     for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
     {
@@ -151,19 +202,82 @@ keystore_free_up_space(void)
             continue;
         }
 
-        // TODO: Consider removing specific certificates (e.g., LRU)
-        // (see: https://en.wikipedia.org/wiki/Cache_replacement_policies)
-        if (keystore_remove(iter))
+        lru = iter;
+    }
+
+    if (lru == NULL || !keystore_remove(lru))
+    {
+        return false;
+    }
+
+    memb_stats_evicted(&public_keys_memb);
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static keystore_secret_t*
+secret_cache_find(const uint8_t* eui64)
+{
+    for (keystore_secret_t* iter = list_head(secret_cache); iter != NULL; iter = list_item_next(iter))
+    {
+        if (memcmp(iter->eui64, eui64, EUI64_LENGTH) == 0)
         {
-            return true;
+            return iter;
         }
     }
 
-    return false;
+    return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool
-keystore_add(const certificate_t* cert)
+static void
+secret_cache_add(const uint8_t* eui64, const uint8_t* cert_hash, const uint8_t* shared_secret)
+{
+    // The root's certificate is never evicted, so there is no need to cache its secret
+    if (memcmp(eui64, root_cert.subject, EUI64_LENGTH) == 0)
+    {
+        return;
+    }
+
+    keystore_secret_t* item = secret_cache_find(eui64);
+    if (item)
+    {
+        list_remove(secret_cache, item);
+    }
+    else
+    {
+        item = memb_stats_alloc(&secret_cache_memb);
+        if (!item)
+        {
+            // Reuse the least recently used entry
+            item = list_chop(secret_cache);
+            assert(item != NULL);
+
+            memb_stats_evicted(&secret_cache_memb);
+        }
+    }
+
+    memcpy(item->eui64, eui64, EUI64_LENGTH);
+    memcpy(item->cert_hash, cert_hash, KEYSTORE_SECRET_CACHE_HASH_LEN);
+    memcpy(item->shared_secret, shared_secret, DTLS_EC_KEY_SIZE);
+
+    list_push(secret_cache, item);
+
+    LOG_DBG("Cached shared secret for ");
+    LOG_DBG_BYTES(eui64, EUI64_LENGTH);
+    LOG_DBG_("\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+keystore_context_ready(const public_key_item_t* item, bool cached)
+{
+#ifdef KEYSTORE_TIME_METRICS
+    LOG_INFO("OSCORE context ready for ");
+    LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
+    LOG_INFO_(" after %lu ticks (cached=%d)\n", (unsigned long)(clock_time() - item->added), cached);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+keystore_add_internal(const certificate_t* cert, bool may_evict)
 {
     // Check if this certificate is already present
     public_key_item_t* item = keystore_find(cert->subject);
@@ -182,9 +296,14 @@ keystore_add(const certificate_t* cert)
     }
 
     // No item has this certificate so allocate memory for it
-    item = memb_alloc(&public_keys_memb);
+    item = memb_stats_alloc(&public_keys_memb);
     if (!item)
     {
+        if (!may_evict)
+        {
+            return false;
+        }
+
         LOG_WARN("keystore_add: out of memory (1st) for ");
         LOG_WARN_BYTES(cert->subject, EUI64_LENGTH);
         LOG_WARN_("\n");
@@ -198,7 +317,7 @@ keystore_add(const certificate_t* cert)
         }
         else
         {
-            item = memb_alloc(&public_keys_memb);
+            item = memb_stats_alloc(&public_keys_memb);
             if (item == NULL)
             {
                 LOG_WARN("keystore_add: out of memory (2nd) for ");
@@ -221,7 +340,9 @@ keystore_add(const certificate_t* cert)
 
     item->cert = *cert;
 
-    //item->age = clock_time();
+#ifdef KEYSTORE_TIME_METRICS
+    item->added = clock_time();
+#endif
     item->pin_count = 0;
 
     list_add(public_keys_to_verify, item);
@@ -231,6 +352,136 @@ keystore_add(const certificate_t* cert)
     return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+bool
+keystore_add(const certificate_t* cert)
+{
+    return keystore_add_internal(cert, true);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef KEYSTORE_LAZY_VERIFICATION
+static keystore_unverified_t*
+keystore_find_unverified(const uint8_t* eui64)
+{
+    for (keystore_unverified_t* iter = list_head(public_keys_unverified); iter != NULL; iter = list_item_next(iter))
+    {
+        if (memcmp(iter->cert.subject, eui64, EUI64_LENGTH) == 0)
+        {
+            return iter;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+keystore_add_unverified(const certificate_t* cert)
+{
+    // No need to store the certificate if it is verified or being verified
+    if (keystore_find(cert->subject) != NULL ||
+        keystore_find_in_list(cert->subject, public_keys_to_verify) != NULL)
+    {
+        return true;
+    }
+
+    keystore_unverified_t* item = keystore_find_unverified(cert->subject);
+    if (item)
+    {
+        list_remove(public_keys_unverified, item);
+    }
+    else
+    {
+        item = memb_stats_alloc(&unverified_memb);
+        if (!item)
+        {
+            // Drop the certificate we have not heard about for the longest time,
+            // it can be requested from the key server if it is needed later.
+            item = list_chop(public_keys_unverified);
+            if (!item)
+            {
+                return false;
+            }
+
+            memb_stats_evicted(&unverified_memb);
+
+            LOG_DBG("Dropping unverified key for ");
+            LOG_DBG_BYTES(item->cert.subject, EUI64_LENGTH);
+            LOG_DBG_("\n");
+        }
+    }
+
+    LOG_DBG("Storing unverified key for ");
+    LOG_DBG_BYTES(cert->subject, EUI64_LENGTH);
+    LOG_DBG_(" to be verified when needed\n");
+
+    item->cert = *cert;
+
+    list_push(public_keys_unverified, item);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+keystore_verify_unverified(const uint8_t* eui64, bool may_evict)
+{
+    keystore_unverified_t* item = keystore_find_unverified(eui64);
+    if (!item)
+    {
+        return false;
+    }
+
+    LOG_DBG("Key for ");
+    LOG_DBG_BYTES(eui64, EUI64_LENGTH);
+    LOG_DBG_(" is now needed, queuing it to be verified\n");
+
+    if (!keystore_add_internal(&item->cert, may_evict))
+    {
+        // Leave the certificate where it is, so we can try again later
+        return false;
+    }
+
+    list_remove(public_keys_unverified, item);
+    memb_free(&unverified_memb, item);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+keystore_request_verification(const uip_ip6addr_t* addr, bool may_evict)
+{
+    uip_ip6addr_t norm_addr;
+    uip_ip6addr_normalise(addr, &norm_addr);
+
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(&norm_addr, eui64);
+
+    public_key_item_t* item = keystore_find(eui64);
+    if (item != NULL)
+    {
+        keystore_mark_used(item);
+        return true;
+    }
+
+    if (keystore_find_unverified(eui64) != NULL)
+    {
+        // Unless the caller knows the key is preferred over those already verified, only verify
+        // it if there is space. Evicting a verified key would just mean verifying it again later.
+        if (!keystore_verify_unverified(eui64, may_evict))
+        {
+            LOG_DBG("No free space to verify key for ");
+            LOG_DBG_6ADDR(addr);
+            LOG_DBG_(" without evicting a verified key\n");
+        }
+    }
+    else
+    {
+        // Either being verified already, or the certificate needs to be obtained
+        request_public_key(addr);
+    }
+
+    return false;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_remove(public_key_item_t* item)
 {
     // Cannot remove if pinned (is in use)
@@ -303,6 +554,14 @@ bool request_public_key(const uip_ip6addr_t* addr)
         return false;
     }
 
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    // Check if we have the key, but have not yet needed to verify it
+    if (keystore_verify_unverified(eui64, true))
+    {
+        return false;
+    }
+#endif
+
     // Check if we are already requesting a key
     if (timed_unlock_is_locked(&in_use))
     {
@@ -411,6 +670,61 @@ request_public_key_callback(coap_callback_request_state_t* callback_state)
 /*-------------------------------------------------------------------------------------------------------------------*/
 static uint8_t add_buffer[TBS_CERTIFICATE_CBOR_LENGTH + DTLS_EC_SIG_SIZE];
 static bool add_buffer_in_use;
+static uint8_t add_cert_hash[KEYSTORE_SECRET_CACHE_HASH_LEN];
+static bool add_cert_hash_valid;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void generate_shared_secret(public_key_item_t* item, const uint8_t* shared_secret, size_t shared_secret_len);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+keystore_add_from_cache(public_key_item_t* item, size_t cert_len)
+{
+    uint8_t digest[SHA256_DIGEST_LEN_BYTES];
+
+    add_cert_hash_valid = platform_crypto_success(sha256_hash(add_buffer, cert_len, digest));
+    if (!add_cert_hash_valid)
+    {
+        LOG_WARN("keystore_add: failed to hash certificate for ");
+        LOG_WARN_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_WARN_("\n");
+        return false;
+    }
+
+    memcpy(add_cert_hash, digest, KEYSTORE_SECRET_CACHE_HASH_LEN);
+
+    keystore_secret_t* secret = secret_cache_find(item->cert.subject);
+    if (!secret)
+    {
+        return false;
+    }
+
+    // A different certificate for this peer needs to go through full verification
+    if (memcmp(secret->cert_hash, add_cert_hash, KEYSTORE_SECRET_CACHE_HASH_LEN) != 0)
+    {
+        LOG_INFO("Cached shared secret for ");
+        LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_INFO_(" is for a different certificate\n");
+
+        list_remove(secret_cache, secret);
+        memb_free(&secret_cache_memb, secret);
+        return false;
+    }
+
+    // This exact certificate was previously verified, so skip verification and ECDH
+    LOG_INFO("Using cached shared secret for ");
+    LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
+    LOG_INFO_("\n");
+
+    list_remove(public_keys_to_verify, item);
+    list_push(public_keys, item);
+
+    list_remove(secret_cache, secret);
+    list_push(secret_cache, secret);
+
+    generate_shared_secret(item, secret->shared_secret, sizeof(secret->shared_secret));
+    keystore_context_ready(item, true);
+
+    return true;
+}
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
 keystore_add_start(void)
@@ -450,6 +764,13 @@ keystore_add_start(void)
     // Put the signature at the end
     memcpy(&add_buffer[encoded_length], &item->cert.signature, DTLS_EC_SIG_SIZE);
 
+    if (keystore_add_from_cache(item, encoded_length + DTLS_EC_SIG_SIZE))
+    {
+        // Move onto the next certificate to verify
+        process_poll(&keystore_add_verifier);
+        return;
+    }
+
     if (!queue_message_to_verify(&keystore_add_verifier, item,
                                  add_buffer, encoded_length + DTLS_EC_SIG_SIZE,
                                  &root_cert.public_key))
@@ -611,11 +932,23 @@ keystore_init(void)
     crypto_support_init();
 
     memb_init(&public_keys_memb);
+    MEMB_STATS_REGISTER(public_keys_memb);
     list_init(public_keys);
     list_init(public_keys_to_verify);
 
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    memb_init(&unverified_memb);
+    MEMB_STATS_REGISTER(unverified_memb);
+    list_init(public_keys_unverified);
+#endif
+
+    memb_init(&secret_cache_memb);
+    MEMB_STATS_REGISTER(secret_cache_memb);
+    list_init(secret_cache);
+
     timed_unlock_init(&in_use, "keystore", (1 * 60 * CLOCK_SECOND));
     add_buffer_in_use = false;
+    add_cert_hash_valid = false;
 
     // Need to add the root certificate to the keystore in order to
     // generate the shared secret with it
@@ -661,6 +994,12 @@ PROCESS_THREAD(keystore_add_verifier, ev, data)
             // Generated a shared secret if this step succeeded
             if (pkitem)
             {
+                // add_cert_hash may be overwritten while ECDH is performed
+                static uint8_t pkitem_cert_hash[KEYSTORE_SECRET_CACHE_HASH_LEN];
+                static bool pkitem_cert_hash_valid;
+                memcpy(pkitem_cert_hash, add_cert_hash, sizeof(pkitem_cert_hash));
+                pkitem_cert_hash_valid = add_cert_hash_valid;
+
                 keystore_pin(pkitem);
 
                 static ecdh2_state_t ecdh2_unver_state;
@@ -671,6 +1010,13 @@ PROCESS_THREAD(keystore_add_verifier, ev, data)
                 {
                     generate_shared_secret(pkitem,
                         ecdh2_unver_state.shared_secret, sizeof(ecdh2_unver_state.shared_secret));
+
+                    if (pkitem_cert_hash_valid)
+                    {
+                        secret_cache_add(pkitem->cert.subject, pkitem_cert_hash, ecdh2_unver_state.shared_secret);
+                    }
+
+                    keystore_context_ready(pkitem, false);
                 }
                 else
                 {
@@ -1,6 +1,6 @@
 #pragma once
 /*-------------------------------------------------------------------------------------------------------------------*/
-//#include "clock.h"
+#include "clock.h"
 #include "net/ipv6/uip.h"
 
 #ifdef WITH_OSCORE
@@ -13,6 +13,22 @@
 #define PUBLIC_KEYSTORE_SIZE 12
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Number of ECDH shared secrets to remember for peers whose certificates have been evicted
+#ifndef KEYSTORE_SECRET_CACHE_SIZE
+#define KEYSTORE_SECRET_CACHE_SIZE 8
+#endif
+// Number of bytes of the SHA-256 of the certificate used to check a cached secret
+#ifndef KEYSTORE_SECRET_CACHE_HASH_LEN
+#define KEYSTORE_SECRET_CACHE_HASH_LEN 16
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef KEYSTORE_LAZY_VERIFICATION
+// Number of certificates to hold that have been received but not yet verified
+#ifndef KEYSTORE_UNVERIFIED_SIZE
+#define KEYSTORE_UNVERIFIED_SIZE 8
+#endif
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct public_key_item {
     struct public_key_item *next;
 
@@ -22,12 +38,24 @@ typedef struct public_key_item {
     oscore_ctx_t context;
 #endif
 
-    //clock_time_t age;
+#ifdef KEYSTORE_TIME_METRICS
+    // When the certificate was added, to measure time until the OSCORE context is ready
+    clock_time_t added;
+#endif
 
     uint16_t pin_count;
 } public_key_item_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_add(const certificate_t* cert);
+#ifdef KEYSTORE_LAZY_VERIFICATION
+// Store a certificate without verifying it, verification will start
+// when request_public_key is called for the certificate's subject.
+bool keystore_add_unverified(const certificate_t* cert);
+
+// Returns true if the key for addr has been verified. Otherwise starts verifying it, evicting the
+// least recently used key that is not in use (nor the root's) if there is no space and may_evict is set.
+bool keystore_request_verification(const uip_ip6addr_t* addr, bool may_evict);
+#endif
 bool keystore_remove(public_key_item_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
 public_key_item_t* keystore_find(const uint8_t* eui64);
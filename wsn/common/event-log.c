@@ -0,0 +1,113 @@
+#include "event-log.h"
+
+#ifdef EVENT_LOG_ENABLED
+
+#include "base64.h"
+
+#include "contiki.h"
+#include "os/sys/log.h"
+#include "os/lib/assert.h"
+
+#include <stdbool.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "event-log"
+#ifdef EVENT_LOG_LOG_LEVEL
+#define LOG_LEVEL EVENT_LOG_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(EVENT_LOG_TM_UPDATE_MAX_LEN <= EVENT_LOG_BUFFER_SIZE,
+               "EVENT_LOG_BUFFER_SIZE is too small for the trust model's updates");
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define EVENT_LOG_CHECKSUM_LEN 2
+#define EVENT_LOG_FRAME_LEN (EVENT_LOG_BUFFER_SIZE + EVENT_LOG_CHECKSUM_LEN)
+// As required by base64_encode, including the nul terminator
+#define EVENT_LOG_BASE64_LEN ((EVENT_LOG_FRAME_LEN * 4) / 3 + 4 + 1)
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t buffer[EVENT_LOG_FRAME_LEN];
+static char encoded[EVENT_LOG_BASE64_LEN];
+
+static nanocbor_encoder_t enc;
+static bool in_progress;
+
+static uint32_t dropped;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t
+fletcher16(const uint8_t* data, size_t len)
+{
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    for (size_t i = 0; i != len; ++i)
+    {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return (sum2 << 8) | sum1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+event_log_init(void)
+{
+    in_progress = false;
+    dropped = 0;
+
+    nanocbor_encoder_t* start = event_log_begin(EVENT_LOG_START, 1);
+    nanocbor_fmt_uint(start, CLOCK_SECOND);
+    event_log_end(start);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+nanocbor_encoder_t*
+event_log_begin(event_log_id_t id, uint8_t fields)
+{
+    assert(!in_progress);
+    in_progress = true;
+
+    nanocbor_encoder_init(&enc, buffer, EVENT_LOG_BUFFER_SIZE);
+
+    nanocbor_fmt_array(&enc, 2 + fields);
+    nanocbor_fmt_uint(&enc, id);
+    nanocbor_fmt_uint(&enc, (uint32_t)clock_time());
+
+    return &enc;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+event_log_end(nanocbor_encoder_t* e)
+{
+    assert(in_progress && e == &enc);
+    in_progress = false;
+
+    // The encoder keeps counting past the end of the buffer, so this detects truncated events
+    const size_t len = nanocbor_encoded_len(&enc);
+    if (len > EVENT_LOG_BUFFER_SIZE)
+    {
+        LOG_WARN("Dropping event of length %u > %u\n", (unsigned)len, (unsigned)EVENT_LOG_BUFFER_SIZE);
+        dropped += 1;
+        return;
+    }
+
+    const uint16_t checksum = fletcher16(buffer, len);
+    buffer[len + 0] = (checksum >> 8) & 0xff;
+    buffer[len + 1] = (checksum >> 0) & 0xff;
+
+    size_t encoded_len = sizeof(encoded);
+    if (!base64_encode(buffer, len + EVENT_LOG_CHECKSUM_LEN, encoded, &encoded_len))
+    {
+        LOG_ERR("base64_encode failed\n");
+        dropped += 1;
+        return;
+    }
+
+    LOG_PRINT_(EVENT_LOG_PREFIX "%s\n", encoded);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint32_t
+event_log_dropped(void)
+{
+    return dropped;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
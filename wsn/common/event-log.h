@@ -0,0 +1,60 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nanocbor-helper.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Compact binary logging of experiment events, to use instead of formatted text on the serial line.
+// Build with EVENT_LOG_ENABLED=1. Each event is a CBOR array [id, clock ticks, fields...] followed
+// by a Fletcher-16 checksum. It is written as a single line of EVENT_LOG_PREFIX and then the frame
+// base64 encoded, so it can share the serial line and the pyterm logs with the text output.
+// Events are decoded by analysis/parser/event_log.py, which must be kept in sync with event_log_id_t.
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+    // [CLOCK_SECOND], sent once on startup so ticks can be converted to seconds
+    EVENT_LOG_START = 1,
+
+    // [eui64, capability or null, metric, observation, observation, state before, state after]
+    EVENT_LOG_TM_UPDATE = 2,
+
+} event_log_id_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define EVENT_LOG_PREFIX "#Ev|"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef EVENT_LOG_ENABLED
+
+#include "contiki.h"
+#include "eui64.h"
+#include "trust-common.h"
+#include "trust-model.h"
+
+// Largest EVENT_LOG_TM_UPDATE, as written by tm_event_log_begin and the trust model
+#define EVENT_LOG_TM_UPDATE_MAX_LEN ( \
+    (1) + (1) + (1 + sizeof(uint32_t)) + \
+    (1 + EUI64_LENGTH) + (1 + EDGE_CAPABILITY_NAME_LEN) + (1 + sizeof(uint16_t)) + (2 * (1 + sizeof(int32_t))) + \
+    (2 * TM_LOG_STATE_MAX_LEN) \
+)
+
+// Largest CBOR encoding of a single event
+#ifndef EVENT_LOG_BUFFER_SIZE
+#define EVENT_LOG_BUFFER_SIZE EVENT_LOG_TM_UPDATE_MAX_LEN
+#endif
+
+void event_log_init(void);
+
+// Start an event with this many fields after the id and time. The fields must be written
+// with the returned encoder before calling event_log_end. Only one event may be open at once.
+nanocbor_encoder_t* event_log_begin(event_log_id_t id, uint8_t fields);
+void event_log_end(nanocbor_encoder_t* enc);
+
+// Events that did not fit in EVENT_LOG_BUFFER_SIZE
+uint32_t event_log_dropped(void);
+
+#else
+
+#define event_log_init()
+
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,268 @@
+#include "memb-stats.h"
+#include "serial-helpers.h"
+
+#include "os/sys/log.h"
+#include "os/dev/serial-line.h"
+
+#include "coap.h"
+#include "coap-engine.h"
+
+#ifdef WITH_OSCORE
+#include "oscore.h"
+#endif
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor-helper.h"
+
+#include <stdio.h>
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "memb-stats"
+#ifdef MEMB_STATS_LOG_LEVEL
+#define LOG_LEVEL MEMB_STATS_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Longest pool name that will be encoded, longer names are truncated
+#define MEMB_STATS_NAME_MAX 31
+
+// [name, size, num, used, peak, failures, evictions]
+#define MEMB_STATS_ENTRY_CBOR_MAX ((1) + (1 + MEMB_STATS_NAME_MAX) + (6 * (1 + 2)))
+/*-------------------------------------------------------------------------------------------------------------------*/
+static memb_stats_t pools[MEMB_STATS_MAX_POOLS];
+static uint8_t pools_len;
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS(memb_stats_process, "memb_stats_process");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static memb_stats_t*
+memb_stats_find(const struct memb* m)
+{
+    for (uint8_t i = 0; i != pools_len; ++i)
+    {
+        if (pools[i].m == m)
+        {
+            return &pools[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_stats_register(struct memb* m, const char* name)
+{
+    if (memb_stats_find(m) != NULL)
+    {
+        return;
+    }
+
+    if (pools_len == MEMB_STATS_MAX_POOLS)
+    {
+        LOG_WARN("No space to register pool %s\n", name);
+        return;
+    }
+
+    memb_stats_t* s = &pools[pools_len++];
+    s->m = m;
+    s->name = name;
+    s->peak = 0;
+    s->failures = 0;
+    s->evictions = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t
+memb_stats_used(const memb_stats_t* s)
+{
+    return s->m->num - memb_numfree(s->m);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+memb_stats_alloc(struct memb* m)
+{
+    void* item = memb_alloc(m);
+
+    memb_stats_t* s = memb_stats_find(m);
+    if (s == NULL)
+    {
+        return item;
+    }
+
+    if (item == NULL)
+    {
+        s->failures += 1;
+    }
+    else
+    {
+        const uint16_t used = memb_stats_used(s);
+        if (used > s->peak)
+        {
+            s->peak = used;
+        }
+    }
+
+    return item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_stats_evicted(struct memb* m)
+{
+    memb_stats_t* s = memb_stats_find(m);
+    if (s != NULL)
+    {
+        s->evictions += 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const memb_stats_t*
+memb_stats_iter(void)
+{
+    return pools_len == 0 ? NULL : &pools[0];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const memb_stats_t*
+memb_stats_next(const memb_stats_t* s)
+{
+    return (s + 1 == &pools[pools_len]) ? NULL : s + 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_stats_print(void)
+{
+    // Format: memb-stats|name|size|num|used|peak|failures|evictions
+    for (const memb_stats_t* s = memb_stats_iter(); s != NULL; s = memb_stats_next(s))
+    {
+        printf(MEMB_STATS_SERIAL_PREFIX "|%s|%u|%u|%u|%u|%u|%u\n",
+            s->name, s->m->size, s->m->num, memb_stats_used(s), s->peak, s->failures, s->evictions);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int
+memb_stats_encode_entry(const memb_stats_t* s, uint8_t* buffer, size_t buffer_len)
+{
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buffer, buffer_len);
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 7));
+    NANOCBOR_CHECK(nanocbor_put_tstrn(&enc, s->name, strnlen(s->name, MEMB_STATS_NAME_MAX)));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, s->m->size));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, s->m->num));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, memb_stats_used(s)));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, s->peak));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, s->failures));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, s->evictions));
+
+    return nanocbor_encoded_len(&enc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Copy the part of data (which starts at *pos in the encoded stream) that falls in the requested block
+static void
+copy_to_block(const uint8_t* data, size_t len, size_t* pos,
+              int32_t offset, uint8_t* block, uint16_t block_size, uint16_t* block_len)
+{
+    const size_t block_start = (size_t)offset;
+    const size_t block_end = block_start + block_size;
+
+    const size_t start = (*pos > block_start) ? *pos : block_start;
+    const size_t end = (*pos + len < block_end) ? *pos + len : block_end;
+
+    if (start < end)
+    {
+        memcpy(block + (start - block_start), data + (start - *pos), end - start);
+
+        if (end - block_start > *block_len)
+        {
+            *block_len = end - block_start;
+        }
+    }
+
+    *pos += len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+res_mem_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_mem,
+         "title=\"Memory pool statistics\";rt=\"stats\"",
+         res_mem_get_handler,   /*GET*/
+         NULL,                  /*POST*/
+         NULL,                  /*PUT*/
+         NULL                   /*DELETE*/);
+
+static void
+res_mem_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+    // The statistics do not fit in a single message, so to avoid a large buffer they are
+    // encoded one pool at a time and only the bytes in the requested block2 block are kept.
+    uint8_t entry[MEMB_STATS_ENTRY_CBOR_MAX];
+    size_t pos = 0;
+    uint16_t block_len = 0;
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, entry, sizeof(entry));
+    nanocbor_fmt_array(&enc, pools_len);
+    copy_to_block(entry, nanocbor_encoded_len(&enc), &pos, *offset, buffer, preferred_size, &block_len);
+
+    for (const memb_stats_t* s = memb_stats_iter(); s != NULL; s = memb_stats_next(s))
+    {
+        const int len = memb_stats_encode_entry(s, entry, sizeof(entry));
+        if (len < 0)
+        {
+            LOG_ERR("Failed to encode statistics for %s\n", s->name);
+            coap_set_status_code(response, INTERNAL_SERVER_ERROR_5_00);
+            return;
+        }
+
+        copy_to_block(entry, len, &pos, *offset, buffer, preferred_size, &block_len);
+    }
+
+    if ((size_t)*offset >= pos)
+    {
+        coap_set_status_code(response, BAD_OPTION_4_02);
+        return;
+    }
+
+    coap_set_header_content_format(response, APPLICATION_CBOR);
+    coap_set_payload(response, buffer, block_len);
+
+    *offset += block_len;
+    if ((size_t)*offset >= pos)
+    {
+        *offset = -1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_stats_init(void)
+{
+    coap_activate_resource(&res_mem, MEMB_STATS_URI);
+
+#ifdef WITH_OSCORE
+    oscore_protect_resource(&res_mem);
+#endif
+
+    process_start(&memb_stats_process, NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(memb_stats_process, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while (1)
+    {
+        PROCESS_YIELD();
+
+        if (ev == serial_line_event_message)
+        {
+            const char* line = (const char*)data;
+
+            if (match_action(line, line + strlen(line), MEMB_STATS_SERIAL_COMMAND))
+            {
+                memb_stats_print();
+            }
+        }
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,56 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "contiki.h"
+#include "os/lib/memb.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Usage of the fixed MEMB pools, so they can be sized from data rather than by guesswork.
+// Pools are registered when they are initialised and allocate through memb_stats_alloc.
+// The statistics are served as CBOR from MEMB_STATS_URI and printed to serial when
+// MEMB_STATS_SERIAL_COMMAND is received.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef MEMB_STATS_MAX_POOLS
+#define MEMB_STATS_MAX_POOLS 16
+#endif
+
+#define MEMB_STATS_URI "stats/mem"
+#define MEMB_STATS_SERIAL_COMMAND "memstats"
+#define MEMB_STATS_SERIAL_PREFIX "memb-stats"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct memb_stats
+{
+    struct memb* m;
+    const char* name;
+
+    uint16_t peak;
+
+    // Allocations that failed because the pool was full
+    uint16_t failures;
+
+    // Items removed to make room for others
+    uint16_t evictions;
+
+} memb_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void memb_stats_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Registering the same pool more than once keeps its statistics
+void memb_stats_register(struct memb* m, const char* name);
+
+#define MEMB_STATS_REGISTER(name) memb_stats_register(&name, #name)
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Equivalent to memb_alloc
+void* memb_stats_alloc(struct memb* m);
+
+// Record that an item was freed to make space for another
+void memb_stats_evicted(struct memb* m);
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t memb_stats_used(const memb_stats_t* s);
+
+const memb_stats_t* memb_stats_iter(void);
+const memb_stats_t* memb_stats_next(const memb_stats_t* s);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void memb_stats_print(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
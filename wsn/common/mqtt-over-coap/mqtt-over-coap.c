@@ -14,7 +14,9 @@
 #include "crypto-support.h"
 #include "keystore-oscore.h"
 #include "timed-unlock.h"
+#include "timer-wheel.h"
 #include "root-endpoint.h"
+#include "prof.h"
 
 #include <string.h>
 #include <strings.h>
@@ -59,11 +61,9 @@ static process_event_t pe_state_machine;
 #define ECHO_REQ_PAYLOAD_LEN        20
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define MAX_QUERY_LEN               128
-#define MAX_COAP_PAYLOAD            COAP_MAX_CHUNK_SIZE
 /*-------------------------------------------------------------------------------------------------------------------*/
 static coap_message_t msg;
 static char uri_query[MAX_QUERY_LEN];
-static uint8_t coap_payload[MAX_COAP_PAYLOAD];
 static coap_callback_request_state_t coap_callback;
 static timed_unlock_t coap_callback_in_use;
 static uint16_t coap_callback_i;
@@ -72,7 +72,7 @@ static struct etimer publish_periodic_timer;
 /*-------------------------------------------------------------------------------------------------------------------*/
 /* Parent RSSI functionality */
 static struct uip_icmp6_echo_reply_notification echo_reply_notification;
-static struct etimer echo_request_timer;
+static wheel_timer_t echo_request_timer;
 /*-------------------------------------------------------------------------------------------------------------------*/
 PROCESS(mqtt_client_process, "MQTT Client");
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -91,7 +91,7 @@ echo_reply_handler(uip_ipaddr_t *source, uint8_t ttl, uint8_t *data, uint16_t da
         process_post(&mqtt_client_process, pe_state_machine, NULL);
 
         // No need to keep pinging
-        etimer_stop(&echo_request_timer);
+        wheel_timer_stop(&echo_request_timer);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -138,6 +138,15 @@ mqtt_over_coap_publish(const char* topic, const void* data, size_t data_len)
     coap_set_header_uri_path(&msg, MQTT_URI_PATH);
     coap_set_header_uri_query(&msg, uri_query);
 
+    // Only needed until the publish finishes, when unlocking frees it
+    uint8_t* coap_payload = timed_unlock_scratch_alloc(&coap_callback_in_use, data_len);
+    if (coap_payload == NULL)
+    {
+        LOG_ERR("Failed to allocate %zu bytes for the publish payload\n", data_len);
+        timed_unlock_unlock(&coap_callback_in_use);
+        return false;
+    }
+
     memcpy(coap_payload, data, data_len);
 
     coap_set_header_content_format(&msg, APPLICATION_CBOR);
@@ -355,7 +364,9 @@ res_coap_mqtt_post_handler(coap_message_t *request, coap_message_t *response, ui
     LOG_DBG("Received publish topic=%.*s, payload len=%d\n", topic_len, topic, payload_len);
 
     // Forward the publish back up to the clients
+    PROF_BEGIN(MQTT_PUBLISH_HANDLER);
     mqtt_publish_handler(topic, topic + topic_len, payload, payload_len);
+    PROF_END(MQTT_PUBLISH_HANDLER);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
@@ -370,7 +381,7 @@ ping_parent(void)
     } else {
         LOG_WARN("ping_parent() is called while we don't have connectivity\n");
     }
-    etimer_set(&echo_request_timer, DEFAULT_PING_INTERVAL);
+    wheel_timer_set_event(&echo_request_timer, DEFAULT_PING_INTERVAL);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
@@ -405,7 +416,7 @@ init(void)
     timed_unlock_init(&coap_callback_in_use, "mqtt-over-coap", (1 * 60 * CLOCK_SECOND));
 
     uip_icmp6_echo_reply_callback_add(&echo_reply_notification, echo_reply_handler);
-    etimer_set(&echo_request_timer, DEFAULT_PING_INTERVAL);
+    wheel_timer_set_event(&echo_request_timer, DEFAULT_PING_INTERVAL);
 
     coap_activate_resource(&res_coap_mqtt, MQTT_URI_PATH);
 
@@ -0,0 +1,160 @@
+#include "prof.h"
+
+#ifdef PROF_ENABLED
+
+#include "base64.h"
+#include "serial-helpers.h"
+
+#include "os/sys/log.h"
+#include "os/dev/serial-line.h"
+
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "prof"
+#ifdef PROF_LOG_LEVEL
+#define LOG_LEVEL PROF_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Each sample is encoded as a little endian (uint8_t id, uint32_t start, uint32_t duration)
+#define PROF_SAMPLE_LEN (1 + 4 + 4)
+
+// Samples per line of the dump
+#define PROF_DUMP_SAMPLES 8
+#define PROF_DUMP_LEN (PROF_DUMP_SAMPLES * PROF_SAMPLE_LEN)
+// As required by base64_encode, including the nul terminator
+#define PROF_DUMP_BASE64_LEN ((PROF_DUMP_LEN * 4) / 3 + 4 + 1)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct prof_sample
+{
+    rtimer_clock_t start;
+    rtimer_clock_t duration;
+    uint8_t id;
+} prof_sample_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static prof_sample_t ring[PROF_RING_SIZE];
+static uint16_t ring_head;
+static uint16_t ring_len;
+
+// Samples overwritten before they could be dumped
+static uint32_t dropped;
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS(prof_process, "prof_process");
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+prof_init(void)
+{
+    ring_head = 0;
+    ring_len = 0;
+    dropped = 0;
+
+    process_start(&prof_process, NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+prof_record(prof_id_t id, rtimer_clock_t start)
+{
+    const rtimer_clock_t now = RTIMER_NOW();
+
+    prof_sample_t* sample = &ring[(ring_head + ring_len) % PROF_RING_SIZE];
+
+    if (ring_len == PROF_RING_SIZE)
+    {
+        // Overwrite the oldest sample
+        ring_head = (ring_head + 1) % PROF_RING_SIZE;
+        dropped += 1;
+    }
+    else
+    {
+        ring_len += 1;
+
+        // Dump soon, so samples are not lost
+        if (ring_len == PROF_RING_SIZE)
+        {
+            process_poll(&prof_process);
+        }
+    }
+
+    sample->id = id;
+    sample->start = start;
+    sample->duration = now - start;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t*
+put_u32(uint8_t* out, uint32_t value)
+{
+    out[0] = (value >> 0) & 0xff;
+    out[1] = (value >> 8) & 0xff;
+    out[2] = (value >> 16) & 0xff;
+    out[3] = (value >> 24) & 0xff;
+    return out + 4;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+prof_dump(void)
+{
+    uint8_t buffer[PROF_DUMP_LEN];
+    char encoded[PROF_DUMP_BASE64_LEN];
+
+    LOG_INFO("dump begin %lu %u %" PRIu32 "\n", (unsigned long)RTIMER_SECOND, ring_len, dropped);
+
+    while (ring_len > 0)
+    {
+        uint8_t* out = buffer;
+
+        for (uint8_t i = 0; i != PROF_DUMP_SAMPLES && ring_len > 0; ++i)
+        {
+            const prof_sample_t* sample = &ring[ring_head];
+
+            *out++ = sample->id;
+            out = put_u32(out, sample->start);
+            out = put_u32(out, sample->duration);
+
+            ring_head = (ring_head + 1) % PROF_RING_SIZE;
+            ring_len -= 1;
+        }
+
+        size_t encoded_len = sizeof(encoded);
+        if (!base64_encode(buffer, out - buffer, encoded, &encoded_len))
+        {
+            LOG_ERR("base64_encode failed\n");
+            continue;
+        }
+
+        LOG_INFO("dump %s\n", encoded);
+    }
+
+    LOG_INFO("dump end\n");
+
+    dropped = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(prof_process, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while (1)
+    {
+        PROCESS_YIELD();
+
+        if (ev == PROCESS_EVENT_POLL)
+        {
+            prof_dump();
+        }
+
+        if (ev == serial_line_event_message)
+        {
+            const char* line = (const char*)data;
+
+            if (match_action(line, line + strlen(line), PROF_SERIAL_COMMAND))
+            {
+                prof_dump();
+            }
+        }
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif /* PROF_ENABLED */
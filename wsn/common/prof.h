@@ -0,0 +1,61 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "contiki.h"
+#include "os/sys/rtimer.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Lightweight profiling of hot paths. Build with PROF_ENABLED=1 to record (id, start, duration)
+// samples in rtimer ticks into a RAM ring buffer, which is dumped over serial (base64 encoded) when
+// it fills up or when PROF_SERIAL_COMMAND is received. When disabled the macros compile to nothing.
+// Samples are decoded by analysis/parser/prof_pyterm.py, which must be kept in sync with prof_id_t.
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+    PROF_ID_CHOOSE_EDGE = 1,
+    PROF_ID_CALCULATE_TRUST_VALUE = 2,
+    PROF_ID_SERIALISE_TRUST = 3,
+    PROF_ID_PROCESS_RECEIVED_TRUST = 4,
+    PROF_ID_CERTIFICATE_DECODE = 5,
+    PROF_ID_MQTT_PUBLISH_HANDLER = 6,
+
+    // Time spent waiting in the crypto queues, then performing the operation
+    PROF_ID_SIGN_QUEUE = 7,
+    PROF_ID_SIGN = 8,
+    PROF_ID_VERIFY_QUEUE = 9,
+    PROF_ID_VERIFY = 10,
+
+} prof_id_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PROF_SERIAL_COMMAND "profdump"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef PROF_ENABLED
+
+#ifndef PROF_RING_SIZE
+#define PROF_RING_SIZE 64
+#endif
+
+void prof_init(void);
+void prof_record(prof_id_t id, rtimer_clock_t start);
+void prof_dump(void);
+
+#define PROF_BEGIN(id) const rtimer_clock_t prof_start_##id = RTIMER_NOW()
+#define PROF_END(id) prof_record(PROF_ID_##id, prof_start_##id)
+
+// For spans that cross function calls or protothread yields, the start is kept in a variable
+#define PROF_STAMP(var) ((var) = RTIMER_NOW())
+#define PROF_SINCE(id, var) prof_record(PROF_ID_##id, (var))
+
+#else
+
+#define prof_init()
+#define prof_dump()
+
+#define PROF_BEGIN(id)
+#define PROF_END(id)
+
+#define PROF_STAMP(var)
+#define PROF_SINCE(id, var)
+
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
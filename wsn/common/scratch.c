@@ -0,0 +1,109 @@
+#include "scratch.h"
+
+#include <string.h>
+
+#include "os/sys/log.h"
+#include "os/lib/assert.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "scratch"
+#ifdef SCRATCH_LOG_LEVEL
+#define LOG_LEVEL SCRATCH_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint16_t start;
+    uint16_t end;
+} scratch_block_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t scratch_arena[SCRATCH_SIZE] __attribute__((aligned(sizeof(uint32_t))));
+
+// Live allocations, ordered by where they start in the arena
+static scratch_block_t blocks[SCRATCH_MAX_LIVE];
+static uint8_t live;
+
+static uint16_t peak;
+static uint16_t failures;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+scratch_alloc(uint16_t size)
+{
+    uint32_t start = 0;
+    uint8_t i = 0;
+
+    if (live != SCRATCH_MAX_LIVE)
+    {
+        // First fit, the gaps are before each live allocation and after the last one
+        for (i = 0; i != live; ++i)
+        {
+            if (SCRATCH_ALIGN(start) + size <= blocks[i].start)
+            {
+                break;
+            }
+
+            start = blocks[i].end;
+        }
+
+        start = SCRATCH_ALIGN(start);
+    }
+
+    if (live == SCRATCH_MAX_LIVE || start + size > SCRATCH_SIZE)
+    {
+        failures += 1;
+        LOG_WARN("Failed to allocate %" PRIu16 " bytes (live=%" PRIu8 " size=%u)\n",
+            size, live, SCRATCH_SIZE);
+        return NULL;
+    }
+
+    memmove(&blocks[i + 1], &blocks[i], (live - i) * sizeof(*blocks));
+    blocks[i].start = start;
+    blocks[i].end = start + size;
+    live += 1;
+
+    if (blocks[live - 1].end > peak)
+    {
+        peak = blocks[live - 1].end;
+    }
+
+    return &scratch_arena[start];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+scratch_free(void* ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    assert((uint8_t*)ptr >= scratch_arena && (uint8_t*)ptr < scratch_arena + SCRATCH_SIZE);
+
+    const uint16_t start = (uint8_t*)ptr - scratch_arena;
+
+    for (uint8_t i = 0; i != live; ++i)
+    {
+        if (blocks[i].start == start)
+        {
+            live -= 1;
+            memmove(&blocks[i], &blocks[i + 1], (live - i) * sizeof(*blocks));
+            return;
+        }
+    }
+
+    LOG_ERR("Freeing %p which is not a live allocation\n", ptr);
+    assert(false);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t
+scratch_peak(void)
+{
+    return peak;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t
+scratch_failures(void)
+{
+    return failures;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,37 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A shared arena for transient buffers (e.g., CoAP payloads that only need to exist while a
+// request is in flight), instead of each subsystem owning a static buffer that is rarely used.
+// Allocations are placed in the first gap between live allocations that they fit in, so space
+// freed by one user can be reused whatever order the allocations are freed in.
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Allocations are word aligned, so they can hold any structure
+#define SCRATCH_ALIGN(x) (((x) + (sizeof(uint32_t) - 1)) & ~(sizeof(uint32_t) - 1))
+
+// Must be at least the sum of SCRATCH_ALIGN(size) of every buffer that can be live at once,
+// see applications.c for the buffers of the node applications
+#ifndef SCRATCH_SIZE
+#define SCRATCH_SIZE 64
+#endif
+
+// The most allocations that can be live at once
+#ifndef SCRATCH_MAX_LIVE
+#define SCRATCH_MAX_LIVE 4
+#endif
+
+_Static_assert(SCRATCH_SIZE <= UINT16_MAX, "SCRATCH_SIZE must fit in a uint16_t");
+_Static_assert(SCRATCH_MAX_LIVE <= UINT8_MAX, "SCRATCH_MAX_LIVE must fit in a uint8_t");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns NULL if there is not enough space left in the arena
+void* scratch_alloc(uint16_t size);
+
+void scratch_free(void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t scratch_peak(void);
+uint16_t scratch_failures(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,4 +1,5 @@
 #include "timed-unlock.h"
+#include "scratch.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "timed-lock"
@@ -28,6 +29,7 @@ void timed_unlock_init(timed_unlock_t* l, const char* name, clock_time_t duratio
     l->name = name;
     l->duration = duration;
     l->p = PROCESS_CURRENT();
+    l->scratch = NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool timed_unlock_is_locked(const timed_unlock_t* l)
@@ -38,17 +40,40 @@ bool timed_unlock_is_locked(const timed_unlock_t* l)
 void timed_unlock_lock(timed_unlock_t* l)
 {
     l->locked = true;
-    ctimer_set(&l->timer, l->duration, timed_unlock_callack, l);
+    wheel_timer_set(&l->timer, l->duration, timed_unlock_callack, l);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void timed_unlock_unlock(timed_unlock_t* l)
 {
     l->locked = false;
-    ctimer_stop(&l->timer);
+    wheel_timer_stop(&l->timer);
+    timed_unlock_scratch_free(l);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void timed_unlock_restart_timer(timed_unlock_t* l)
 {
-    ctimer_restart(&l->timer);
+    wheel_timer_restart(&l->timer);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void timed_unlock_set_duration(timed_unlock_t* l, clock_time_t duration)
+{
+    // Takes effect the next time the lock is locked
+    l->duration = duration;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* timed_unlock_scratch_alloc(timed_unlock_t* l, uint16_t size)
+{
+    // Only one buffer per lock
+    timed_unlock_scratch_free(l);
+
+    l->scratch = scratch_alloc(size);
+
+    return l->scratch;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void timed_unlock_scratch_free(timed_unlock_t* l)
+{
+    scratch_free(l->scratch);
+    l->scratch = NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
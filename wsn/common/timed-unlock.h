@@ -1,15 +1,17 @@
 #pragma once
 /*-------------------------------------------------------------------------------------------------------------------*/
 #include <stdbool.h>
-#include "ctimer.h"
+#include <stdint.h>
+#include "timer-wheel.h"
 #include "process.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
     bool locked;
     const char* name;
-    struct ctimer timer;
+    wheel_timer_t timer;
     clock_time_t duration;
     struct process* p;
+    void* scratch;
 } timed_unlock_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 void timed_unlock_global_init(void);
@@ -19,6 +21,14 @@ bool timed_unlock_is_locked(const timed_unlock_t* l);
 void timed_unlock_lock(timed_unlock_t* l);
 void timed_unlock_unlock(timed_unlock_t* l);
 void timed_unlock_restart_timer(timed_unlock_t* l);
+void timed_unlock_set_duration(timed_unlock_t* l, clock_time_t duration);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A transient buffer from the scratch arena that is freed when the lock is unlocked,
+// so it lives as long as the request the lock protects. Returns NULL if the arena is full.
+void* timed_unlock_scratch_alloc(timed_unlock_t* l, uint16_t size);
+
+// Free the buffer early, e.g., when the request could not be sent
+void timed_unlock_scratch_free(timed_unlock_t* l);
 /*-------------------------------------------------------------------------------------------------------------------*/
 extern process_event_t pe_timed_unlock_unlocked;
 /*-------------------------------------------------------------------------------------------------------------------*/
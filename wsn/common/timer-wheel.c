@@ -0,0 +1,282 @@
+#include "timer-wheel.h"
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "timer-wheel"
+#ifdef TIMER_WHEEL_LOG_LEVEL
+#define LOG_LEVEL TIMER_WHEEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+/*-------------------------------------------------------------------------------------------------------------------*/
+static wheel_timer_t* slots[TIMER_WHEEL_SLOTS];
+static uint8_t cursor;
+
+// When the slot at the cursor was processed
+static clock_time_t last_tick;
+
+static uint16_t active_count;
+
+static struct etimer tick_timer;
+static bool tick_scheduled;
+static clock_time_t next_wakeup;
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS(timer_wheel_process, "timer_wheel_process");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Wake up for the next slot that has timers in it, or not at all if there are none
+static void
+schedule(void)
+{
+    if (active_count == 0)
+    {
+        if (tick_scheduled)
+        {
+            etimer_stop(&tick_timer);
+            tick_scheduled = false;
+        }
+        return;
+    }
+
+    uint16_t distance;
+    for (distance = 1; distance <= TIMER_WHEEL_SLOTS; ++distance)
+    {
+        if (slots[(cursor + distance) & TIMER_WHEEL_MASK] != NULL)
+        {
+            break;
+        }
+    }
+
+    const clock_time_t wakeup = last_tick + (distance * TIMER_WHEEL_TICK);
+
+    if (tick_scheduled && wakeup == next_wakeup)
+    {
+        return;
+    }
+
+    const clock_time_t now = clock_time();
+    const clock_time_t delay = (clock_time_t)(wakeup - now) <= (distance * TIMER_WHEEL_TICK) ? wakeup - now : 0;
+
+    PROCESS_CONTEXT_BEGIN(&timer_wheel_process);
+    etimer_set(&tick_timer, delay);
+    PROCESS_CONTEXT_END(&timer_wheel_process);
+
+    tick_scheduled = true;
+    next_wakeup = wakeup;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+wheel_remove(wheel_timer_t* t)
+{
+    for (wheel_timer_t** iter = &slots[t->slot]; *iter != NULL; iter = &(*iter)->next)
+    {
+        if (*iter == t)
+        {
+            *iter = t->next;
+            break;
+        }
+    }
+
+    t->active = false;
+    active_count -= 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+wheel_insert(wheel_timer_t* t)
+{
+    if (t->active)
+    {
+        wheel_remove(t);
+    }
+
+    // An idle wheel has not been ticking, so start counting from now
+    if (active_count == 0)
+    {
+        last_tick = clock_time();
+    }
+
+    // Ticks are counted from the last tick, so round up to never expire early
+    const clock_time_t elapsed = clock_time() - last_tick;
+    clock_time_t ticks = (elapsed + t->interval + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK;
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    t->slot = (cursor + ticks) & TIMER_WHEEL_MASK;
+    t->rounds = (ticks - 1) / TIMER_WHEEL_SLOTS;
+    t->active = true;
+
+    t->next = slots[t->slot];
+    slots[t->slot] = t;
+
+    active_count += 1;
+
+    schedule();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+wheel_timer_fire(wheel_timer_t* t)
+{
+    if (t->f != NULL)
+    {
+        PROCESS_CONTEXT_BEGIN(t->p);
+        t->f(t->ptr);
+        PROCESS_CONTEXT_END(t->p);
+    }
+    else
+    {
+        if (process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_FULL)
+        {
+            // Like etimer, keep the timer pending and try again on the next tick,
+            // otherwise timers that are set again from their own event would stop.
+            LOG_WARN("Event queue full, retrying timer event to %s next tick\n", PROCESS_NAME_STRING(t->p));
+
+            t->slot = (cursor + 1) & TIMER_WHEEL_MASK;
+            t->rounds = 0;
+            t->active = true;
+
+            t->next = slots[t->slot];
+            slots[t->slot] = t;
+
+            active_count += 1;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+process_slot(uint8_t slot)
+{
+    wheel_timer_t* expired = NULL;
+
+    // Take expired timers out of the slot first, as their callbacks may set timers
+    wheel_timer_t** iter = &slots[slot];
+    while (*iter != NULL)
+    {
+        wheel_timer_t* t = *iter;
+
+        if (t->rounds > 0)
+        {
+            t->rounds -= 1;
+            iter = &t->next;
+        }
+        else
+        {
+            *iter = t->next;
+
+            t->active = false;
+            active_count -= 1;
+
+            t->next = expired;
+            expired = t;
+        }
+    }
+
+    while (expired != NULL)
+    {
+        wheel_timer_t* t = expired;
+        expired = t->next;
+
+        wheel_timer_fire(t);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+tick(void)
+{
+    tick_scheduled = false;
+
+    const clock_time_t now = clock_time();
+
+    // Catch up with every slot that has passed, the empty ones are cheap
+    while ((clock_time_t)(now - last_tick) >= TIMER_WHEEL_TICK)
+    {
+        last_tick += TIMER_WHEEL_TICK;
+        cursor = (cursor + 1) & TIMER_WHEEL_MASK;
+
+        if (slots[cursor] != NULL)
+        {
+            process_slot(cursor);
+        }
+    }
+
+    schedule();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+timer_wheel_init(void)
+{
+    for (uint8_t i = 0; i != TIMER_WHEEL_SLOTS; ++i)
+    {
+        slots[i] = NULL;
+    }
+
+    cursor = 0;
+    active_count = 0;
+    tick_scheduled = false;
+    last_tick = clock_time();
+
+    process_start(&timer_wheel_process, NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+wheel_timer_set(wheel_timer_t* t, clock_time_t interval, void (*f)(void*), void* ptr)
+{
+    if (t->active)
+    {
+        wheel_remove(t);
+    }
+
+    t->f = f;
+    t->ptr = ptr;
+    t->p = PROCESS_CURRENT();
+    t->interval = interval;
+
+    wheel_insert(t);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+wheel_timer_set_event(wheel_timer_t* t, clock_time_t interval)
+{
+    wheel_timer_set(t, interval, NULL, NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+wheel_timer_restart(wheel_timer_t* t)
+{
+    wheel_insert(t);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+wheel_timer_stop(wheel_timer_t* t)
+{
+    if (t->active)
+    {
+        wheel_remove(t);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+wheel_timer_expired(const wheel_timer_t* t)
+{
+    return !t->active;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(timer_wheel_process, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while (1)
+    {
+        PROCESS_YIELD();
+
+        if (ev == PROCESS_EVENT_TIMER && data == &tick_timer)
+        {
+            tick();
+        }
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,56 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A hashed timer wheel for the coarse timers of the trust and application layers.
+// Timers expire on a shared tick, so many timers cost one etimer and wakeups only
+// happen for slots that contain timers. Timers may expire up to one tick late.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TIMER_WHEEL_TICK
+#define TIMER_WHEEL_TICK (CLOCK_SECOND)
+#endif
+
+// Must be a power of two
+#ifndef TIMER_WHEEL_SLOTS
+#define TIMER_WHEEL_SLOTS 32
+#endif
+
+_Static_assert((TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS - 1)) == 0, "TIMER_WHEEL_SLOTS must be a power of two");
+_Static_assert(TIMER_WHEEL_SLOTS <= UINT8_MAX, "TIMER_WHEEL_SLOTS must fit in a slot index");
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct wheel_timer
+{
+    struct wheel_timer* next;
+
+    // Called in the context of p on expiry, if NULL then p is posted PROCESS_EVENT_TIMER with this timer
+    void (*f)(void*);
+    void* ptr;
+    struct process* p;
+
+    clock_time_t interval;
+
+    // Full turns of the wheel left before expiring
+    uint16_t rounds;
+    uint8_t slot;
+    bool active;
+
+} wheel_timer_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void timer_wheel_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Equivalent to ctimer_set
+void wheel_timer_set(wheel_timer_t* t, clock_time_t interval, void (*f)(void*), void* ptr);
+
+// Equivalent to etimer_set, the current process receives PROCESS_EVENT_TIMER with data == t
+void wheel_timer_set_event(wheel_timer_t* t, clock_time_t interval);
+
+// Set the timer again with the same interval, starting from now
+void wheel_timer_restart(wheel_timer_t* t);
+
+void wheel_timer_stop(wheel_timer_t* t);
+
+bool wheel_timer_expired(const wheel_timer_t* t);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -17,6 +17,9 @@ edge_resource_t* choose_edge(const char* capability_name)
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
     uint8_t candidates_len = 0;
 
+    // A good edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
     //LOG_DBG("Choosing an edge to submit task for %s\n", capability_name);
 
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
@@ -25,30 +28,22 @@ edge_resource_t* choose_edge(const char* capability_name)
         //edge_resource_tm_print(&iter->tm);
         //LOG_DBG_("\n");
 
-        // Skip inactive edges
-        if (!edge_info_is_active(iter))
-        {
-            continue;
-        }
-
-        // Make sure the edge has the desired capability
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
         if (capability == NULL)
         {
-            //LOG_DBG("Excluding edge %s because it lacks the capability\n", edge_info_name(iter));
             continue;
         }
 
-        // Skip inactive capabilities
-        if (!edge_capability_is_active(capability))
+        // Can't use this node if it is bad
+        if (!edge_is_good(iter))
         {
+            //LOG_DBG("Excluding edge %s because it is bad\n", edge_info_name(iter));
             continue;
         }
 
-        // Can't use this node if it is bad
-        if (!edge_is_good(iter))
+        if (!choose_is_verified(iter, 0.0f, &unverified))
         {
-            //LOG_DBG("Excluding edge %s because it is bad\n", edge_info_name(iter));
             continue;
         }
 
@@ -64,6 +59,9 @@ edge_resource_t* choose_edge(const char* capability_name)
 
     //LOG_DBG("There are %u candidates\n", candidates_len);
 
+    // Every good edge is equally preferred, so only evict another key when no good edge is verified
+    choose_request_verification(&unverified, candidates_len == 0);
+
     if (candidates_len == 0)
     {
         return NULL;
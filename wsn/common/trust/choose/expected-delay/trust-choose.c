@@ -0,0 +1,92 @@
+#include "trust-choose.h"
+#include "trust-model.h"
+#include "edge-info.h"
+#include "prof.h"
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "trust-jsed"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Service time to assume for an edge that has not yet reported how long its tasks take.
+// This is optimistic so that edges without stats get tried.
+#ifndef TRUST_CHOOSE_EXPECTED_DELAY_DEFAULT_MS
+#define TRUST_CHOOSE_EXPECTED_DELAY_DEFAULT_MS 250
+#endif
+
+// Trust values below this are raised to it, so the expected delay remains finite
+#ifndef TRUST_CHOOSE_EXPECTED_DELAY_MIN_TRUST
+#define TRUST_CHOOSE_EXPECTED_DELAY_MIN_TRUST 0.05f
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Expected time until a new task submitted to this edge completes.
+// Each task already queued at the edge and the new task are assumed to take the mean reported service time.
+static float
+expected_delay_ms(const edge_resource_t* edge, const edge_capability_t* capability)
+{
+    const float service_ms = capability->load.has_stats
+        ? (float)capability->load.mean
+        : (float)TRUST_CHOOSE_EXPECTED_DELAY_DEFAULT_MS;
+
+    const float rtt_ms = ((float)edge_info_srtt(edge) * 1000.0f) / CLOCK_SECOND;
+
+    return (edge_capability_queued(capability) + 1) * service_ms + rtt_ms;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Trust-weighted join-the-shortest-expected-delay.
+// Pick the edge that minimises the expected completion time divided by the trust value,
+// so a less trusted edge has to be proportionally faster to be chosen.
+edge_resource_t* choose_edge(const char* capability_name)
+{
+    edge_resource_t* best_edge = NULL;
+    float best_score = 0.0f;
+
+    // The edge with the lowest score that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
+    for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
+    {
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
+        if (capability == NULL)
+        {
+            continue;
+        }
+
+        PROF_BEGIN(CALCULATE_TRUST_VALUE);
+        float trust_value = calculate_trust_value(iter, capability);
+        PROF_END(CALCULATE_TRUST_VALUE);
+        if (trust_value < TRUST_CHOOSE_EXPECTED_DELAY_MIN_TRUST)
+        {
+            trust_value = TRUST_CHOOSE_EXPECTED_DELAY_MIN_TRUST;
+        }
+
+        const float delay = expected_delay_ms(iter, capability);
+        const float score = delay / trust_value;
+
+        LOG_INFO("Edge %s and capability %s trust=%f in_flight=%u queue_depth=%u expected_delay=%fms score=%f\n",
+            edge_info_name(iter), capability_name, trust_value,
+            capability->load.in_flight, capability->load.queue_depth, delay, score);
+
+        // Lower scores are preferred
+        if (!choose_is_verified(iter, -score, &unverified))
+        {
+            continue;
+        }
+
+        if (best_edge == NULL || score < best_score)
+        {
+            best_edge = iter;
+            best_score = score;
+        }
+    }
+
+    // Worth evicting another key for if it has a lower score than every verified edge
+    choose_request_verification(&unverified, best_edge == NULL || -unverified.preference < best_score);
+
+    return best_edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
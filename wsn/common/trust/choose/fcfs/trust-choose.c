@@ -14,30 +14,33 @@
 // the provided capability
 edge_resource_t* choose_edge(const char* capability_name)
 {
+    // The first edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
+    edge_resource_t* chosen = NULL;
+
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
-        // Skip inactive edges
-        if (!edge_info_is_active(iter))
-        {
-            continue;
-        }
-
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
         if (capability == NULL)
         {
             continue;
         }
 
-        // Skip inactive capabilities
-        if (!edge_capability_is_active(capability))
+        if (!choose_is_verified(iter, 0.0f, &unverified))
         {
             continue;
         }
-        
+
         // Use the first edge we find that we can use
-        return iter;
+        chosen = iter;
+        break;
     }
 
-    return NULL;
+    // Any unverified edge was found before the chosen one, so would have been used instead
+    choose_request_verification(&unverified, true);
+
+    return chosen;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
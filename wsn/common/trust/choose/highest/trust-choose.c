@@ -1,6 +1,7 @@
 #include "trust-choose.h"
 #include "trust-model.h"
 #include "edge-info.h"
+#include "prof.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-high"
@@ -19,32 +20,30 @@ edge_resource_t* choose_edge(const char* capability_name)
     // Start trust at -1, so even edges with 0 trust will be considered
     float best_trust = -1.0f;
 
+    // The most trusted edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
-        // Skip inactive edges
-        if (!edge_info_is_active(iter))
-        {
-            continue;
-        }
-
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
         if (capability == NULL)
-        {
-            LOG_WARN("Cannot find capability %s for edge %s\n", capability_name, edge_info_name(iter));
-            continue;
-        }
-
-        // Skip inactive capabilities
-        if (!edge_capability_is_active(capability))
         {
             continue;
         }
 
+        PROF_BEGIN(CALCULATE_TRUST_VALUE);
         float trust_value = calculate_trust_value(iter, capability);
+        PROF_END(CALCULATE_TRUST_VALUE);
 
         LOG_INFO("Trust value for edge %s and capability %s=%f\n",
             edge_info_name(iter), capability_name, trust_value);
 
+        if (!choose_is_verified(iter, trust_value, &unverified))
+        {
+            continue;
+        }
+
         if (trust_value > best_trust)
         {
             best_edge = iter;
@@ -52,6 +51,9 @@ edge_resource_t* choose_edge(const char* capability_name)
         }
     }
 
+    // Worth evicting another key for if it is more trusted than every verified edge
+    choose_request_verification(&unverified, best_edge == NULL || unverified.preference > best_trust);
+
     return best_edge;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
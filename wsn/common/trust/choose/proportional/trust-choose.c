@@ -1,6 +1,7 @@
 #include "trust-choose.h"
 #include "trust-model.h"
 #include "edge-info.h"
+#include "prof.h"
 #include "os/sys/log.h"
 #include "os/lib/random.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -20,6 +21,10 @@ edge_resource_t* choose_edge(const char* capability_name)
     uint16_t trust_values_boundaries[NUM_EDGE_RESOURCES];
 
     float trust_values_sum = 0.0f;
+    float highest_trust = -1.0f;
+
+    // The most trusted edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
 
     uint8_t candidates_len = 0;
 
@@ -31,22 +36,9 @@ edge_resource_t* choose_edge(const char* capability_name)
         //edge_resource_tm_print(&iter->tm);
         //LOG_DBG_("\n");
 
-        // Skip inactive edges
-        if (!edge_info_is_active(iter))
-        {
-            continue;
-        }
-
-        // Make sure the edge has the desired capability
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
         if (capability == NULL)
-        {
-            //LOG_DBG("Excluding edge %s because it lacks the capability\n", edge_info_name(iter));
-            continue;
-        }
-
-        // Skip inactive capabilities
-        if (!edge_capability_is_active(capability))
         {
             continue;
         }
@@ -57,7 +49,14 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
+        PROF_BEGIN(CALCULATE_TRUST_VALUE);
         const float trust_value = calculate_trust_value(iter, capability);
+        PROF_END(CALCULATE_TRUST_VALUE);
+
+        if (!choose_is_verified(iter, trust_value, &unverified))
+        {
+            continue;
+        }
 
         // Record this as a potential candidate
         candidates[candidates_len] = iter;
@@ -69,6 +68,11 @@ edge_resource_t* choose_edge(const char* capability_name)
         candidates_len++;
 
         trust_values_sum += trust_value;
+
+        if (trust_value > highest_trust)
+        {
+            highest_trust = trust_value;
+        }
     }
 
     for (uint8_t i = 0; i != candidates_len; ++i)
@@ -82,6 +86,9 @@ edge_resource_t* choose_edge(const char* capability_name)
 
     LOG_DBG("There are %u candidates \n", candidates_len);
 
+    // Worth evicting another key for if it is more trusted than every verified edge
+    choose_request_verification(&unverified, candidates_len == 0 || unverified.preference > highest_trust);
+
     if (candidates_len == 0)
     {
         return NULL;
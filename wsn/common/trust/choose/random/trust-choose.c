@@ -18,22 +18,19 @@ edge_resource_t* choose_edge(const char* capability_name)
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
     uint16_t candidates_len = 0;
 
+    // An edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
-        // Skip inactive edges
-        if (!edge_info_is_active(iter))
-        {
-            continue;
-        }
-
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
         if (capability == NULL)
         {
             continue;
         }
 
-        // Skip inactive capabilities
-        if (!edge_capability_is_active(capability))
+        if (!choose_is_verified(iter, 0.0f, &unverified))
         {
             continue;
         }
@@ -43,6 +40,9 @@ edge_resource_t* choose_edge(const char* capability_name)
         candidates_len++;
     }
 
+    // Every edge is equally preferred, so only evict another key when no edge is verified
+    choose_request_verification(&unverified, candidates_len == 0);
+
     // No valid options
     if (candidates_len == 0)
     {
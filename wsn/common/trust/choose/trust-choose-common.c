@@ -0,0 +1,125 @@
+#include "trust-choose.h"
+#include "trust-model.h"
+#include "edge-info.h"
+#include "keystore.h"
+#include "prof.h"
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "trust-choose"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+edge_capability_t* choose_candidate_capability(edge_resource_t* edge, const char* capability_name)
+{
+    if (!edge_info_is_active(edge))
+    {
+        return NULL;
+    }
+
+    edge_capability_t* capability = edge_info_capability_find(edge, capability_name);
+    if (capability == NULL)
+    {
+        return NULL;
+    }
+
+    if (!edge_capability_is_active(capability))
+    {
+        return NULL;
+    }
+
+    // Edges that are overloaded have asked for no more tasks for now
+    if (edge_capability_is_overloaded(capability))
+    {
+        LOG_DBG("Not choosing edge %s as %s is overloaded\n", edge_info_name(edge), capability_name);
+        return NULL;
+    }
+
+    return capability;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool choose_is_verified(edge_resource_t* edge, float preference, choose_unverified_t* unverified)
+{
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    if (keystore_find_addr(&edge->ep.ipaddr) != NULL)
+    {
+        return true;
+    }
+
+    LOG_DBG("Not choosing edge %s until its certificate has been verified\n", edge_info_name(edge));
+
+    if (unverified->edge == NULL || preference > unverified->preference)
+    {
+        unverified->edge = edge;
+        unverified->preference = preference;
+    }
+
+    return false;
+#else
+    return true;
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void choose_request_verification(const choose_unverified_t* unverified, bool preferred)
+{
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    // Only certificates of edges that would be chosen are verified, so those of edges
+    // that would never be picked do not take space in the keystore.
+    if (unverified->edge != NULL)
+    {
+        keystore_request_verification(&unverified->edge->ep.ipaddr, preferred);
+    }
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+edge_resource_t* choose_next_best_edge(const char* capability_name, const edge_resource_t* exclude)
+{
+    edge_resource_t* best_edge = NULL;
+
+    // Start trust at -1, so even edges with 0 trust will be considered
+    float best_trust = -1.0f;
+
+    // The most trusted edge that cannot be chosen until its certificate is verified
+    choose_unverified_t unverified = { NULL, 0.0f };
+
+    for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
+    {
+        if (iter == exclude)
+        {
+            continue;
+        }
+
+        // Skip edges that cannot be chosen (inactive or overloaded)
+        edge_capability_t* capability = choose_candidate_capability(iter, capability_name);
+        if (capability == NULL)
+        {
+            continue;
+        }
+
+        PROF_BEGIN(CALCULATE_TRUST_VALUE);
+        const float trust_value = calculate_trust_value(iter, capability);
+        PROF_END(CALCULATE_TRUST_VALUE);
+
+        LOG_DBG("Next best trust value for edge %s and capability %s=%f\n",
+            edge_info_name(iter), capability_name, trust_value);
+
+        if (!choose_is_verified(iter, trust_value, &unverified))
+        {
+            continue;
+        }
+
+        if (trust_value > best_trust)
+        {
+            best_edge = iter;
+            best_trust = trust_value;
+        }
+    }
+
+    // Worth evicting another key for if it is more trusted than every verified edge
+    choose_request_verification(&unverified, best_edge == NULL || unverified.preference > best_trust);
+
+    return best_edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,5 +1,33 @@
 #pragma once
 
+#include <stdbool.h>
+
 struct edge_resource;
+struct edge_capability;
 
 struct edge_resource* choose_edge(const char* capability_name);
+
+// Returns the capability of the edge to consider choosing it for, or NULL if the edge cannot be
+// chosen: either it or its capability is inactive, or it has asked for no more tasks for now.
+// Every choose policy filters its candidates with this.
+struct edge_capability* choose_candidate_capability(struct edge_resource* edge, const char* capability_name);
+
+// Pick the most trusted candidate edge with the capability other than the one provided,
+// independent of the choose policy in use.
+struct edge_resource* choose_next_best_edge(const char* capability_name, const struct edge_resource* exclude);
+
+// With KEYSTORE_LAZY_VERIFICATION certificates are only verified for edges that a policy would choose,
+// and edges are only chosen once their certificate has been verified. Policies choose from the verified
+// candidates, tracking the unverified candidate they most prefer (higher preference is better).
+typedef struct choose_unverified {
+    struct edge_resource* edge;
+    float preference;
+} choose_unverified_t;
+
+// Returns true if the edge can be chosen. Otherwise records it in unverified if it is preferred
+// over the unverified candidates seen so far. Always true without KEYSTORE_LAZY_VERIFICATION.
+bool choose_is_verified(struct edge_resource* edge, float preference, choose_unverified_t* unverified);
+
+// Starts verifying the certificate of the most preferred unverified candidate, if there was one.
+// When it is preferred over every verified candidate, an unused key may be evicted to make space for it.
+void choose_request_verification(const choose_unverified_t* unverified, bool preferred);
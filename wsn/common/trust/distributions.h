@@ -23,6 +23,8 @@ void beta_dist_combine(const beta_dist_t* a, const beta_dist_t* b, beta_dist_t*
 /*-------------------------------------------------------------------------------------------------------------------*/
 int beta_dist_serialise(nanocbor_encoder_t* enc, const beta_dist_t* dist);
 int beta_dist_deserialise(nanocbor_value_t* dec, beta_dist_t* dist);
+
+#define BETA_DIST_CBOR_MAX_LEN ((1) + (2 * (1 + sizeof(uint32_t))))
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -44,6 +46,8 @@ void gaussian_dist_update(gaussian_dist_t* dist, float value);
 /*-------------------------------------------------------------------------------------------------------------------*/
 int gaussian_dist_serialise(nanocbor_encoder_t* enc, const gaussian_dist_t* dist);
 int gaussian_dist_deserialise(nanocbor_value_t* dec, gaussian_dist_t* dist);
+
+#define GAUSSIAN_DIST_CBOR_MAX_LEN ((1) + (2 * (1 + sizeof(float))) + (1 + sizeof(uint32_t)))
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
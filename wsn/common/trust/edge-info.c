@@ -1,10 +1,16 @@
 #include "edge-info.h"
 #include "eui64.h"
+#include "keystore.h"
+
+#include <string.h>
 
 #include "lib/memb.h"
+#include "memb-stats.h"
 #include "os/sys/log.h"
 
 #include "coap-constants.h"
+#include "coap-transactions.h"
+#include "coap-timer.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-edge"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -29,6 +35,7 @@ free_up_edge_capabilities(void)
         {
             if (!edge_capability_is_active(citer))
             {
+                memb_stats_evicted(&edge_capabilities_memb);
                 return edge_info_capability_remove(eiter, citer);
             }
         }
@@ -48,12 +55,12 @@ edge_capability_new(edge_resource_t* edge)
         return NULL;
     }
 
-    edge_capability_t* cap = memb_alloc(&edge_capabilities_memb);
+    edge_capability_t* cap = memb_stats_alloc(&edge_capabilities_memb);
     if (cap == NULL)
     {
         free_up_edge_capabilities();
 
-        cap = memb_alloc(&edge_capabilities_memb);
+        cap = memb_stats_alloc(&edge_capabilities_memb);
         if (cap == NULL)
         {
             return NULL;
@@ -62,6 +69,8 @@ edge_capability_new(edge_resource_t* edge)
 
     edge_capability_tm_init(&cap->tm);
 
+    memset(&cap->load, 0, sizeof(cap->load));
+
     return cap;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -80,6 +89,7 @@ free_up_edge_resource(void)
     {
         if (!edge_info_is_active(eiter))
         {
+            memb_stats_evicted(&edge_resources_memb);
             return edge_info_remove(eiter);
         }
     }
@@ -90,12 +100,12 @@ free_up_edge_resource(void)
 static edge_resource_t*
 edge_resource_new(void)
 {
-    edge_resource_t* edge = memb_alloc(&edge_resources_memb);
+    edge_resource_t* edge = memb_stats_alloc(&edge_resources_memb);
     if (edge == NULL)
     {
         free_up_edge_resource();
 
-        edge = memb_alloc(&edge_resources_memb);
+        edge = memb_stats_alloc(&edge_resources_memb);
         if (edge == NULL)
         {
             return NULL;
@@ -104,6 +114,8 @@ edge_resource_new(void)
 
     edge_resource_tm_init(&edge->tm);
 
+    memset(&edge->rtt, 0, sizeof(edge->rtt));
+
     LIST_STRUCT_INIT(edge, capabilities);
 
     return edge;
@@ -129,6 +141,8 @@ edge_info_init(void)
 
     memb_init(&edge_resources_memb);
     memb_init(&edge_capabilities_memb);
+    MEMB_STATS_REGISTER(edge_resources_memb);
+    MEMB_STATS_REGISTER(edge_capabilities_memb);
     list_init(edge_resources);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -340,3 +354,217 @@ bool edge_info_has_active_capability(const char* name)
     return false;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+void
+edge_info_rtt_update(edge_resource_t* edge, clock_time_t rtt)
+{
+    edge_rtt_t* r = &edge->rtt;
+    const int32_t sample = (int32_t)rtt;
+
+    if (r->samples == 0)
+    {
+        r->srtt = sample << 3;
+        r->rttvar = sample << 1; // rttvar = sample / 2
+    }
+    else
+    {
+        // srtt += (sample - srtt) / 8
+        int32_t delta = sample - (r->srtt >> 3);
+        r->srtt += delta;
+
+        // rttvar += (|sample - srtt| - rttvar) / 4
+        if (delta < 0)
+        {
+            delta = -delta;
+        }
+        r->rttvar += delta - (r->rttvar >> 2);
+    }
+
+    if (r->samples < UINT16_MAX)
+    {
+        r->samples += 1;
+    }
+
+    LOG_DBG("Edge %s rtt=%lu srtt=%ld rttvar=%ld rto=%lu\n", edge_info_name(edge),
+        (unsigned long)rtt, (long)(r->srtt >> 3), (long)(r->rttvar >> 2), (unsigned long)edge_info_rto(edge));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns 0 if there have been no round trip time samples
+clock_time_t
+edge_info_srtt(const edge_resource_t* edge)
+{
+    return (edge->rtt.samples == 0) ? 0 : (clock_time_t)(edge->rtt.srtt >> 3);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+edge_info_rto(const edge_resource_t* edge)
+{
+    const edge_rtt_t* r = &edge->rtt;
+
+    if (r->samples == 0)
+    {
+        return EDGE_RTO_INITIAL;
+    }
+
+    // rto = srtt + 4 * rttvar
+    const int32_t rto = (r->srtt >> 3) + r->rttvar;
+
+    if (rto < (int32_t)EDGE_RTO_MIN)
+    {
+        return EDGE_RTO_MIN;
+    }
+    if (rto > (int32_t)EDGE_RTO_MAX)
+    {
+        return EDGE_RTO_MAX;
+    }
+
+    return (clock_time_t)rto;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// How long to wait for a result from this edge given how long the task is expected to take
+clock_time_t
+edge_info_deadline(const edge_resource_t* edge, clock_time_t processing)
+{
+    return processing + EDGE_DEADLINE_RTO_MULTIPLIER * edge_info_rto(edge);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The CoAP engine uses the same ACK timeout for every destination, so once a confirmable request
+// has been sent, replace its initial retransmission timeout with one for this edge.
+// Subsequent retransmissions double this interval as normal.
+void
+edge_info_set_coap_timeout(const edge_resource_t* edge, coap_request_state_t* state)
+{
+    coap_transaction_t* t = state->transaction;
+
+    // Only change requests that have been sent once and are waiting for an ACK
+    if (t == NULL || t->retrans_counter != 0 || edge->rtt.samples == 0)
+    {
+        return;
+    }
+
+    const uint64_t interval_ms = ((uint64_t)edge_info_rto(edge) * 1000) / CLOCK_SECOND;
+
+    t->retrans_interval = (uint32_t)interval_ms;
+    coap_timer_set(&t->retrans_timer, interval_ms);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+edge_capability_load_stats(edge_capability_t* cap, uint32_t mean, uint32_t variance)
+{
+    cap->load.mean = mean;
+    cap->load.variance = variance;
+    cap->load.has_stats = true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+edge_capability_task_started(edge_capability_t* cap)
+{
+    if (cap->load.in_flight < UINT16_MAX)
+    {
+        cap->load.in_flight += 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+edge_capability_task_finished(edge_capability_t* cap)
+{
+    if (cap->load.in_flight > 0)
+    {
+        cap->load.in_flight -= 1;
+    }
+
+    // Our task is no longer queued at the edge
+    if (cap->load.queue_depth > 0)
+    {
+        cap->load.queue_depth -= 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+edge_capability_queue_depth(edge_capability_t* cap, uint16_t queue_depth)
+{
+    cap->load.queue_depth = queue_depth;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Tasks expected to be queued or in progress at the edge.
+// The depth the edge reports includes tasks from this node, so take the larger of the two.
+uint16_t
+edge_capability_queued(const edge_capability_t* cap)
+{
+    return cap->load.in_flight > cap->load.queue_depth ? cap->load.in_flight : cap->load.queue_depth;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The edge rejected a task, so avoid it for the duration it asked for.
+// A duration of 0 means the edge is accepting tasks again.
+void
+edge_capability_overloaded(edge_capability_t* cap, clock_time_t duration)
+{
+    cap->load.overloaded = (duration != 0);
+
+    if (cap->load.overloaded)
+    {
+        timer_set(&cap->load.overloaded_timer, duration);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+edge_capability_is_overloaded(edge_capability_t* cap)
+{
+    if (cap->load.overloaded && timer_expired(&cap->load.overloaded_timer))
+    {
+        cap->load.overloaded = false;
+    }
+
+    return cap->load.overloaded;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t
+isqrt32(uint32_t x)
+{
+    uint32_t result = 0;
+    uint32_t bit = (uint32_t)1 << 30;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (x >= result + bit)
+        {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Latency that 90% of tasks submitted to this edge should complete within,
+// including those already in flight to it. Returns 0 if the edge has not reported any stats.
+clock_time_t
+edge_capability_latency_p90(const edge_resource_t* edge, const edge_capability_t* cap)
+{
+    if (!cap->load.has_stats)
+    {
+        return 0;
+    }
+
+    // Assume service times are normally distributed, so p90 is 1.28 standard deviations above the mean
+    uint64_t latency_ms = cap->load.mean + ((uint64_t)isqrt32(cap->load.variance) * 128) / 100;
+
+    // Tasks queued ahead of the most recent one
+    const uint16_t queued = edge_capability_queued(cap);
+    if (queued > 1)
+    {
+        latency_ms += (uint64_t)(queued - 1) * cap->load.mean;
+    }
+
+    return (clock_time_t)((latency_ms * CLOCK_SECOND) / 1000) + edge_info_srtt(edge);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -11,6 +11,7 @@
 #include "stereotype-tags.h"
 
 #include "coap-endpoint.h"
+#include "coap-request-state.h"
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef NUM_EDGE_RESOURCES
@@ -24,6 +25,18 @@
 #define EDGE_CAPABILITY_NO_FLAGS 0
 #define EDGE_CAPABILITY_ACTIVE (1 << 0)
 /*-------------------------------------------------------------------------------------------------------------------*/
+// How long the edge reports tasks for a capability take and how many tasks this node has outstanding with it
+typedef struct edge_capability_load
+{
+    uint32_t mean;     // Milliseconds
+    uint32_t variance; // Milliseconds^2
+    uint16_t in_flight;
+    uint16_t queue_depth; // Tasks the edge last reported as queued from all nodes
+    bool has_stats;
+    bool overloaded;
+    struct timer overloaded_timer; // Until when the edge asked for no more tasks
+} edge_capability_load_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct edge_capability
 {
     struct edge_capability *next;
@@ -34,11 +47,37 @@ typedef struct edge_capability
 
     edge_capability_tm_t tm;
 
+    edge_capability_load_t load;
+
 } edge_capability_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define EDGE_RESOURCE_NO_FLAGS 0
 #define EDGE_RESOURCE_ACTIVE (1 << 0)
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Bounds on the retransmission timeout derived from the measured round trip time
+#ifndef EDGE_RTO_MIN
+#define EDGE_RTO_MIN (1 * CLOCK_SECOND)
+#endif
+#ifndef EDGE_RTO_MAX
+#define EDGE_RTO_MAX (16 * CLOCK_SECOND)
+#endif
+// Used until there is a round trip time sample (same as CoAP's ACK_TIMEOUT)
+#ifndef EDGE_RTO_INITIAL
+#define EDGE_RTO_INITIAL (2 * CLOCK_SECOND)
+#endif
+// How many retransmission timeouts a task result deadline allows for the network
+#ifndef EDGE_DEADLINE_RTO_MULTIPLIER
+#define EDGE_DEADLINE_RTO_MULTIPLIER 4
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Smoothed round trip time (Jacobson/Karels)
+typedef struct edge_rtt
+{
+    int32_t srtt;   // Scaled by 8
+    int32_t rttvar; // Scaled by 4
+    uint16_t samples;
+} edge_rtt_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct edge_resource
 {
     struct edge_resource *next;
@@ -49,6 +88,8 @@ typedef struct edge_resource
 
     edge_resource_tm_t tm;
 
+    edge_rtt_t rtt;
+
     LIST_STRUCT(capabilities);
 
 } edge_resource_t;
@@ -85,3 +126,18 @@ const char* edge_info_name(const edge_resource_t* edge); // TODO: Remove this fu
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_info_has_active_capability(const char* name);
 /*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_rtt_update(edge_resource_t* edge, clock_time_t rtt);
+clock_time_t edge_info_srtt(const edge_resource_t* edge);
+clock_time_t edge_info_rto(const edge_resource_t* edge);
+clock_time_t edge_info_deadline(const edge_resource_t* edge, clock_time_t processing);
+void edge_info_set_coap_timeout(const edge_resource_t* edge, coap_request_state_t* state);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_capability_load_stats(edge_capability_t* cap, uint32_t mean, uint32_t variance);
+void edge_capability_task_started(edge_capability_t* cap);
+void edge_capability_task_finished(edge_capability_t* cap);
+void edge_capability_queue_depth(edge_capability_t* cap, uint16_t queue_depth);
+uint16_t edge_capability_queued(const edge_capability_t* cap);
+void edge_capability_overloaded(edge_capability_t* cap, clock_time_t duration);
+bool edge_capability_is_overloaded(edge_capability_t* cap);
+clock_time_t edge_capability_latency_p90(const edge_resource_t* edge, const edge_capability_t* cap);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,75 @@
+#include "edge-ping-schedule.h"
+
+#include "os/lib/random.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A random delay in [0, max)
+static clock_time_t random_delay(clock_time_t max)
+{
+    return (clock_time_t)(((uint32_t)max * random_rand()) / ((uint32_t)RANDOM_RAND_MAX + 1));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_ping_schedule_init(edge_ping_schedule_t* s)
+{
+    s->sent = 0;
+    s->interval = EDGE_PING_INTERVAL;
+    s->seq = 0;
+    s->replies = 0;
+    s->outstanding = false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t edge_ping_schedule_first_delay(const edge_ping_schedule_t* s)
+{
+    return random_delay(s->interval);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Up to a quarter of the interval either side, so pings to different edges do not fall into step
+clock_time_t edge_ping_schedule_next_delay(const edge_ping_schedule_t* s)
+{
+    return s->interval - (s->interval / 4) + random_delay(s->interval / 2);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool edge_ping_schedule_timed_out(edge_ping_schedule_t* s)
+{
+    if (!s->outstanding)
+    {
+        return false;
+    }
+
+    // Check on an edge that has recently failed more often
+    s->interval = EDGE_PING_INTERVAL_MIN;
+    s->replies = 0;
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t edge_ping_schedule_sent(edge_ping_schedule_t* s)
+{
+    s->seq += 1;
+    s->sent = clock_time();
+    s->outstanding = true;
+
+    return s->seq;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool edge_ping_schedule_replied(edge_ping_schedule_t* s, uint16_t seq, clock_time_t* rtt)
+{
+    if (!s->outstanding || seq != s->seq)
+    {
+        return false;
+    }
+
+    *rtt = clock_time() - s->sent;
+    s->outstanding = false;
+
+    s->replies += 1;
+
+    // Stable for a while, so probe less often
+    if (s->replies >= EDGE_PING_STABLE_REPLIES)
+    {
+        s->replies = 0;
+        s->interval = (s->interval >= EDGE_PING_INTERVAL_MAX / 2) ? EDGE_PING_INTERVAL_MAX : s->interval * 2;
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
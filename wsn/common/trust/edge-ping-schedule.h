@@ -0,0 +1,62 @@
+#pragma once
+
+#include "contiki.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// When to ping each edge and how to back off, without sending anything.
+// Used by edge-ping.c and by the simulator in wsn/sim, so both ping edges on the same schedule.
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Seconds between pings to each edge, when it has neither recently failed nor been stable for long
+#ifndef TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL
+#define TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL 5
+#endif
+
+#define EDGE_PING_INTERVAL (TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL * CLOCK_SECOND)
+
+// Edges that have just missed a ping are probed this often
+#ifndef EDGE_PING_INTERVAL_MIN
+#define EDGE_PING_INTERVAL_MIN (EDGE_PING_INTERVAL / 2)
+#endif
+
+// Long stable edges are backed off to this
+#ifndef EDGE_PING_INTERVAL_MAX
+#define EDGE_PING_INTERVAL_MAX (EDGE_PING_INTERVAL * 8)
+#endif
+
+// Replies in a row before doubling the interval
+#ifndef EDGE_PING_STABLE_REPLIES
+#define EDGE_PING_STABLE_REPLIES 4
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct edge_ping_schedule
+{
+    clock_time_t sent;
+    clock_time_t interval;
+
+    uint16_t seq;
+    uint8_t replies;
+    bool outstanding;
+
+} edge_ping_schedule_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_ping_schedule_init(edge_ping_schedule_t* s);
+
+// Delay before the first ping, at a random phase so edges discovered together are not pinged together
+clock_time_t edge_ping_schedule_first_delay(const edge_ping_schedule_t* s);
+
+// Delay from sending a ping until the next one
+clock_time_t edge_ping_schedule_next_delay(const edge_ping_schedule_t* s);
+
+// Call when it is time to ping. Returns true if the last ping has gone a whole interval
+// without a reply, in which case the edge is probed more often from now on.
+bool edge_ping_schedule_timed_out(edge_ping_schedule_t* s);
+
+// Records that a ping was sent now and returns its sequence number
+uint16_t edge_ping_schedule_sent(edge_ping_schedule_t* s);
+
+// Records a reply with sequence number seq. Returns true and sets rtt if it is
+// the first reply to the latest ping, which is the only one to take a sample from.
+bool edge_ping_schedule_replied(edge_ping_schedule_t* s, uint16_t seq, clock_time_t* rtt);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,10 +1,13 @@
 #include "edge-ping.h"
+#include "edge-ping-schedule.h"
 #include "edge-info.h"
 #include "trust-models.h"
 
 #include "uip-icmp6.h"
 
-#include "etimer.h"
+#include <string.h>
+
+#include "timer-wheel.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "edge-ping"
@@ -14,23 +17,37 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-// Number of bytes in the ping payload
+// Number of bytes in the ping payload, including the identifier and sequence number
 #ifndef EDGE_PING_ECHO_REQ_PAYLOAD_LEN
 #define EDGE_PING_ECHO_REQ_PAYLOAD_LEN 20
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-// Seconds between pings
-#ifndef TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL
-#define TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL 5
+// How often to look for edges that have been added or removed
+#ifndef EDGE_PING_SCAN_PERIOD
+#define EDGE_PING_SCAN_PERIOD EDGE_PING_INTERVAL
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Distinguishes our echo replies from those to other pings (e.g., the MQTT client's parent pings)
+#define EDGE_PING_IDENTIFIER 0x6570
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct edge_ping_target
+{
+    wheel_timer_t timer;
+
+    uip_ipaddr_t addr;
+
+    edge_ping_schedule_t schedule;
+
+    bool in_use;
+
+} edge_ping_target_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
 PROCESS(edge_ping_process, "edge-ping");
 /*-------------------------------------------------------------------------------------------------------------------*/
-static struct etimer ping_timer;
+static wheel_timer_t scan_timer;
 static struct uip_icmp6_echo_reply_notification echo_notification;
 /*-------------------------------------------------------------------------------------------------------------------*/
-static bool has_started;
-static uip_ipaddr_t current_edge;
+static edge_ping_target_t targets[NUM_EDGE_RESOURCES];
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_ping_start(void)
 {
@@ -38,104 +55,160 @@ void edge_ping_start(void)
     process_start(&edge_ping_process, NULL);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static edge_resource_t* find_next_edge_from_scratch(void)
+static edge_ping_target_t* target_find(const uip_ipaddr_t* addr)
+{
+    for (uint8_t i = 0; i != NUM_EDGE_RESOURCES; ++i)
+    {
+        if (targets[i].in_use && uip_ipaddr_cmp(&targets[i].addr, addr))
+        {
+            return &targets[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void ping_timer_callback(void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void send_ping(edge_ping_target_t* target, edge_resource_t* edge)
+{
+    const uint16_t seq = edge_ping_schedule_sent(&target->schedule);
+
+    LOG_INFO("Pinging edge ");
+    LOG_INFO_6ADDR(&target->addr);
+    LOG_INFO_(" seq=%" PRIu16 " interval=%lu\n", seq, (unsigned long)target->schedule.interval);
+
+    uint8_t* payload = UIP_ICMP_PAYLOAD;
+    memset(payload, 0, EDGE_PING_ECHO_REQ_PAYLOAD_LEN);
+    payload[0] = EDGE_PING_IDENTIFIER >> 8;
+    payload[1] = EDGE_PING_IDENTIFIER & 0xff;
+    payload[2] = seq >> 8;
+    payload[3] = seq & 0xff;
+
+    uip_icmp6_send(&target->addr, ICMP6_ECHO_REQUEST, 0, EDGE_PING_ECHO_REQ_PAYLOAD_LEN);
+
+    const tm_edge_ping_t info = {
+        .action = TM_PING_SENT
+    };
+
+    tm_update_ping(edge, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void ping_timer_callback(void* ptr)
 {
-    edge_resource_t* edge = edge_info_iter();
-    if (edge)
+    edge_ping_target_t* target = (edge_ping_target_t*)ptr;
+
+    edge_resource_t* edge = edge_info_find_addr(&target->addr);
+    if (edge == NULL)
     {
-        current_edge = edge->ep.ipaddr;
-        has_started = true;
+        // Removed, release the target so the edge is pinged again if it is re-added
+        target->in_use = false;
+        return;
     }
-    else
+
+    // No reply to the last ping in a whole interval
+    if (edge_ping_schedule_timed_out(&target->schedule))
     {
-        has_started = false;
+        LOG_WARN("No reply to ping seq=%" PRIu16 " from edge ", target->schedule.seq);
+        LOG_WARN_6ADDR(&target->addr);
+        LOG_WARN_("\n");
+
+        const tm_edge_ping_t info = {
+            .action = TM_PING_TIMEOUT
+        };
+
+        tm_update_ping(edge, &info);
     }
 
-    return edge;
+    send_ping(target, edge);
+
+    wheel_timer_set(&target->timer, edge_ping_schedule_next_delay(&target->schedule), ping_timer_callback, target);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static edge_resource_t* find_next_edge(void)
+static void scan_edges(void)
 {
-    if (!has_started)
+    // Release targets for edges that no longer exist
+    for (uint8_t i = 0; i != NUM_EDGE_RESOURCES; ++i)
     {
-        return find_next_edge_from_scratch();
+        if (targets[i].in_use && edge_info_find_addr(&targets[i].addr) == NULL)
+        {
+            wheel_timer_stop(&targets[i].timer);
+            targets[i].in_use = false;
+        }
     }
-    else
+
+    for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
     {
-        edge_resource_t* edge = edge_info_find_addr(&current_edge);
-        if (edge)
+        if (target_find(&edge->ep.ipaddr) != NULL)
         {
-            edge = edge_info_next(edge);
-            if (edge)
-            {
-                current_edge = edge->ep.ipaddr;
-                has_started = true;
+            continue;
+        }
 
-                return edge;
-            }
-            else
+        edge_ping_target_t* target = NULL;
+        for (uint8_t i = 0; i != NUM_EDGE_RESOURCES; ++i)
+        {
+            if (!targets[i].in_use)
             {
-                return find_next_edge_from_scratch();
+                target = &targets[i];
+                break;
             }
         }
-        else
+
+        if (target == NULL)
         {
-            return find_next_edge_from_scratch();
+            LOG_ERR("No space to ping edge %s\n", edge_info_name(edge));
+            break;
         }
+
+        uip_ipaddr_copy(&target->addr, &edge->ep.ipaddr);
+        edge_ping_schedule_init(&target->schedule);
+        target->in_use = true;
+
+        wheel_timer_set(&target->timer, edge_ping_schedule_first_delay(&target->schedule), ping_timer_callback, target);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static void periodic_action(void)
+void echo_callback(uip_ipaddr_t *source, uint8_t ttl, uint8_t *data, uint16_t datalen)
 {
-    // Work out who to send to next
-    edge_resource_t* edge = find_next_edge();
-
-    if (has_started)
+    if (datalen < 4)
     {
-        LOG_INFO("Pinging edge ");
-        LOG_INFO_6ADDR(&current_edge);
-        LOG_INFO_("\n");
-
-        uip_icmp6_send(&current_edge, ICMP6_ECHO_REQUEST, 0, EDGE_PING_ECHO_REQ_PAYLOAD_LEN);
+        return;
+    }
 
-        const tm_edge_ping_t info = {
-            .action = TM_PING_SENT
-        };
+    const uint16_t identifier = ((uint16_t)data[0] << 8) | data[1];
+    const uint16_t seq = ((uint16_t)data[2] << 8) | data[3];
 
-        tm_update_ping(edge, &info);
-    }
-    else
+    if (identifier != EDGE_PING_IDENTIFIER)
     {
-        LOG_INFO("Not pinging any edge, as none available\n");
+        return;
     }
-}
-/*-------------------------------------------------------------------------------------------------------------------*/
-void echo_callback(uip_ipaddr_t *source, uint8_t ttl, uint8_t *data, uint16_t datalen)
-{
-    LOG_INFO("Received ping response from ");
+
+    LOG_INFO("Received ping response seq=%" PRIu16 " from ", seq);
     LOG_INFO_6ADDR(source);
-    LOG_INFO_(" current edge (");
-    LOG_INFO_6ADDR(&current_edge);
-    LOG_INFO_(")\n");
+    LOG_INFO_("\n");
 
     edge_resource_t* edge = edge_info_find_addr(source);
-    if (edge)
-    {
-        // Only update if we expected this edge to reply to a ping
-        if (uip_ipaddr_cmp(source, &current_edge))
-        {
-            const tm_edge_ping_t info = {
-                .action = TM_PING_RECEIVED
-            };
-
-            tm_update_ping(edge, &info);
-        }
-    }
-    else
+    edge_ping_target_t* target = target_find(source);
+    if (edge == NULL || target == NULL)
     {
         LOG_WARN("Edge ");
-        LOG_WARN_6ADDR(&current_edge);
+        LOG_WARN_6ADDR(source);
         LOG_WARN_(" no longer exists\n");
+        return;
+    }
+
+    // Any reply shows the edge is alive
+    const tm_edge_ping_t info = {
+        .action = TM_PING_RECEIVED
+    };
+
+    tm_update_ping(edge, &info);
+
+    // Only the first reply to the latest ping gives a round trip time sample
+    clock_time_t rtt;
+    if (edge_ping_schedule_replied(&target->schedule, seq, &rtt))
+    {
+        edge_info_rtt_update(edge, rtt);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -143,22 +216,22 @@ PROCESS_THREAD(edge_ping_process, ev, data)
 {
     PROCESS_BEGIN();
 
-    has_started = false;
-
-    memset(&current_edge, 0, sizeof(current_edge));
+    memset(targets, 0, sizeof(targets));
 
     // We want to get notified of ping responses
     uip_icmp6_echo_reply_callback_add(&echo_notification, &echo_callback);
 
-    etimer_set(&ping_timer, TRUST_MODEL_PERIODIC_EDGE_PING_INTERVAL * CLOCK_SECOND);
+    scan_edges();
+
+    wheel_timer_set_event(&scan_timer, EDGE_PING_SCAN_PERIOD);
 
     while (1)
     {
-        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &ping_timer);
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &scan_timer);
 
-        periodic_action();
+        scan_edges();
 
-        etimer_reset(&ping_timer);
+        wheel_timer_restart(&scan_timer);
     }
 
     PROCESS_END();
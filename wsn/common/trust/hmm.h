@@ -55,11 +55,12 @@ typedef struct {
 
 } hmm_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Each float is encoded with a one byte header
 #define HMM_CBOR_MAX_SIZE ( \
     (1) + \
-    (1) + HMM_NUM_STATES * sizeof(float) + \
-    (1) + HMM_NUM_STATES * ((1) + HMM_NUM_STATES * sizeof(float)) + \
-    (1) + HMM_NUM_STATES * ((1) + HMM_NUM_OBSERVATIONS * sizeof(float)) \
+    (1) + HMM_NUM_STATES * (1 + sizeof(float)) + \
+    (1) + HMM_NUM_STATES * ((1) + HMM_NUM_STATES * (1 + sizeof(float))) + \
+    (1) + HMM_NUM_STATES * ((1) + HMM_NUM_OBSERVATIONS * (1 + sizeof(float))) \
 )
 /*-------------------------------------------------------------------------------------------------------------------*/
 void hmm_init_default(hmm_t* hmm);
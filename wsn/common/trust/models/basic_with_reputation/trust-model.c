@@ -183,10 +183,10 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         return;
     }
 
-    LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_SUBMISSION, info->coap_request_status, info->coap_status,
+        "Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
         edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
-    beta_dist_print(&edge->tm.task_submission);
-    LOG_INFO_(" -> ");
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &edge->tm.task_submission);
 
     if (good)
     {
@@ -197,15 +197,15 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         beta_dist_add_bad(&edge->tm.task_submission);
     }
 
-    beta_dist_print(&edge->tm.task_submission);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &edge->tm.task_submission);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
-    beta_dist_print(&edge->tm.task_result);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_RESULT, info->result, 0,
+        "Updating Edge %s capability %s TM task_result (result=%d): ",
+        edge_info_name(edge), cap->name, info->result);
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &edge->tm.task_result);
 
     if (info->result == TM_TASK_RESULT_INFO_SUCCESS)
     {
@@ -216,15 +216,15 @@ void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const
         beta_dist_add_bad(&edge->tm.task_result);
     }
 
-    beta_dist_print(&edge->tm.task_result);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &edge->tm.task_result);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
-    beta_dist_print(&cap->tm.result_quality);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_RESULT_QUALITY, info->good, 0,
+        "Updating Edge %s capability %s TM result_quality (good=%d): ",
+        edge_info_name(edge), cap->name, info->good);
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &cap->tm.result_quality);
 
     if (info->good)
     {
@@ -235,8 +235,7 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         beta_dist_add_bad(&cap->tm.result_quality);
     }
 
-    beta_dist_print(&cap->tm.result_quality);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &cap->tm.result_quality);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
@@ -5,6 +5,9 @@
 #include "nanocbor-helper.h"
 
 #define TRUST_MODEL_TAG 1
+
+// Largest CBOR encoding of a state logged with TM_LOG_STATE_BEFORE and TM_LOG_STATE_AFTER
+#define TM_LOG_STATE_MAX_LEN BETA_DIST_CBOR_MAX_LEN
 //#define TRUST_MODEL_NO_PEER_PROVIDED
 //#define TRUST_MODEL_NO_PERIODIC_BROADCAST
 
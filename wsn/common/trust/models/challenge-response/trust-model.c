@@ -56,10 +56,10 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
 
     if (should_update)
     {
-        LOG_INFO("Updating Edge %s TM cr (type=%d,good=%d): ",
+        TM_LOG_UPDATE_BEGIN(edge, NULL, TRUST_METRIC_CHALLENGE_RESP, info->type, good,
+            "Updating Edge %s TM cr (type=%d,good=%d): ",
             edge_info_name(edge), info->type, good);
-        edge_resource_tm_print(&edge->tm);
-        LOG_INFO_(" -> ");
+        TM_LOG_STATE_BEFORE(edge_resource_tm_print, serialise_trust_edge_resource, &edge->tm);
 
         if (good)
         {
@@ -78,8 +78,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
             }
         }
 
-        edge_resource_tm_print(&edge->tm);
-        LOG_INFO_("\n");
+        TM_LOG_STATE_AFTER(edge_resource_tm_print, serialise_trust_edge_resource, &edge->tm);
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -8,6 +8,9 @@
 #define TRUST_MODEL_NO_PEER_PROVIDED
 #define TRUST_MODEL_NO_PERIODIC_BROADCAST
 
+// Largest CBOR encoding of a state logged with TM_LOG_STATE_BEFORE and TM_LOG_STATE_AFTER
+#define TM_LOG_STATE_MAX_LEN ((1) + (1 + sizeof(uint32_t)) + (1))
+
 struct edge_resource;
 
 /*-------------------------------------------------------------------------------------------------------------------*/
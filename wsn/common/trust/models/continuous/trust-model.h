@@ -8,6 +8,9 @@
 #define TRUST_MODEL_NO_PEER_PROVIDED
 #define TRUST_MODEL_NO_PERIODIC_BROADCAST
 
+// Largest CBOR encoding of a state logged with TM_LOG_STATE_BEFORE and TM_LOG_STATE_AFTER
+#define TM_LOG_STATE_MAX_LEN BETA_DIST_CBOR_MAX_LEN
+
 struct edge_resource;
 struct edge_capability;
 
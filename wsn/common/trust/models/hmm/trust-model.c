@@ -65,40 +65,40 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         return;
     }
 
-    LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_SUBMISSION, info->coap_request_status, info->coap_status,
+        "Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
         edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_(" -> ");
+    TM_LOG_STATE_BEFORE(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 
     if (!good)
     {
         interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_SUBMISSION_ACK_TIMEDOUT);
     }
 
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_RESULT, info->result, 0,
+        "Updating Edge %s capability %s TM task_result (result=%d): ",
+        edge_info_name(edge), cap->name, info->result);
+    TM_LOG_STATE_BEFORE(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 
     if (info->result != TM_TASK_RESULT_INFO_SUCCESS)
     {
         interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_RESPONSE_TIMEDOUT);
     }
 
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_RESULT_QUALITY, info->good, 0,
+        "Updating Edge %s capability %s TM result_quality (good=%d): ",
+        edge_info_name(edge), cap->name, info->good);
+    TM_LOG_STATE_BEFORE(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 
     if (info->good)
     {
@@ -109,8 +109,7 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_RESULT_QUALITY_INCORRECT);
     }
 
-    edge_capability_tm_print(&cap->tm);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(edge_capability_tm_print, serialise_trust_edge_capability, &cap->tm);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
@@ -175,10 +175,10 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         return;
     }
 
-    LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_SUBMISSION, info->coap_request_status, info->coap_status,
+        "Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
         edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
-    beta_dist_print(&edge->tm.task_submission);
-    LOG_INFO_(" -> ");
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &edge->tm.task_submission);
 
     if (good)
     {
@@ -189,15 +189,15 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         beta_dist_add_bad(&edge->tm.task_submission);
     }
 
-    beta_dist_print(&edge->tm.task_submission);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &edge->tm.task_submission);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
-    beta_dist_print(&edge->tm.task_result);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_TASK_RESULT, info->result, 0,
+        "Updating Edge %s capability %s TM task_result (result=%d): ",
+        edge_info_name(edge), cap->name, info->result);
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &edge->tm.task_result);
 
     if (info->result == TM_TASK_RESULT_INFO_SUCCESS)
     {
@@ -208,15 +208,15 @@ void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const
         beta_dist_add_bad(&edge->tm.task_result);
     }
 
-    beta_dist_print(&edge->tm.task_result);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &edge->tm.task_result);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
-    beta_dist_print(&cap->tm.result_quality);
-    LOG_INFO_(" -> ");
+    TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_RESULT_QUALITY, info->good, 0,
+        "Updating Edge %s capability %s TM result_quality (good=%d): ",
+        edge_info_name(edge), cap->name, info->good);
+    TM_LOG_STATE_BEFORE(beta_dist_print, beta_dist_serialise, &cap->tm.result_quality);
 
     if (info->good)
     {
@@ -227,35 +227,32 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         beta_dist_add_bad(&cap->tm.result_quality);
     }
 
-    beta_dist_print(&cap->tm.result_quality);
-    LOG_INFO_("\n");
+    TM_LOG_STATE_AFTER(beta_dist_print, beta_dist_serialise, &cap->tm.result_quality);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
 {
     if (info->direction == TM_THROUGHPUT_IN)
     {
-        LOG_INFO("Updating Edge %s capability %s TM throughput in (%" PRIu32 " bytes/tick): ",
-        edge_info_name(edge), cap->name, info->throughput);
-        gaussian_dist_print(&cap->tm.throughput_in);
-        LOG_INFO_(" -> ");
+        TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_THROUGHPUT, info->direction, info->throughput,
+            "Updating Edge %s capability %s TM throughput in (%" PRIu32 " bytes/tick): ",
+            edge_info_name(edge), cap->name, info->throughput);
+        TM_LOG_STATE_BEFORE(gaussian_dist_print, gaussian_dist_serialise, &cap->tm.throughput_in);
 
         gaussian_dist_update(&cap->tm.throughput_in, info->throughput);
 
-        gaussian_dist_print(&cap->tm.throughput_in);
-        LOG_INFO_("\n");
+        TM_LOG_STATE_AFTER(gaussian_dist_print, gaussian_dist_serialise, &cap->tm.throughput_in);
     }
     else if (info->direction == TM_THROUGHPUT_OUT)
     {
-        LOG_INFO("Updating Edge %s capability %s TM throughput out (%" PRIu32 " bytes/tick): ",
-        edge_info_name(edge), cap->name, info->throughput);
-        gaussian_dist_print(&cap->tm.throughput_out);
-        LOG_INFO_(" -> ");
+        TM_LOG_UPDATE_BEGIN(edge, cap, TRUST_METRIC_THROUGHPUT, info->direction, info->throughput,
+            "Updating Edge %s capability %s TM throughput out (%" PRIu32 " bytes/tick): ",
+            edge_info_name(edge), cap->name, info->throughput);
+        TM_LOG_STATE_BEFORE(gaussian_dist_print, gaussian_dist_serialise, &cap->tm.throughput_out);
 
         gaussian_dist_update(&cap->tm.throughput_out, info->throughput);
 
-        gaussian_dist_print(&cap->tm.throughput_out);
-        LOG_INFO_("\n");
+        TM_LOG_STATE_AFTER(gaussian_dist_print, gaussian_dist_serialise, &cap->tm.throughput_out);
     }
     else
     {
@@ -263,6 +260,16 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static void last_ping_print(const clock_time_t* last_ping)
+{
+    LOG_INFO_("%" PRIu32, (uint32_t)*last_ping);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int last_ping_serialise(nanocbor_encoder_t* enc, const clock_time_t* last_ping)
+{
+    return nanocbor_fmt_uint(enc, *last_ping);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info)
 {
     if (info->action == TM_PING_SENT)
@@ -271,13 +278,20 @@ void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info)
     }
     else if (info->action == TM_PING_RECEIVED)
     {
-        LOG_INFO("Updating Edge %s TM last ping: %" PRIu32,
-        edge_info_name(edge), edge->tm.last_ping_response);
-        LOG_INFO_(" -> ");
+        TM_LOG_UPDATE_BEGIN(edge, NULL, TRUST_METRIC_LAST_PING, info->action, 0,
+            "Updating Edge %s TM last ping: ",
+            edge_info_name(edge));
+        TM_LOG_STATE_BEFORE(last_ping_print, last_ping_serialise, &edge->tm.last_ping_response);
 
         edge->tm.last_ping_response = clock_time();
 
-        LOG_INFO_("%" PRIu32 "\n", edge->tm.last_ping_response);
+        TM_LOG_STATE_AFTER(last_ping_print, last_ping_serialise, &edge->tm.last_ping_response);
+    }
+    else if (info->action == TM_PING_TIMEOUT)
+    {
+        // Liveness is judged by the time since the last response, so there is no state to update
+        LOG_INFO("Edge %s ping timed out, last response %lu ticks ago\n",
+            edge_info_name(edge), (unsigned long)(clock_time() - edge->tm.last_ping_response));
     }
     else
     {
@@ -8,6 +8,10 @@
 #define TRUST_MODEL_NO_PEER_PROVIDED
 #define TRUST_MODEL_NO_PERIODIC_BROADCAST
 
+// Largest CBOR encoding of a state logged with TM_LOG_STATE_BEFORE and TM_LOG_STATE_AFTER
+// (the beta and gaussian distributions and the time of the last ping)
+#define TM_LOG_STATE_MAX_LEN GAUSSIAN_DIST_CBOR_MAX_LEN
+
 #ifndef APPLICATIONS_MONITOR_THROUGHPUT
 #error "Must define APPLICATIONS_MONITOR_THROUGHPUT"
 #endif
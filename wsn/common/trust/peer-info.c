@@ -2,6 +2,7 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "memb-stats.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-peer"
@@ -50,7 +51,7 @@ peer_edge_free(peer_edge_t* peer_edge)
 static peer_t*
 peer_new(void)
 {
-    peer_t* peer = memb_alloc(&peers_memb);
+    peer_t* peer = memb_stats_alloc(&peers_memb);
     if (peer == NULL)
     {
         return NULL;
@@ -86,6 +87,9 @@ void peer_info_init(void)
     memb_init(&peers_memb);
     memb_init(&peer_edges_memb);
     memb_init(&peer_capabilities_memb);
+    MEMB_STATS_REGISTER(peers_memb);
+    MEMB_STATS_REGISTER(peer_edges_memb);
+    MEMB_STATS_REGISTER(peer_capabilities_memb);
 
     list_init(peers);
 }
@@ -224,7 +228,7 @@ static peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_
             return NULL;
         }
 
-        peer_edge = memb_alloc(&peer_edges_memb);
+        peer_edge = memb_stats_alloc(&peer_edges_memb);
         if (peer_edge == NULL)
         {
             return NULL;
@@ -265,7 +269,7 @@ static peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t
             return NULL;
         }
 
-        peer_cap = memb_alloc(&peer_capabilities_memb);
+        peer_cap = memb_stats_alloc(&peer_capabilities_memb);
         if (peer_cap == NULL)
         {
             return NULL;
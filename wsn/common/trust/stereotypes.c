@@ -11,6 +11,7 @@
 #include "keystore.h"
 
 #include "nanocbor-helper.h"
+#include "memb-stats.h"
 
 #include "os/sys/log.h"
 #include "assert.h"
@@ -230,6 +231,7 @@ stereotypes_free_up_space(void)
         {
             if (edge_stereotype_remove(s))
             {
+                memb_stats_evicted(&stereotypes_memb);
                 return true;
             }
         }
@@ -258,7 +260,7 @@ bool stereotypes_request(const stereotype_tags_t* tags)
         return false;
     }
 
-    edge_stereotype_t* s = memb_alloc(&stereotypes_memb);
+    edge_stereotype_t* s = memb_stats_alloc(&stereotypes_memb);
     if (s == NULL)
     {
         LOG_WARN("Insufficient memory for stereotype, looking for candidates to free...\n");
@@ -270,7 +272,7 @@ bool stereotypes_request(const stereotype_tags_t* tags)
         }
         else
         {
-            s = memb_alloc(&stereotypes_memb);
+            s = memb_stats_alloc(&stereotypes_memb);
             if (s == NULL)
             {
                 LOG_ERR("Failed to allocate memory for stereotype\n");
@@ -341,6 +343,7 @@ static bool stereotypes_send_request(const stereotype_tags_t* tags)
 void stereotypes_init(void)
 {
     memb_init(&stereotypes_memb);
+    MEMB_STATS_REGISTER(stereotypes_memb);
     list_init(stereotypes);
     list_init(stereotypes_requesting);
 
@@ -20,6 +20,11 @@
 #include "device-classes.h"
 
 #include "nanocbor-helper.h"
+#include "prof.h"
+
+#ifdef TRUST_EDGE
+#include "capability.h"
+#endif
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-comm"
@@ -34,6 +39,10 @@ const char *topics_to_suscribe[TOPICS_TO_SUBSCRIBE_LEN] = {
     MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_UNANNOUNCE,
     MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_ADD,
     MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_REMOVE,
+#ifdef TRUST_EDGE
+    // Published by the root when a new device subscribes, so edges can publish their state sooner
+    MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_SUBSCRIBED,
+#endif
 };
 /*-------------------------------------------------------------------------------------------------------------------*/
 process_event_t pe_edge_capability_add;
@@ -124,7 +133,12 @@ process_certificate(const uint8_t* eui64, const certificate_t* cert)
 
     // We are probably going to be interacting with this edge resource,
     // so ask for its public key. If this fails we will obtain the key later.
+#ifdef KEYSTORE_LAZY_VERIFICATION
+    // The certificate will only be verified once this edge is a candidate to be chosen
+    if (!keystore_add_unverified(cert))
+#else
     if (!keystore_add(cert))
+#endif
     {
         request_public_key(&ipaddr);
     }
@@ -252,6 +266,14 @@ mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability
         NANOCBOR_CHECK(nanocbor_get_null(&arr));
     }
 
+    // Edges may also include how many tasks they have queued for this capability
+    bool has_queue_depth = !nanocbor_at_end(&arr);
+    uint16_t queue_depth = 0;
+    if (has_queue_depth)
+    {
+        NANOCBOR_CHECK(nanocbor_get_uint16(&arr, &queue_depth));
+    }
+
     edge_resource_t* edge = edge_info_find_eui64(eui64);
     if (edge == NULL)
     {
@@ -294,6 +316,11 @@ mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability
     edge_capability_t* capability = edge_info_capability_find(edge, capability_name);
     if (capability != NULL)
     {
+        if (has_queue_depth)
+        {
+            edge_capability_queue_depth(capability, queue_depth);
+        }
+
         // Do not process active capabilities we already know about
         if (edge_capability_is_active(capability))
         {
@@ -326,6 +353,11 @@ mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability
     // Mark the capability as active
     capability->flags |= EDGE_CAPABILITY_ACTIVE;
 
+    if (has_queue_depth)
+    {
+        edge_capability_queue_depth(capability, queue_depth);
+    }
+
     // We have at least one Edge resource to support this application, so we need to inform the process
     post_to_capability_process(capability, pe_edge_capability_add, edge);
 
@@ -515,12 +547,6 @@ mqtt_publish_handler(const char *topic, const char* topic_end, const uint8_t *ch
         return;
     }
 
-    // No need to add information on ourselves
-    if (is_our_eui64(eui64))
-    {
-        return;
-    }
-
     topic += MQTT_IDENTITY_LEN;
 
     if (*topic != '/')
@@ -531,6 +557,24 @@ mqtt_publish_handler(const char *topic, const char* topic_end, const uint8_t *ch
 
     topic += 1;
 
+#ifdef TRUST_EDGE
+    if (strncmp(MQTT_EDGE_ACTION_SUBSCRIBED, topic, strlen(MQTT_EDGE_ACTION_SUBSCRIBED)) == 0)
+    {
+        capability_new_subscriber();
+        return;
+    }
+#endif
+
+    // No need to add information on ourselves
+    if (is_our_eui64(eui64))
+    {
+#ifdef TRUST_EDGE
+        // But it does confirm what subscribers were told
+        capability_heard_own_publish(topic, topic_end);
+#endif
+        return;
+    }
+
     if (strncmp(MQTT_EDGE_ACTION_ANNOUNCE, topic, strlen(MQTT_EDGE_ACTION_ANNOUNCE)) == 0)
     {
         topic += strlen(MQTT_EDGE_ACTION_ANNOUNCE);
@@ -570,7 +614,7 @@ static int serialise_trust_edge_and_capabilities(nanocbor_encoder_t* enc, edge_r
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len)
+static int serialise_trust_internal(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len)
 {
     // Can provide addr to request trust on specific nodes, when NULL is provided
     // Then details on all edges are sent
@@ -611,6 +655,15 @@ int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len
     return nanocbor_encoded_len(&enc);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len)
+{
+    PROF_BEGIN(SERIALISE_TRUST);
+    const int ret = serialise_trust_internal(addr, buffer, buffer_len);
+    PROF_END(SERIALISE_TRUST);
+
+    return ret;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static int deserialise_trust_edge_and_capabilities(nanocbor_value_t* dec, peer_t* peer, edge_resource_t* edge)
 {
     nanocbor_value_t arr;
@@ -675,7 +728,7 @@ static int deserialise_trust_edge_and_capabilities(nanocbor_value_t* dec, peer_t
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_t buffer_len)
+static int process_received_trust_internal(const uip_ipaddr_t* src, const uint8_t* buffer, size_t buffer_len)
 {
     // Add or find peer
     peer_t* peer = peer_info_add(src);
@@ -741,6 +794,15 @@ int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_
     return 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_t buffer_len)
+{
+    PROF_BEGIN(PROCESS_RECEIVED_TRUST);
+    const int ret = process_received_trust_internal(src, buffer, buffer_len);
+    PROF_END(PROCESS_RECEIVED_TRUST);
+
+    return ret;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void
 trust_common_init(void)
 {
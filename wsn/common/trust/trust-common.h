@@ -17,6 +17,7 @@
 #define MQTT_EDGE_ACTION_CAPABILITY "capability"
 #define MQTT_EDGE_ACTION_CAPABILITY_ADD "add"
 #define MQTT_EDGE_ACTION_CAPABILITY_REMOVE "remove"
+#define MQTT_EDGE_ACTION_SUBSCRIBED "subscribed"
 /*-------------------------------------------------------------------------------------------------------------------*/
 void trust_common_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -2,6 +2,7 @@
 #include "os/sys/log.h"
 #include "list.h"
 #include "assert.h"
+#include "eui64.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-mods"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -89,7 +90,10 @@ trust_throughput_threshold_t* trust_throughput_thresholds_find(const char* appli
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool tm_task_submission_good(const tm_task_submission_info_t* info, bool* should_update)
 {
-    *should_update = (info->coap_request_status != COAP_REQUEST_STATUS_FINISHED);
+    // An edge that is shedding load has not misbehaved, the task will be submitted elsewhere
+    *should_update = (info->coap_request_status != COAP_REQUEST_STATUS_FINISHED) &&
+                     !(info->coap_request_status == COAP_REQUEST_STATUS_RESPONSE &&
+                       info->coap_status == SERVICE_UNAVAILABLE_5_03);
 
     // Good if this was a response with a valid status code
     return info->coap_request_status == COAP_REQUEST_STATUS_RESPONSE &&
@@ -141,6 +145,35 @@ bool tm_challenge_response_good(const tm_challenge_response_info_t* info, bool*
     return good;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef EVENT_LOG_ENABLED
+nanocbor_encoder_t* tm_event_log_begin(const edge_resource_t* edge, const edge_capability_t* cap,
+                                       uint16_t metric, int32_t obs1, int32_t obs2)
+{
+    nanocbor_encoder_t* enc = event_log_begin(EVENT_LOG_TM_UPDATE, 7);
+
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(&edge->ep.ipaddr, eui64);
+    nanocbor_put_bstr(enc, eui64, sizeof(eui64));
+
+    if (cap != NULL)
+    {
+        nanocbor_put_tstr(enc, cap->name);
+    }
+    else
+    {
+        nanocbor_fmt_null(enc);
+    }
+
+    nanocbor_fmt_uint(enc, metric);
+    nanocbor_fmt_int(enc, obs1);
+    nanocbor_fmt_int(enc, obs2);
+
+    // The state before and after the update are written by the trust model
+
+    return enc;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 __attribute__((__weak__)) void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
 }
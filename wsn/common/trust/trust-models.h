@@ -7,6 +7,8 @@
 
 #include "coap-constants.h"
 #include "coap-request-state.h"
+
+#include "event-log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
     uint16_t id;
@@ -57,6 +59,7 @@ trust_throughput_threshold_t* trust_throughput_thresholds_find(const char* appli
 #define TRUST_METRIC_TASK_RESULT      1002
 #define TRUST_METRIC_ANNOUNCE         1003
 #define TRUST_METRIC_CHALLENGE_RESP   1004
+#define TRUST_METRIC_LAST_PING        1005
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Edge capability metrics
 #define TRUST_METRIC_RESULT_QUALITY   2001
@@ -139,7 +142,8 @@ typedef struct {
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef enum {
     TM_PING_SENT = 1,
-    TM_PING_RECEIVED = 2
+    TM_PING_RECEIVED = 2,
+    TM_PING_TIMEOUT = 3
 } tm_edge_ping_action_t;
 
 typedef struct {
@@ -159,3 +163,26 @@ void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info);
 bool tm_task_submission_good(const tm_task_submission_info_t* info, bool* should_update);
 bool tm_challenge_response_good(const tm_challenge_response_info_t* info, bool* should_update);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Log an update to a trust model's state. The state is logged before and after the update
+// using print (as text) or serialise (as a binary event when EVENT_LOG_ENABLED is set).
+// With text logging the format and arguments are logged at LOG_LEVEL_INFO of the caller's module.
+// Both print and serialise are referenced in either mode, so neither is left unused.
+#ifdef EVENT_LOG_ENABLED
+nanocbor_encoder_t* tm_event_log_begin(const edge_resource_t* edge, const edge_capability_t* cap,
+                                       uint16_t metric, int32_t obs1, int32_t obs2);
+
+#define TM_LOG_UPDATE_BEGIN(edge, cap, metric, obs1, obs2, ...) \
+    nanocbor_encoder_t* tm_log_enc = tm_event_log_begin(edge, cap, metric, obs1, obs2)
+#define TM_LOG_STATE_BEFORE(print, serialise, state) \
+    do { (void)print; serialise(tm_log_enc, state); } while (0)
+#define TM_LOG_STATE_AFTER(print, serialise, state) \
+    do { (void)print; serialise(tm_log_enc, state); event_log_end(tm_log_enc); } while (0)
+#else
+#define TM_LOG_UPDATE_BEGIN(edge, cap, metric, obs1, obs2, ...) \
+    LOG_INFO(__VA_ARGS__)
+#define TM_LOG_STATE_BEFORE(print, serialise, state) \
+    do { (void)serialise; print(state); LOG_INFO_(" -> "); } while (0)
+#define TM_LOG_STATE_AFTER(print, serialise, state) \
+    do { (void)serialise; print(state); LOG_INFO_("\n"); } while (0)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
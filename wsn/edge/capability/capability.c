@@ -12,6 +12,7 @@
 #include "nanocbor-helper.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "applications.h"
 #include "trust-common.h"
@@ -19,6 +20,8 @@
 #include "keys.h"
 #include "stereotype-tags.h"
 #include "certificate.h"
+#include "timer-wheel.h"
+#include "os/lib/random.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -32,20 +35,58 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 static char pub_topic[MAX_PUBLISH_TOPIC_LEN];
 /*-------------------------------------------------------------------------------------------------------------------*/
-#define PUBLISH_ANNOUNCE_PERIOD_SHORT   (CLOCK_SECOND * 30)
-#define PUBLISH_ANNOUNCE_PERIOD_LONG    (PUBLISH_ANNOUNCE_PERIOD_SHORT * 2 * 15)
-#define PUBLISH_CAPABILITY_PERIOD_SHORT (CLOCK_SECOND * 5)
-#define PUBLISH_CAPABILITY_PERIOD_LONG  (PUBLISH_CAPABILITY_PERIOD_SHORT * (APPLICATION_NUM + 20))
-#define PUBLISH_ANNOUNCE_SHORT_TO_LONG 3
+// Announces and capabilities are published on Trickle (RFC 6206) style schedules.
+// The interval starts at IMIN when something changes and doubles up to IMAX while nothing does.
+#ifndef PUBLISH_ANNOUNCE_IMIN
+#define PUBLISH_ANNOUNCE_IMIN           (CLOCK_SECOND * 30)
+#endif
+#ifndef PUBLISH_ANNOUNCE_IMAX
+#define PUBLISH_ANNOUNCE_IMAX           (PUBLISH_ANNOUNCE_IMIN * 2 * 15)
+#endif
+#ifndef PUBLISH_CAPABILITY_IMIN
+#define PUBLISH_CAPABILITY_IMIN         (CLOCK_SECOND * 5)
+#endif
+#ifndef PUBLISH_CAPABILITY_IMAX
+#define PUBLISH_CAPABILITY_IMAX         (PUBLISH_CAPABILITY_IMIN * (APPLICATION_NUM + 20))
+#endif
+
+// The Trickle redundancy constant (k), a publish is skipped when this many consistent
+// copies have been echoed back by the root earlier in the same interval
+#ifndef PUBLISH_TRICKLE_REDUNDANCY
+#define PUBLISH_TRICKLE_REDUNDANCY 1
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-PROCESS(capability, "Announce and Capability process");
+typedef struct publish_trickle
+{
+    wheel_timer_t timer;
+
+    clock_time_t imin, imax;
+    clock_time_t interval;
+
+    // Time left in the interval after publishing
+    clock_time_t remaining;
+
+    bool (*publish)(uint8_t idx);
+    uint8_t idx;
+
+    // Consistent echoes heard in this interval (the Trickle counter c)
+    uint8_t heard;
+
+    // Did the publish in this interval succeed (or was not needed)
+    bool published;
+
+    bool at_end;
+    bool running;
+
+} publish_trickle_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
-static struct etimer publish_announce_timer;
-static struct etimer publish_capability_timer;
+PROCESS(capability, "Announce and Capability process");
 /*-------------------------------------------------------------------------------------------------------------------*/
-static uint8_t announce_short_count;
+static publish_trickle_t announce_trickle;
+static publish_trickle_t capability_trickles[APPLICATION_NUM];
 /*-------------------------------------------------------------------------------------------------------------------*/
-static uint8_t application_capability_publish_idx;
+// Has an announce been published since the resource rich edge started
+static bool announced;
 /*-------------------------------------------------------------------------------------------------------------------*/
 static bool
 get_global_address(uip_ip6addr_t* addr)
@@ -137,12 +178,12 @@ publish_add_capability(const char* name, bool include_certificate)
         return false;
     }
 
-    uint8_t cbor_buffer[(1) + (1) + CERTIFICATE_CBOR_LENGTH];
+    uint8_t cbor_buffer[(1) + (1) + CERTIFICATE_CBOR_LENGTH + (1 + 2)];
 
     nanocbor_encoder_t enc;
     nanocbor_encoder_init(&enc, cbor_buffer, sizeof(cbor_buffer));
 
-    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 2));
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 3));
     NANOCBOR_CHECK(nanocbor_fmt_bool(&enc, include_certificate));
 
     if (include_certificate)
@@ -154,6 +195,9 @@ publish_add_capability(const char* name, bool include_certificate)
         NANOCBOR_CHECK(nanocbor_fmt_null(&enc));
     }
 
+    // Let nodes know how busy this application is, so they can avoid overloading it
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, application_queue_depth(name)));
+
     LOG_DBG("Publishing add [topic=%s, datalen=%d]\n", pub_topic, nanocbor_encoded_len(&enc));
 
     assert(nanocbor_encoded_len(&enc) <= sizeof(cbor_buffer));
@@ -198,40 +242,250 @@ publish_remove_capability(const char* name, bool include_certificate)
     return mqtt_over_coap_publish(pub_topic, cbor_buffer, nanocbor_encoded_len(&enc));
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_timer_callback(void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_start_interval(publish_trickle_t* t)
+{
+    // Publish at a random point in the second half of the interval, so edges do not publish in lock step
+    const clock_time_t half = t->interval / 2;
+    const clock_time_t at = half + (clock_time_t)(((uint32_t)half * random_rand()) / RANDOM_RAND_MAX);
+
+    t->remaining = t->interval - at;
+    t->at_end = false;
+    t->heard = 0;
+    t->published = false;
+
+    // Might be called outside of the capability context, the callback needs to run in it
+    PROCESS_CONTEXT_BEGIN(&capability);
+    wheel_timer_set(&t->timer, at, trickle_timer_callback, t);
+    PROCESS_CONTEXT_END(&capability);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_reset(publish_trickle_t* t)
+{
+    if (t->running && t->interval == t->imin)
+    {
+        return;
+    }
+
+    t->running = true;
+    t->interval = t->imin;
+
+    trickle_start_interval(t);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_stop(publish_trickle_t* t)
+{
+    t->running = false;
+    wheel_timer_stop(&t->timer);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_timer_callback(void* ptr)
+{
+    publish_trickle_t* t = (publish_trickle_t*)ptr;
+
+    if (!t->at_end)
+    {
+        if (t->heard >= PUBLISH_TRICKLE_REDUNDANCY)
+        {
+            LOG_DBG("Suppressing redundant publish (idx=%" PRIu8 ", heard=%" PRIu8 ", interval=%lu)\n",
+                t->idx, t->heard, (unsigned long)t->interval);
+
+            t->published = true;
+        }
+        else
+        {
+            t->published = t->publish(t->idx);
+        }
+
+        // t->publish may have stopped this trickle
+        if (t->running)
+        {
+            t->at_end = true;
+            wheel_timer_set(&t->timer, t->remaining, trickle_timer_callback, t);
+        }
+    }
+    else
+    {
+        if (t->published)
+        {
+            // Consistent for a whole interval, so back off
+            t->interval = (t->interval >= t->imax / 2) ? t->imax : t->interval * 2;
+        }
+        else
+        {
+            // Subscribers have not been told the current state, so try again soon
+            LOG_DBG("Publish failed (idx=%" PRIu8 "), restarting from the minimum interval\n", t->idx);
+            t->interval = t->imin;
+        }
+
+        trickle_start_interval(t);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trickle_init(publish_trickle_t* t, clock_time_t imin, clock_time_t imax, bool (*publish)(uint8_t), uint8_t idx)
+{
+    t->imin = imin;
+    t->imax = imax;
+    t->interval = imin;
+    t->heard = 0;
+    t->published = false;
+    t->running = false;
+    t->publish = publish;
+    t->idx = idx;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+capability_trickles_reset(void)
+{
+    for (uint8_t i = 0; i != APPLICATION_NUM; ++i)
+    {
+        trickle_reset(&capability_trickles[i]);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+capability_trickles_stop(void)
+{
+    for (uint8_t i = 0; i != APPLICATION_NUM; ++i)
+    {
+        trickle_stop(&capability_trickles[i]);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void
 trigger_faster_publish(void)
 {
-    clock_time_t remaining;
-
     LOG_INFO("Triggering a faster publish of announce\n");
 
-    remaining = timer_remaining(&publish_announce_timer.timer);
-    if (remaining > PUBLISH_ANNOUNCE_PERIOD_SHORT)
+    trickle_reset(&announce_trickle);
+
+    // Capabilities are published again once the announce has been
+    announced = false;
+    capability_trickles_stop();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+trigger_faster_capability_publish(uint8_t idx)
+{
+    if (idx >= APPLICATION_NUM)
     {
-        LOG_DBG("publish_announce_timer: Resetting timer = %d\n", PUBLISH_ANNOUNCE_PERIOD_SHORT);
+        return;
+    }
 
-        // This function might be called outside of the capability context
-        // so we need to ensure that the publish_announce_timer will be linked to the capability process
-        PROCESS_CONTEXT_BEGIN(&capability);
-        etimer_reset_with_new_interval(&publish_announce_timer, PUBLISH_ANNOUNCE_PERIOD_SHORT);
-        PROCESS_CONTEXT_END(&capability);
+    // Capabilities are only published while we are announced
+    if (!resource_rich_edge_started || !announced)
+    {
+        return;
     }
-    else
+
+    LOG_INFO("Triggering a faster publish of capability %s\n", application_names[idx]);
+
+    trickle_reset(&capability_trickles[idx]);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+capability_new_subscriber(void)
+{
+    LOG_INFO("New subscriber, triggering a faster publish\n");
+
+    trickle_reset(&announce_trickle);
+
+    if (resource_rich_edge_started && announced)
     {
-        LOG_DBG("publish_announce_timer: no need to reset, time remaining = %" PRIu32 " <= %d\n",
-            remaining, PUBLISH_ANNOUNCE_PERIOD_SHORT);
+        capability_trickles_reset();
     }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+action_matches(const char* action, const char* action_end, const char* expected)
+{
+    const size_t len = strlen(expected);
 
-    announce_short_count = 0;
+    return (size_t)(action_end - action) == len && strncmp(action, expected, len) == 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+capability_heard_own_publish(const char* action, const char* action_end)
+{
+    publish_trickle_t* t = NULL;
+    bool consistent = false;
+
+    if (action_matches(action, action_end, MQTT_EDGE_ACTION_ANNOUNCE))
+    {
+        t = &announce_trickle;
+        consistent = resource_rich_edge_started;
+    }
+    else if (action_matches(action, action_end, MQTT_EDGE_ACTION_UNANNOUNCE))
+    {
+        t = &announce_trickle;
+        consistent = !resource_rich_edge_started;
+    }
+    else if (strncmp(action, MQTT_EDGE_ACTION_CAPABILITY "/", strlen(MQTT_EDGE_ACTION_CAPABILITY "/")) == 0)
+    {
+        // Format is capability/<name>/<add|remove>
+        const char* name = action + strlen(MQTT_EDGE_ACTION_CAPABILITY "/");
+        const char* name_end = memchr(name, '/', action_end - name);
+        if (name_end == NULL)
+        {
+            return;
+        }
 
-    // Restart capability publishing from 1st capability
-    application_capability_publish_idx = 0;
+        for (uint8_t i = 0; i != APPLICATION_NUM; ++i)
+        {
+            if (strlen(application_names[i]) == (size_t)(name_end - name) &&
+                strncmp(application_names[i], name, name_end - name) == 0)
+            {
+                t = &capability_trickles[i];
+
+                if (action_matches(name_end + 1, action_end, MQTT_EDGE_ACTION_CAPABILITY_ADD))
+                {
+                    consistent = applications_available[i];
+                }
+                else if (action_matches(name_end + 1, action_end, MQTT_EDGE_ACTION_CAPABILITY_REMOVE))
+                {
+                    consistent = !applications_available[i];
+                }
+                else
+                {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    if (t == NULL || !t->running)
+    {
+        return;
+    }
 
-    etimer_stop(&publish_capability_timer);
+    // As in RFC 6206 the counter is cleared when each interval starts, so the echo of our own
+    // publish (which arrives after it was sent) does not suppress the publish in the next interval.
+    if (consistent)
+    {
+        if (t->heard != UINT8_MAX)
+        {
+            t->heard += 1;
+        }
+    }
+    else
+    {
+        // Subscribers were just told something out of date
+        LOG_INFO("Root echoed an out of date publish (%.*s), triggering a faster publish\n",
+            (int)(action_end - action), action);
+        trickle_reset(t);
+    }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static void
-periodic_publish_announce(void)
+static bool
+trickle_publish_announce(uint8_t idx)
 {
     bool ret;
     if (resource_rich_edge_started)
@@ -248,61 +502,43 @@ periodic_publish_announce(void)
     if (!ret)
     {
         LOG_ERR("Failed to publish (un)announce\n");
-    }
-    else
-    {
-        if (resource_rich_edge_started)
-        {
-            // Don't send capabilities until we have announced ourselves
-            LOG_DBG("Announce sent! Starting capability publish timer.\n");
-            etimer_set(&publish_capability_timer, PUBLISH_CAPABILITY_PERIOD_SHORT);
-        }
-        else
-        {
-            // Don't publish capabilities, if nothing connected
-            LOG_DBG("Unannounce sent! Stopping capability publish timer.\n");
-            etimer_stop(&publish_capability_timer);
-        }
+        return false;
     }
 
-    // If on the short interval, might need to transition to the long interval
-    if (publish_announce_timer.timer.interval <= PUBLISH_ANNOUNCE_PERIOD_SHORT)
+    if (resource_rich_edge_started)
     {
-        // Only increment short count, if we managed to successfully publish the announce
-        if (ret)
-        {
-            announce_short_count += 1;
-        }
-
-        if (announce_short_count >= PUBLISH_ANNOUNCE_SHORT_TO_LONG)
-        {
-            LOG_DBG("Moving to less frequent announce intervals\n");
-            etimer_reset_with_new_interval(&publish_announce_timer, PUBLISH_ANNOUNCE_PERIOD_LONG);
-        }
-        else
+        // Don't send capabilities until we have announced ourselves
+        if (!announced)
         {
-            etimer_reset(&publish_announce_timer);
+            LOG_DBG("Announce sent! Starting capability publishes.\n");
+            announced = true;
+            capability_trickles_reset();
         }
     }
     else
     {
-        etimer_reset(&publish_announce_timer);
+        // Don't publish capabilities, if nothing connected
+        LOG_DBG("Unannounce sent! Stopping capability publishes.\n");
+        announced = false;
+        capability_trickles_stop();
     }
+
+    return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static void
-periodic_publish_capability(void)
+static bool
+trickle_publish_capability(uint8_t idx)
 {
     // The current application we need to publish information about
-    const char* application_name = application_names[application_capability_publish_idx];
+    const char* application_name = application_names[idx];
 
-    LOG_DBG("Attempting to publish capability for %s at %" PRIu8 "\n", application_name, application_capability_publish_idx);
+    LOG_DBG("Attempting to publish capability for %s at %" PRIu8 "\n", application_name, idx);
 
     bool ret;
 
     // Check if it is available
     // Do not include the certificate in these messages as they are intended to be lightweight and periodic
-    if (applications_available[application_capability_publish_idx])
+    if (applications_available[idx])
     {
         ret = publish_add_capability(application_name, false);
     }
@@ -311,25 +547,12 @@ periodic_publish_capability(void)
         ret = publish_remove_capability(application_name, false);
     }
 
-    // Move onto next capability if we succeeded in publishing this one
-    if (ret)
-    {
-        application_capability_publish_idx += 1;
-    }
-    else
+    if (!ret)
     {
         LOG_ERR("Capability publish failed\n");
     }
 
-    if (application_capability_publish_idx == APPLICATION_NUM)
-    {
-        etimer_reset_with_new_interval(&publish_capability_timer, PUBLISH_CAPABILITY_PERIOD_LONG);
-        application_capability_publish_idx = 0;
-    }
-    else
-    {
-        etimer_reset_with_new_interval(&publish_capability_timer, PUBLISH_CAPABILITY_PERIOD_SHORT);
-    }
+    return ret;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static bool
@@ -351,12 +574,18 @@ init(void)
 
     trust_common_init();
 
-    announce_short_count = 0;
+    announced = false;
 
-    application_capability_publish_idx = 0;
+    trickle_init(&announce_trickle, PUBLISH_ANNOUNCE_IMIN, PUBLISH_ANNOUNCE_IMAX, trickle_publish_announce, 0);
+
+    for (uint8_t i = 0; i != APPLICATION_NUM; ++i)
+    {
+        trickle_init(&capability_trickles[i], PUBLISH_CAPABILITY_IMIN, PUBLISH_CAPABILITY_IMAX,
+                     trickle_publish_capability, i);
+    }
 
-    // Start timer for periodic announce
-    etimer_set(&publish_announce_timer, PUBLISH_ANNOUNCE_PERIOD_SHORT);
+    // Start periodic announce
+    trickle_reset(&announce_trickle);
 
     return true;
 }
@@ -373,15 +602,8 @@ PROCESS_THREAD(capability, ev, data)
 
     while (1)
     {
+        // Publishes are driven by the trickle timer callbacks
         PROCESS_YIELD();
-
-        if (ev == PROCESS_EVENT_TIMER && data == &publish_announce_timer) {
-          periodic_publish_announce();
-        }
-
-        if (ev == PROCESS_EVENT_TIMER && data == &publish_capability_timer) {
-          periodic_publish_capability();
-        }
     }
 
     PROCESS_END();
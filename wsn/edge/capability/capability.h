@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool
@@ -19,3 +20,15 @@ publish_remove_capability(const char* name, bool include_certificate);
 void
 trigger_faster_publish(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The capability of the application at this index has started or stopped
+void
+trigger_faster_capability_publish(uint8_t idx);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The root has told us a new device subscribed, so it needs to hear our state soon
+void
+capability_new_subscriber(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The root echoed back one of our publishes, action is the topic after our identity
+void
+capability_heard_own_publish(const char* action, const char* action_end);
+/*-------------------------------------------------------------------------------------------------------------------*/
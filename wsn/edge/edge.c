@@ -9,7 +9,11 @@
 #include "serial-helpers.h"
 #include "stereotype-tags.h"
 #include "timed-unlock.h"
+#include "timer-wheel.h"
 #include "root-endpoint.h"
+#include "memb-stats.h"
+#include "prof.h"
+#include "event-log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "edge"
 #define LOG_LEVEL LOG_LEVEL_DBG
@@ -31,6 +35,14 @@ const char* const application_names[APPLICATION_NUM] = APPLICATION_NAMES;
 bool applications_available[APPLICATION_NUM];
 bool resource_rich_edge_started;
 /*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct application_queue
+{
+    uint16_t depth;
+    clock_time_t last_progress;
+} application_queue_t;
+
+static application_queue_t application_queues[APPLICATION_NUM];
+/*-------------------------------------------------------------------------------------------------------------------*/
 AUTOSTART_PROCESSES(&edge, &capability, &mqtt_client_process,
                     &keystore_add_verifier,
 #if defined(ATTACK_PROCESSES)
@@ -61,6 +73,65 @@ static void
 set_all_applications_unavailable(void)
 {
     memset(applications_available, 0, sizeof(applications_available));
+
+    // Any tasks queued on the resource rich node will not be completed
+    memset(application_queues, 0, sizeof(application_queues));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool application_queue_admit(const char* name)
+{
+    int8_t idx = index_of_application(name);
+    if (idx < 0)
+    {
+        return false;
+    }
+
+    application_queue_t* queue = &application_queues[idx];
+
+    if (queue->depth >= EDGE_APPLICATION_MAX_QUEUE_DEPTH)
+    {
+        if (clock_time() - queue->last_progress < EDGE_APPLICATION_QUEUE_STALE)
+        {
+            LOG_WARN("Rejecting %s task as %" PRIu16 " tasks are queued\n", name, queue->depth);
+            return false;
+        }
+
+        LOG_WARN("No %s tasks acknowledged recently, assuming %" PRIu16 " queued tasks were lost\n", name, queue->depth);
+        queue->depth = 0;
+    }
+
+    if (queue->depth == 0)
+    {
+        queue->last_progress = clock_time();
+    }
+
+    queue->depth += 1;
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void application_queue_task_finished(const char* name)
+{
+    int8_t idx = index_of_application(name);
+    if (idx < 0)
+    {
+        return;
+    }
+
+    application_queue_t* queue = &application_queues[idx];
+
+    if (queue->depth > 0)
+    {
+        queue->depth -= 1;
+    }
+
+    queue->last_progress = clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t application_queue_depth(const char* name)
+{
+    int8_t idx = index_of_application(name);
+    return idx < 0 ? 0 : application_queues[idx].depth;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
@@ -103,9 +174,11 @@ process_application_serial_message(const char* data, const char* data_end)
     if (match_action(data, data_end, APPLICATION_SERIAL_START))
     {
         applications_available[idx] = true;
+        application_queues[idx].depth = 0;
 
         LOG_INFO("publishing add capability\n");
         publish_add_capability(application_name, true);
+        trigger_faster_capability_publish(idx);
 
         // No need to trigger a faster publish of the announce here
         // as we will send the certificate with the add capability
@@ -113,9 +186,11 @@ process_application_serial_message(const char* data, const char* data_end)
     else if (match_action(data, data_end, APPLICATION_SERIAL_STOP))
     {
         applications_available[idx] = false;
+        application_queues[idx].depth = 0;
 
         LOG_INFO("publishing remove capability\n");
         publish_remove_capability(application_name, true);
+        trigger_faster_capability_publish(idx);
     }
     else if (match_action(data, data_end, APPLICATION_SERIAL_APP))
     {
@@ -197,6 +272,14 @@ process_serial_message(const char* data)
         data += strlen(EDGE_SERIAL_PREFIX);
         process_edge_serial_message(data, data_end);
     }
+    else if (match_action(data, data_end, MEMB_STATS_SERIAL_COMMAND))
+    {
+        // Handled by memb_stats_process
+    }
+    else if (match_action(data, data_end, PROF_SERIAL_COMMAND))
+    {
+        // Handled by prof_process
+    }
     else
     {
         LOG_ERR("Unknown serial message: '%s'\n", data);
@@ -216,8 +299,12 @@ PROCESS_THREAD(edge, ev, data)
     LOG_INFO("Built with ADDITIONAL_CFLAGS = '" ADDITIONAL_CFLAGS "'\n");
 #endif
 
+    timer_wheel_init();
     timed_unlock_global_init();
     root_endpoint_init();
+    memb_stats_init();
+    prof_init();
+    event_log_init();
 
     set_all_applications_unavailable();
 
@@ -13,3 +13,23 @@ extern process_event_t pe_data_from_resource_rich_node;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool application_available(const char* name);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Admission control for tasks forwarded to the resource rich node.
+// A task is queued until the resource rich node acknowledges it by sending updated stats.
+#ifndef EDGE_APPLICATION_MAX_QUEUE_DEPTH
+#define EDGE_APPLICATION_MAX_QUEUE_DEPTH 4
+#endif
+
+// How long (in seconds) nodes are told to wait before submitting again when a task is rejected
+#ifndef EDGE_APPLICATION_OVERLOADED_MAX_AGE
+#define EDGE_APPLICATION_OVERLOADED_MAX_AGE 5
+#endif
+
+// If no queued task has been acknowledged in this long, assume the resource rich node dropped them
+#ifndef EDGE_APPLICATION_QUEUE_STALE
+#define EDGE_APPLICATION_QUEUE_STALE (120 * CLOCK_SECOND)
+#endif
+
+bool application_queue_admit(const char* name);
+void application_queue_task_finished(const char* name);
+uint16_t application_queue_depth(const char* name);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -19,6 +19,9 @@
 
 #define COAP_MAX_CHUNK_SIZE 256
 
+// Large enough for the capability publishes that include a certificate
+#define SCRATCH_SIZE COAP_MAX_CHUNK_SIZE
+
 // Enable coloured log prefix
 #define LOG_CONF_WITH_COLOR 1
 
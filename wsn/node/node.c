@@ -2,7 +2,11 @@
 #include "sys/log.h"
 
 #include "timed-unlock.h"
+#include "timer-wheel.h"
 #include "root-endpoint.h"
+#include "memb-stats.h"
+#include "prof.h"
+#include "event-log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "node"
 #define LOG_LEVEL LOG_LEVEL_DBG
@@ -10,11 +14,12 @@
 PROCESS_NAME(mqtt_client_process);
 PROCESS_NAME(trust_model);
 PROCESS_NAME(keystore_add_verifier);
+PROCESS_NAME(offload_scheduler);
 APPLICATION_PROCESSES_DECL;
 PROCESS(node, "node");
 /*-------------------------------------------------------------------------------------------------------------------*/
 AUTOSTART_PROCESSES(&node, &trust_model, &mqtt_client_process,
-                    &keystore_add_verifier,
+                    &keystore_add_verifier, &offload_scheduler,
                     APPLICATION_PROCESSES);
 /*-------------------------------------------------------------------------------------------------------------------*/
 PROCESS_THREAD(node, ev, data)
@@ -28,8 +33,12 @@ PROCESS_THREAD(node, ev, data)
     LOG_INFO("Built with ADDITIONAL_CFLAGS = '" ADDITIONAL_CFLAGS "'\n");
 #endif
 
+    timer_wheel_init();
     timed_unlock_global_init();
     root_endpoint_init();
+    memb_stats_init();
+    prof_init();
+    event_log_init();
 
     PROCESS_END();
 }
@@ -6,6 +6,7 @@
 #include "contiki.h"
 #include "os/sys/log.h"
 #include "os/lib/memb.h"
+#include "memb-stats.h"
 #include "os/lib/json/jsonparse.h"
 #include "os/net/ipv6/uiplib.h"
 
@@ -24,6 +25,7 @@
 #include "applications.h"
 #include "trust-common.h"
 #include "crypto-support.h"
+#include "timer-wheel.h"
 #include "keystore.h"
 #include "keystore-oscore.h"
 
@@ -51,7 +53,7 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
 #define TRUST_POLL_PERIOD (2 * 60 * CLOCK_SECOND)
-static struct etimer periodic_timer;
+static wheel_timer_t periodic_timer;
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Number of seconds to ask for client to retry after.
@@ -60,6 +62,28 @@ static struct etimer periodic_timer;
 #define ASK_RETRY_AFTER_MEMORY_ALLOCATION_FAIL (2 * 60)
 #define ASK_RETRY_AFTER_QUEUE_FAIL (2 * 60)
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Rate limiting of received trust information.
+// Each peer has a token bucket, so one neighbour flooding us cannot
+// use up the rx memory and verification queue for other neighbours.
+// There is also a global budget on the number of verifications we perform.
+#ifndef TRUST_RX_PEER_BUCKETS
+#define TRUST_RX_PEER_BUCKETS 8
+#endif
+#ifndef TRUST_RX_PEER_BURST
+#define TRUST_RX_PEER_BURST 2
+#endif
+#ifndef TRUST_RX_PEER_TOKEN_PERIOD
+#define TRUST_RX_PEER_TOKEN_PERIOD (30 * CLOCK_SECOND)
+#endif
+#ifndef TRUST_RX_VERIFY_BURST
+#define TRUST_RX_VERIFY_BURST 3
+#endif
+#ifndef TRUST_RX_VERIFY_PER_SECOND
+#define TRUST_RX_VERIFY_PER_SECOND 1
+#endif
+#define TRUST_RX_VERIFY_TOKEN_PERIOD (CLOCK_SECOND / TRUST_RX_VERIFY_PER_SECOND)
+_Static_assert(TRUST_RX_VERIFY_TOKEN_PERIOD > 0, "TRUST_RX_VERIFY_PER_SECOND too large");
+/*-------------------------------------------------------------------------------------------------------------------*/
 PROCESS(trust_model, "Trust Model process");
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct trust_tx_item
@@ -80,6 +104,111 @@ typedef struct trust_rx_item
 
 MEMB(trust_rx_memb, trust_rx_item_t, TRUST_RX_SIZE);
 /*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct token_bucket
+{
+    uint8_t tokens;
+    clock_time_t last_refill;
+} token_bucket_t;
+
+typedef struct trust_rx_peer
+{
+    uip_ipaddr_t addr;
+    token_bucket_t bucket;
+    bool in_use;
+} trust_rx_peer_t;
+
+static trust_rx_peer_t trust_rx_peers[TRUST_RX_PEER_BUCKETS];
+static token_bucket_t trust_rx_verify_bucket;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+token_bucket_init(token_bucket_t* bucket, uint8_t burst)
+{
+    bucket->tokens = burst;
+    bucket->last_refill = clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+token_bucket_refill(token_bucket_t* bucket, uint8_t burst, clock_time_t period)
+{
+    const clock_time_t now = clock_time();
+    const clock_time_t elapsed = now - bucket->last_refill;
+    const clock_time_t new_tokens = elapsed / period;
+
+    if (new_tokens == 0)
+    {
+        return;
+    }
+
+    if (bucket->tokens + new_tokens >= burst)
+    {
+        bucket->tokens = burst;
+        bucket->last_refill = now;
+    }
+    else
+    {
+        bucket->tokens += new_tokens;
+        // Keep the remainder, so partial periods are not lost
+        bucket->last_refill += new_tokens * period;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Number of seconds until the bucket will have a token again
+static uint32_t
+token_bucket_retry_after(const token_bucket_t* bucket, clock_time_t period)
+{
+    const clock_time_t elapsed = clock_time() - bucket->last_refill;
+    const clock_time_t remaining = elapsed < period ? period - elapsed : 0;
+
+    return (remaining + CLOCK_SECOND - 1) / CLOCK_SECOND;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static trust_rx_peer_t*
+trust_rx_peer_find_or_add(const uip_ipaddr_t* addr)
+{
+    trust_rx_peer_t* replace = NULL;
+
+    for (size_t i = 0; i != TRUST_RX_PEER_BUCKETS; ++i)
+    {
+        trust_rx_peer_t* peer = &trust_rx_peers[i];
+
+        if (!peer->in_use)
+        {
+            if (replace == NULL)
+            {
+                replace = peer;
+            }
+            continue;
+        }
+
+        token_bucket_refill(&peer->bucket, TRUST_RX_PEER_BURST, TRUST_RX_PEER_TOKEN_PERIOD);
+
+        if (uip_ipaddr_cmp(&peer->addr, addr))
+        {
+            return peer;
+        }
+
+        // A peer with a full bucket has been quiet, so can be replaced without
+        // giving it any more tokens than it would have had.
+        // Peers with partially used buckets are never replaced, otherwise a
+        // flood from many source addresses could be used to reset their buckets.
+        if (replace == NULL && peer->bucket.tokens >= TRUST_RX_PEER_BURST)
+        {
+            replace = peer;
+        }
+    }
+
+    if (replace == NULL)
+    {
+        return NULL;
+    }
+
+    uip_ipaddr_copy(&replace->addr, addr);
+    token_bucket_init(&replace->bucket, TRUST_RX_PEER_BURST);
+    replace->in_use = true;
+
+    return replace;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 res_trust_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
 
@@ -99,7 +228,7 @@ res_trust_get_handler(coap_message_t *request, coap_message_t *response, uint8_t
     // Received a request for our trust information, need to respond to the requester
     LOG_DBG("Generating trust info packet in response to a GET\n");
 
-    trust_tx_item_t* item = memb_alloc(&trust_tx_memb);
+    trust_tx_item_t* item = memb_stats_alloc(&trust_tx_memb);
     if (!item)
     {
         LOG_WARN("Cannot allocate memory for trust request\n");
@@ -177,6 +306,28 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
         return;
     }
 
+    // Rate limit each peer before doing any work for them
+    trust_rx_peer_t* peer = trust_rx_peer_find_or_add(&request->src_ep->ipaddr);
+    if (peer == NULL)
+    {
+        LOG_WARN("res_trust_post_handler: no free rate limit bucket (mid=%"PRIu16")\n", request->mid);
+        coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+        coap_set_header_max_age(response, TRUST_RX_PEER_TOKEN_PERIOD / CLOCK_SECOND);
+        return;
+    }
+
+    if (peer->bucket.tokens == 0)
+    {
+        LOG_WARN("res_trust_post_handler: rate limited ");
+        LOG_WARN_COAP_EP(request->src_ep);
+        LOG_WARN_(" (mid=%"PRIu16")\n", request->mid);
+        coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+        coap_set_header_max_age(response, token_bucket_retry_after(&peer->bucket, TRUST_RX_PEER_TOKEN_PERIOD));
+        return;
+    }
+
+    peer->bucket.tokens -= 1;
+
     public_key_item_t* key = keystore_find_addr(&request->src_ep->ipaddr);
     if (key == NULL)
     {
@@ -189,8 +340,18 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
     }
     else
     {
+        // Limit the number of verifications we perform across all peers
+        token_bucket_refill(&trust_rx_verify_bucket, TRUST_RX_VERIFY_BURST, TRUST_RX_VERIFY_TOKEN_PERIOD);
+        if (trust_rx_verify_bucket.tokens == 0)
+        {
+            LOG_WARN("res_trust_post_handler: verification budget exhausted (mid=%"PRIu16")\n", request->mid);
+            coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+            coap_set_header_max_age(response, token_bucket_retry_after(&trust_rx_verify_bucket, TRUST_RX_VERIFY_TOKEN_PERIOD));
+            return;
+        }
+
         LOG_DBG("Have public key, adding to queue to be verified (mid=%"PRIu16")\n", request->mid);
-        trust_rx_item_t* item = memb_alloc(&trust_rx_memb);
+        trust_rx_item_t* item = memb_stats_alloc(&trust_rx_memb);
         if (!item)
         {
             LOG_ERR("res_trust_post_handler: out of memory (mid=%"PRIu16")\n", request->mid);
@@ -203,6 +364,8 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
             return;
         }
 
+        trust_rx_verify_bucket.tokens -= 1;
+
         item->key = key;
         memcpy(item->payload_buf, payload, payload_len);
 
@@ -261,7 +424,7 @@ static bool periodic_action(void)
 {
     LOG_DBG("Generating a periodic trust info packet\n");
 
-    trust_tx_item_t* item = memb_alloc(&trust_tx_memb);
+    trust_tx_item_t* item = memb_stats_alloc(&trust_tx_memb);
     if (!item)
     {
         LOG_ERR("Cannot allocate memory for periodic_action trust request\n");
@@ -351,7 +514,7 @@ static void init(void)
 #endif
 
 #ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
-    etimer_set(&periodic_timer, TRUST_POLL_PERIOD);
+    wheel_timer_set_event(&periodic_timer, TRUST_POLL_PERIOD);
 
     LOG_DBG("Periodic broadcast of trust information enabled\n");
 #else
@@ -360,6 +523,11 @@ static void init(void)
 
     memb_init(&trust_tx_memb);
     memb_init(&trust_rx_memb);
+    MEMB_STATS_REGISTER(trust_tx_memb);
+    MEMB_STATS_REGISTER(trust_rx_memb);
+
+    memset(trust_rx_peers, 0, sizeof(trust_rx_peers));
+    token_bucket_init(&trust_rx_verify_bucket, TRUST_RX_VERIFY_BURST);
 
     LOG_DBG("TRUST_TX_SIZE = " CC_STRINGIFY(TRUST_TX_SIZE) "\n");
     LOG_DBG("TRUST_RX_SIZE = " CC_STRINGIFY(TRUST_RX_SIZE) "\n");
@@ -378,7 +546,7 @@ PROCESS_THREAD(trust_model, ev, data)
 #ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
         if (ev == PROCESS_EVENT_TIMER && data == &periodic_timer)
         {
-            etimer_reset(&periodic_timer);
+            wheel_timer_restart(&periodic_timer);
             periodic_action();
         }
 #endif
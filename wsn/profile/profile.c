@@ -7,6 +7,16 @@
 #include "oscore-crypto.h"
 #include "cose.h"
 #include "certificate.h"
+#include "nanocbor-helper.h"
+
+#ifdef PROFILE_TRUST
+#include "trust-common.h"
+#include "trust-model.h"
+#include "trust-choose.h"
+#include "edge-info.h"
+#include "peer-info.h"
+#include "monitoring.h"
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "profile"
 #define LOG_LEVEL LOG_LEVEL_DBG
@@ -14,6 +24,11 @@
 PROCESS(profile, "profile");
 PROCESS(profile_ecc_sign_verify, "profile_ecc_sign_verify");
 PROCESS(profile_aes_ccm, "profile_aes_ccm");
+PROCESS(profile_sha256, "profile_sha256");
+PROCESS(profile_certificate, "profile_certificate");
+#ifdef PROFILE_TRUST
+PROCESS(profile_trust, "profile_trust");
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 AUTOSTART_PROCESSES(&profile);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -35,6 +50,24 @@ PROCESS_THREAD(profile, ev, data)
     process_start(&profile_aes_ccm, NULL);
     PROCESS_YIELD_UNTIL(!process_is_running(&profile_aes_ccm));
 
+#elif defined(PROFILE_SHA256)
+    LOG_INFO("Profiling SHA256\n");
+
+    process_start(&profile_sha256, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_sha256));
+
+#elif defined(PROFILE_CERTIFICATE)
+    LOG_INFO("Profiling certificates\n");
+
+    process_start(&profile_certificate, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_certificate));
+
+#elif defined(PROFILE_TRUST)
+    LOG_INFO("Profiling trust model " CC_STRINGIFY(TRUST_MODEL) " with " CC_STRINGIFY(TRUST_CHOOSE) "\n");
+
+    process_start(&profile_trust, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_trust));
+
 #else
 #   error "Not profiling anything"
 #endif
@@ -175,3 +208,216 @@ PROCESS_THREAD(profile_aes_ccm, ev, data)
     PROCESS_END();
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_sha256, ev, data)
+{
+    PROCESS_BEGIN();
+
+    static uint8_t message[1024];
+    static uint16_t message_len = 0;
+
+    static uint8_t digest[SHA256_DIGEST_LEN_BYTES];
+
+    static bool r;
+
+    while (1)
+    {
+        // Sweep over all the lengths, the time taken is logged by sha256_hash
+        message_len = (message_len % sizeof(message)) + 1;
+
+        r = crypto_fill_random(message, message_len);
+        assert(r);
+
+        r = platform_crypto_success(sha256_hash(message, message_len, digest));
+        assert(r);
+
+        // Need to yield often enough to prevent the watchdog killing us
+        PROCESS_PAUSE();
+    }
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_certificate, ev, data)
+{
+    PROCESS_BEGIN();
+
+    crypto_support_init();
+
+    static uint8_t encoded[CERTIFICATE_CBOR_LENGTH];
+    static size_t encoded_len;
+
+    static uint8_t tbs[TBS_CERTIFICATE_CBOR_LENGTH + DTLS_EC_SIG_SIZE];
+    static size_t tbs_len;
+
+    static certificate_t certificate;
+
+    static bool r;
+    static int result;
+
+    static rtimer_clock_t time;
+
+    static nanocbor_encoder_t enc;
+    static nanocbor_value_t dec;
+
+    nanocbor_encoder_init(&enc, encoded, sizeof(encoded));
+    result = certificate_encode(&enc, &our_cert);
+    assert(result == NANOCBOR_OK);
+    encoded_len = nanocbor_encoded_len(&enc);
+
+    while (1)
+    {
+        nanocbor_decoder_init(&dec, encoded, encoded_len);
+
+        time = RTIMER_NOW();
+        result = certificate_decode(&dec, &certificate);
+        time = RTIMER_NOW() - time;
+        LOG_DBG("certificate_decode(), %" PRIu32 " us\n", RTIMERTICKS_TO_US_64(time));
+
+        assert(result == NANOCBOR_OK);
+
+        // Verify in the same way as the keystore does
+        time = RTIMER_NOW();
+
+        nanocbor_encoder_init(&enc, tbs, TBS_CERTIFICATE_CBOR_LENGTH);
+        result = certificate_encode_tbs(&enc, &certificate);
+        assert(result == NANOCBOR_OK);
+        tbs_len = nanocbor_encoded_len(&enc);
+
+        memcpy(&tbs[tbs_len], &certificate.signature, DTLS_EC_SIG_SIZE);
+
+        r = queue_message_to_verify(&profile_certificate, NULL, tbs, tbs_len + DTLS_EC_SIG_SIZE, &root_cert.public_key);
+        assert(r);
+
+        PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_verified);
+
+        time = RTIMER_NOW() - time;
+        LOG_DBG("certificate_verify(), %" PRIu32 " us\n", RTIMERTICKS_TO_US_64(time));
+
+        assert(platform_crypto_success(((messages_to_verify_entry_t*)data)->result));
+
+        queue_message_to_verify_done((messages_to_verify_entry_t*)data);
+
+        // Need to yield often enough to prevent the watchdog killing us
+        PROCESS_PAUSE();
+    }
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef PROFILE_TRUST
+#define PROFILE_TRUST_CAPABILITY MONITORING_APPLICATION_NAME
+
+static const uint8_t profile_trust_edges[] = { 1, 4, 16 };
+_Static_assert(16 <= NUM_EDGE_RESOURCES, "NUM_EDGE_RESOURCES too small to profile with 16 edges");
+
+// Replace the known edges with num_edges edges that each have the profiled capability
+static void
+profile_trust_setup(uint8_t num_edges)
+{
+    edge_resource_t* edge;
+    while ((edge = edge_info_iter()) != NULL)
+    {
+        peer_info_remove_edges(edge);
+        edge_info_remove(edge);
+    }
+
+    for (uint8_t i = 0; i != num_edges; ++i)
+    {
+        uip_ipaddr_t addr;
+        uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, i + 1);
+
+        edge = edge_info_add(&addr);
+        assert(edge != NULL);
+        edge->flags |= EDGE_RESOURCE_ACTIVE;
+
+        edge_capability_t* cap = edge_info_capability_add(edge, PROFILE_TRUST_CAPABILITY);
+        assert(cap != NULL);
+        cap->flags |= EDGE_CAPABILITY_ACTIVE;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_trust, ev, data)
+{
+    PROCESS_BEGIN();
+
+    trust_common_init();
+    edge_info_init();
+    peer_info_init();
+    init_trust_weights_monitoring();
+
+    static uint8_t buffer[PROFILE_TRUST_BUFFER_SIZE];
+    static int buffer_len;
+
+    static uip_ipaddr_t peer_addr;
+    uip_ip6addr(&peer_addr, 0xfd00, 0, 0, 0, 0, 0, 0, 0x100);
+
+    static uint8_t i;
+    static uint8_t num_edges;
+
+    static rtimer_clock_t time;
+    static int result;
+
+    // choose_edge can legitimately choose nothing (e.g., the trust values are NaN or
+    // the edges are not yet verified), which is still a measurement of its cost
+    static uint32_t choose_none;
+
+    while (1)
+    {
+        for (i = 0; i != sizeof(profile_trust_edges); ++i)
+        {
+            num_edges = profile_trust_edges[i];
+
+            profile_trust_setup(num_edges);
+
+            time = RTIMER_NOW();
+            buffer_len = serialise_trust(NULL, buffer, sizeof(buffer));
+            time = RTIMER_NOW() - time;
+            LOG_DBG("serialise_trust(%" PRIu8 "), %" PRIu32 " us\n", num_edges, RTIMERTICKS_TO_US_64(time));
+
+            assert(buffer_len > 0);
+
+            time = RTIMER_NOW();
+            result = process_received_trust(&peer_addr, buffer, buffer_len);
+            time = RTIMER_NOW() - time;
+            LOG_DBG("process_received_trust(%" PRIu8 "), %" PRIu32 " us\n", num_edges, RTIMERTICKS_TO_US_64(time));
+
+            assert(result == 0);
+
+            for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
+            {
+                edge_capability_t* cap = edge_info_capability_find(edge, PROFILE_TRUST_CAPABILITY);
+
+                time = RTIMER_NOW();
+                volatile float trust_value = calculate_trust_value(edge, cap);
+                time = RTIMER_NOW() - time;
+                LOG_DBG("calculate_trust_value(%" PRIu8 "), %" PRIu32 " us\n", num_edges, RTIMERTICKS_TO_US_64(time));
+
+                (void)trust_value;
+            }
+
+            time = RTIMER_NOW();
+            edge_resource_t* chosen = choose_edge(PROFILE_TRUST_CAPABILITY);
+            time = RTIMER_NOW() - time;
+            LOG_DBG("choose_edge(%" PRIu8 "), %" PRIu32 " us\n", num_edges, RTIMERTICKS_TO_US_64(time));
+
+            if (chosen == NULL)
+            {
+                choose_none += 1;
+                LOG_WARN("choose_edge(%" PRIu8 ") chose no edge (%" PRIu32 " times)\n", num_edges, choose_none);
+            }
+
+            // Need to yield often enough to prevent the watchdog killing us
+            PROCESS_PAUSE();
+        }
+    }
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -17,3 +17,13 @@
 
 // We are using 256 bit ECC, so can decrease RAM cost a bit here
 #define ECC_MAXIMUM_LENGTH 8
+
+#ifdef PROFILE_TRUST
+// Trust is profiled with up to 16 edges that have one capability, received from a single peer
+#define NUM_EDGE_RESOURCES 16
+#define NUM_EDGE_CAPABILITIES 1
+#define NUM_PEERS 1
+
+// Large enough to serialise the trust in 16 edges
+#define PROFILE_TRUST_BUFFER_SIZE 2048
+#endif
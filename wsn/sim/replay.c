@@ -0,0 +1,950 @@
+#include "sim-log.h"
+#include "sim-random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "applications.h"
+#include "edge-info.h"
+#include "peer-info.h"
+#include "trust-models.h"
+#include "trust-choose.h"
+#include "eui64.h"
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Replays the trust model updates and edge choices recorded in a trace (see analysis/parser/tm_trace.py)
+// against the trust model and choose policy this is built with. The trust value after each update and
+// the edge that would have been chosen are compared with the recording, and the time each call into
+// the trust model takes is measured over identical inputs.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef APPLICATION_MONITORING
+#include "monitoring.h"
+#endif
+#ifdef APPLICATION_ROUTING
+#include "routing.h"
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Must be kept in sync with analysis/parser/tm_trace.py
+#define REPLAY_TRACE_HEADER "# tm-trace 1 "
+
+#ifndef REPLAY_MAX_CAPABILITIES
+#define REPLAY_MAX_CAPABILITIES 16
+#endif
+
+// Empty calls timed to measure the overhead of timing each call
+#ifndef REPLAY_TIMER_CALIBRATION_SAMPLES
+#define REPLAY_TIMER_CALIBRATION_SAMPLES (1 << 20)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Not every trust model calculates a trust value (e.g., none and challenge-response)
+float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum replay_kind
+{
+    REPLAY_ANNOUNCE,
+    REPLAY_REMOVE,
+    REPLAY_UPDATE,
+    REPLAY_CHOOSE,
+
+} replay_kind_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct replay_record
+{
+    clock_time_t time;
+
+    replay_kind_t kind;
+
+    uint8_t eui64[EUI64_LENGTH];
+
+    // Interned in capability_names, NULL for updates and removals of the whole edge
+    const char* capability;
+
+    uint16_t metric;
+    int32_t obs1;
+    int32_t obs2;
+
+} replay_record_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct replay_cost
+{
+    const char* name;
+    uint64_t count;
+    uint64_t ns;
+
+} replay_cost_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum replay_cost_id
+{
+    COST_TASK_SUBMISSION,
+    COST_TASK_RESULT,
+    COST_CHALLENGE_RESP,
+    COST_LAST_PING,
+    COST_RESULT_QUALITY,
+    COST_THROUGHPUT,
+    COST_CALCULATE_TRUST_VALUE,
+    COST_CHOOSE_EDGE,
+
+    COST_NUM
+
+} replay_cost_id_t;
+
+static replay_cost_t costs[COST_NUM] = {
+    [COST_TASK_SUBMISSION] = { "tm_update_task_submission" },
+    [COST_TASK_RESULT] = { "tm_update_task_result" },
+    [COST_CHALLENGE_RESP] = { "tm_update_challenge_response" },
+    [COST_LAST_PING] = { "tm_update_ping" },
+    [COST_RESULT_QUALITY] = { "tm_update_result_quality" },
+    [COST_THROUGHPUT] = { "tm_update_task_throughput" },
+    [COST_CALCULATE_TRUST_VALUE] = { "calculate_trust_value" },
+    [COST_CHOOSE_EDGE] = { "choose_edge" },
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Mean nanoseconds added to each measured call by the two calls to monotonic_ns
+static double timer_overhead_ns;
+
+static replay_record_t* records;
+static size_t records_len;
+static size_t records_capacity;
+
+static char capability_names[REPLAY_MAX_CAPABILITIES][EDGE_CAPABILITY_NAME_LEN + 1];
+static size_t capability_names_len;
+
+static clock_time_t now;
+
+static FILE* trajectory_file;
+static FILE* decisions_file;
+
+// Choices made by the replayed choose policy that are the same as recorded
+static uint64_t choices;
+static uint64_t choices_agree;
+static uint64_t choices_none;
+/*-------------------------------------------------------------------------------------------------------------------*/
+__attribute__((__weak__)) float
+calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability)
+{
+    return NAN;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+    return now;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned long
+clock_seconds(void)
+{
+    return now / CLOCK_SECOND;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline uint64_t
+monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Trust model calls take tens of nanoseconds, about as long as reading the clock,
+// so the cost of timing an empty call is subtracted from the measured costs
+static void
+calibrate_timer(void)
+{
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i != REPLAY_TIMER_CALIBRATION_SAMPLES; ++i)
+    {
+        const uint64_t start = monotonic_ns();
+        total += monotonic_ns() - start;
+    }
+
+    timer_overhead_ns = (double)total / REPLAY_TIMER_CALIBRATION_SAMPLES;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t
+cost_ns(const replay_cost_t* cost)
+{
+    const double overhead = timer_overhead_ns * cost->count;
+
+    return cost->ns > overhead ? (uint64_t)(cost->ns - overhead) : 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const char*
+capability_intern(const char* name)
+{
+    for (size_t i = 0; i != capability_names_len; ++i)
+    {
+        if (strcmp(capability_names[i], name) == 0)
+        {
+            return capability_names[i];
+        }
+    }
+
+    if (capability_names_len == REPLAY_MAX_CAPABILITIES || strlen(name) > EDGE_CAPABILITY_NAME_LEN)
+    {
+        return NULL;
+    }
+
+    strcpy(capability_names[capability_names_len], name);
+
+    return capability_names[capability_names_len++];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_int32(const char* value, int32_t* result)
+{
+    if (value == NULL)
+    {
+        return false;
+    }
+
+    char* end;
+    errno = 0;
+    const long parsed = strtol(value, &end, 10);
+
+    if (errno != 0 || end == value || *end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX)
+    {
+        return false;
+    }
+
+    *result = (int32_t)parsed;
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_capability(const char* value, const char** result)
+{
+    if (value == NULL)
+    {
+        return false;
+    }
+
+    if (strcmp(value, "-") == 0)
+    {
+        *result = NULL;
+        return true;
+    }
+
+    *result = capability_intern(value);
+    return *result != NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+metric_supported(uint16_t metric, bool has_capability)
+{
+    switch (metric)
+    {
+    case TRUST_METRIC_TASK_SUBMISSION:
+    case TRUST_METRIC_TASK_RESULT:
+    case TRUST_METRIC_RESULT_QUALITY:
+    case TRUST_METRIC_THROUGHPUT:
+        return has_capability;
+
+    case TRUST_METRIC_CHALLENGE_RESP:
+    case TRUST_METRIC_LAST_PING:
+        return !has_capability;
+
+    default:
+        return false;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// <ms> announce <eui64> <capability>
+// <ms> remove <eui64> <capability|->
+// <ms> update <eui64> <capability|-> <metric> <obs1> <obs2>
+// <ms> choose <capability> <eui64>
+static bool
+parse_record(char* line, replay_record_t* record)
+{
+    char* saveptr = NULL;
+    const char* time = strtok_r(line, " \t\n", &saveptr);
+    const char* kind = strtok_r(NULL, " \t\n", &saveptr);
+
+    int32_t value;
+    if (!parse_int32(time, &value) || value < 0 || kind == NULL)
+    {
+        return false;
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->time = (clock_time_t)value;
+
+    if (strcmp(kind, "choose") == 0)
+    {
+        record->kind = REPLAY_CHOOSE;
+
+        const char* capability = strtok_r(NULL, " \t\n", &saveptr);
+        const char* eui64 = strtok_r(NULL, " \t\n", &saveptr);
+
+        return parse_capability(capability, &record->capability) && record->capability != NULL &&
+               eui64 != NULL && eui64_from_str(eui64, record->eui64);
+    }
+
+    if (strcmp(kind, "announce") == 0)
+    {
+        record->kind = REPLAY_ANNOUNCE;
+    }
+    else if (strcmp(kind, "remove") == 0)
+    {
+        record->kind = REPLAY_REMOVE;
+    }
+    else if (strcmp(kind, "update") == 0)
+    {
+        record->kind = REPLAY_UPDATE;
+    }
+    else
+    {
+        return false;
+    }
+
+    const char* eui64 = strtok_r(NULL, " \t\n", &saveptr);
+    const char* capability = strtok_r(NULL, " \t\n", &saveptr);
+
+    if (eui64 == NULL || !eui64_from_str(eui64, record->eui64) || !parse_capability(capability, &record->capability))
+    {
+        return false;
+    }
+
+    if (record->kind == REPLAY_ANNOUNCE)
+    {
+        return record->capability != NULL;
+    }
+
+    if (record->kind == REPLAY_REMOVE)
+    {
+        return true;
+    }
+
+    int32_t metric;
+    if (!parse_int32(strtok_r(NULL, " \t\n", &saveptr), &metric) || metric < 0 || metric > UINT16_MAX ||
+        !parse_int32(strtok_r(NULL, " \t\n", &saveptr), &record->obs1) ||
+        !parse_int32(strtok_r(NULL, " \t\n", &saveptr), &record->obs2))
+    {
+        return false;
+    }
+
+    record->metric = (uint16_t)metric;
+
+    return metric_supported(record->metric, record->capability != NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+load_trace(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    unsigned long lineno = 0;
+    bool result = true;
+
+    while (getline(&line, &line_capacity, f) != -1)
+    {
+        lineno += 1;
+
+        if (lineno == 1 && strncmp(line, REPLAY_TRACE_HEADER, strlen(REPLAY_TRACE_HEADER)) != 0)
+        {
+            fprintf(stderr, "%s is not a trust model trace\n", path);
+            result = false;
+            break;
+        }
+
+        if (line[0] == '#' || line[strspn(line, " \t\n")] == '\0')
+        {
+            continue;
+        }
+
+        if (records_len == records_capacity)
+        {
+            records_capacity = records_capacity == 0 ? 1024 : records_capacity * 2;
+            records = realloc(records, records_capacity * sizeof(*records));
+            if (records == NULL)
+            {
+                fprintf(stderr, "Out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (!parse_record(line, &records[records_len]))
+        {
+            fprintf(stderr, "%s:%lu: invalid record\n", path, lineno);
+            result = false;
+            break;
+        }
+
+        records_len += 1;
+    }
+
+    free(line);
+    fclose(f);
+
+    return result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Edges and capabilities that were known before the recording started are added when first used
+static edge_resource_t*
+edge_find(const uint8_t* eui64)
+{
+    edge_resource_t* edge = edge_info_find_eui64(eui64);
+    if (edge == NULL)
+    {
+        uip_ipaddr_t addr;
+        eui64_to_ipaddr(eui64, &addr);
+
+        edge = edge_info_add(&addr);
+        if (edge == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    edge->flags |= EDGE_RESOURCE_ACTIVE;
+
+    return edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_capability_t*
+capability_find(edge_resource_t* edge, const char* name)
+{
+    edge_capability_t* capability = edge_info_capability_find(edge, name);
+    if (capability == NULL)
+    {
+        capability = edge_info_capability_add(edge, name);
+        if (capability == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    capability->flags |= EDGE_CAPABILITY_ACTIVE;
+
+    return capability;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+replay_remove(const replay_record_t* record)
+{
+    edge_resource_t* edge = edge_info_find_eui64(record->eui64);
+    if (edge == NULL)
+    {
+        return;
+    }
+
+    if (record->capability == NULL)
+    {
+        edge->flags &= ~EDGE_RESOURCE_ACTIVE;
+        edge_info_capability_clear(edge);
+        return;
+    }
+
+    edge_capability_t* capability = edge_info_capability_find(edge, record->capability);
+    if (capability != NULL)
+    {
+        edge_info_capability_remove(edge, capability);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+trust_value(const replay_record_t* record, edge_resource_t* edge, edge_capability_t* capability, bool output)
+{
+    // Only the applications that choose edges by trust have weights (e.g., not cr)
+    if (trust_weights_find(capability->name) == NULL)
+    {
+        return;
+    }
+
+    const uint64_t start = monotonic_ns();
+    const float trust = calculate_trust_value(edge, capability);
+    costs[COST_CALCULATE_TRUST_VALUE].ns += monotonic_ns() - start;
+    costs[COST_CALCULATE_TRUST_VALUE].count += 1;
+
+    if (output && trajectory_file != NULL)
+    {
+        fprintf(trajectory_file, "%lu,%s,%s,%" PRIu16 ",%f\n",
+            (unsigned long)record->time, edge_info_name(edge), capability->name, record->metric, trust);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static replay_cost_id_t
+replay_update_call(const replay_record_t* record, edge_resource_t* edge, edge_capability_t* capability)
+{
+    switch (record->metric)
+    {
+    case TRUST_METRIC_TASK_SUBMISSION:
+    {
+        const tm_task_submission_info_t info = {
+            .coap_request_status = (coap_request_status_t)record->obs1,
+            .coap_status = (coap_status_t)record->obs2,
+        };
+        tm_update_task_submission(edge, capability, &info);
+        return COST_TASK_SUBMISSION;
+    }
+
+    case TRUST_METRIC_TASK_RESULT:
+    {
+        const tm_task_result_info_t info = {
+            .result = (tm_task_result_type_t)record->obs1,
+        };
+        tm_update_task_result(edge, capability, &info);
+        return COST_TASK_RESULT;
+    }
+
+    case TRUST_METRIC_RESULT_QUALITY:
+    {
+        const tm_result_quality_info_t info = {
+            .good = record->obs1 != 0,
+        };
+        tm_update_result_quality(edge, capability, &info);
+        return COST_RESULT_QUALITY;
+    }
+
+    case TRUST_METRIC_THROUGHPUT:
+    {
+        const tm_throughput_info_t info = {
+            .direction = (tm_throughput_direction_t)record->obs1,
+            .throughput = (uint32_t)record->obs2,
+        };
+        tm_update_task_throughput(edge, capability, &info);
+        return COST_THROUGHPUT;
+    }
+
+    case TRUST_METRIC_CHALLENGE_RESP:
+    {
+        // Only the type and whether it was good were logged, so recreate an info that
+        // tm_challenge_response_good judges the same way
+        tm_challenge_response_info_t info = {
+            .type = (tm_challenge_response_type_t)record->obs1,
+        };
+        const bool good = record->obs2 != 0;
+
+        switch (info.type)
+        {
+        case TM_CHALLENGE_RESPONSE_ACK:
+            info.coap_request_status = good ? COAP_REQUEST_STATUS_RESPONSE : COAP_REQUEST_STATUS_TIMEOUT;
+            info.coap_status = good ? CONTENT_2_05 : 0;
+            break;
+
+        case TM_CHALLENGE_RESPONSE_TIMEOUT:
+            info.never_received = !good;
+            info.received_late = false;
+            break;
+
+        case TM_CHALLENGE_RESPONSE_RESP:
+        default:
+            info.type = TM_CHALLENGE_RESPONSE_RESP;
+            info.challenge_successful = good;
+            info.challenge_late = false;
+            break;
+        }
+
+        tm_update_challenge_response(edge, &info);
+        return COST_CHALLENGE_RESP;
+    }
+
+    case TRUST_METRIC_LAST_PING:
+    default:
+    {
+        const tm_edge_ping_t info = {
+            .action = (tm_edge_ping_action_t)record->obs1,
+        };
+        tm_update_ping(edge, &info);
+        return COST_LAST_PING;
+    }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+replay_update(const replay_record_t* record, bool output)
+{
+    edge_resource_t* edge = edge_find(record->eui64);
+    if (edge == NULL)
+    {
+        return;
+    }
+
+    edge_capability_t* capability = NULL;
+    if (record->capability != NULL)
+    {
+        capability = capability_find(edge, record->capability);
+        if (capability == NULL)
+        {
+            return;
+        }
+    }
+
+    const uint64_t start = monotonic_ns();
+    const replay_cost_id_t id = replay_update_call(record, edge, capability);
+    costs[id].ns += monotonic_ns() - start;
+    costs[id].count += 1;
+
+    // Updates to the edge can change the trust in all of its capabilities
+    if (capability != NULL)
+    {
+        trust_value(record, edge, capability, output);
+    }
+    else
+    {
+        for (capability = list_head(edge->capabilities); capability != NULL; capability = list_item_next(capability))
+        {
+            trust_value(record, edge, capability, output);
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+replay_choose(const replay_record_t* record, bool output)
+{
+    const uint64_t start = monotonic_ns();
+    edge_resource_t* edge = choose_edge(record->capability);
+    costs[COST_CHOOSE_EDGE].ns += monotonic_ns() - start;
+    costs[COST_CHOOSE_EDGE].count += 1;
+
+    if (!output)
+    {
+        return;
+    }
+
+    uint8_t eui64[EUI64_LENGTH];
+    if (edge != NULL)
+    {
+        eui64_from_ipaddr(&edge->ep.ipaddr, eui64);
+    }
+
+    const bool agree = edge != NULL && memcmp(eui64, record->eui64, EUI64_LENGTH) == 0;
+
+    choices += 1;
+    choices_agree += agree;
+    choices_none += (edge == NULL);
+
+    if (decisions_file != NULL)
+    {
+        char recorded[EUI64_LENGTH * 2 + 1];
+        eui64_to_str(record->eui64, recorded, sizeof(recorded));
+
+        fprintf(decisions_file, "%lu,%s,%s,%s,%d\n",
+            (unsigned long)record->time, record->capability, recorded,
+            edge == NULL ? "" : edge_info_name(edge), agree);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The same trust state as a node that has just started
+static void
+replay_reset(uint64_t seed)
+{
+    now = 0;
+
+    sim_random_seed(seed, 0);
+
+    edge_info_init();
+    peer_info_init();
+    trust_weights_init();
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    trust_throughput_thresholds_init();
+#endif
+
+#ifdef APPLICATION_MONITORING
+    init_trust_weights_monitoring();
+#endif
+#ifdef APPLICATION_ROUTING
+    init_trust_weights_routing();
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Outputs (trajectory, decisions and the log) are only written on the first pass,
+// later passes repeat the same calls to measure them over more samples
+static void
+replay_pass(bool output)
+{
+    for (size_t i = 0; i != records_len; ++i)
+    {
+        const replay_record_t* record = &records[i];
+
+        now = record->time;
+
+        switch (record->kind)
+        {
+        case REPLAY_ANNOUNCE:
+        {
+            edge_resource_t* edge = edge_find(record->eui64);
+            if (edge != NULL)
+            {
+                capability_find(edge, record->capability);
+            }
+        } break;
+
+        case REPLAY_REMOVE:
+            replay_remove(record);
+            break;
+
+        case REPLAY_UPDATE:
+            replay_update(record, output);
+            break;
+
+        case REPLAY_CHOOSE:
+            replay_choose(record, output);
+            break;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static FILE*
+open_output(const char* path, const char* header)
+{
+    FILE* f = fopen(path, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    fputs(header, f);
+
+    return f;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+write_costs(const char* path)
+{
+    FILE* f = open_output(path, "name,count,total_ns,mean_ns\n");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i != COST_NUM; ++i)
+    {
+        const uint64_t ns = cost_ns(&costs[i]);
+
+        fprintf(f, "%s,%" PRIu64 ",%" PRIu64 ",%.1f\n", costs[i].name, costs[i].count, ns,
+            costs[i].count == 0 ? 0.0 : (double)ns / costs[i].count);
+    }
+
+    fclose(f);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+print_summary(const char* path, unsigned long long repeat, double elapsed)
+{
+    fprintf(stdout, "Replayed %zu records from %s %llu time(s) in %.3f s\n", records_len, path, repeat, elapsed);
+    fprintf(stdout, "Subtracted a timer overhead of %.1f ns from each call\n", timer_overhead_ns);
+
+    fprintf(stdout, "%-30s %12s %12s\n", "call", "count", "mean ns");
+
+    for (size_t i = 0; i != COST_NUM; ++i)
+    {
+        if (costs[i].count == 0)
+        {
+            continue;
+        }
+
+        fprintf(stdout, "%-30s %12" PRIu64 " %12.1f\n", costs[i].name, costs[i].count, (double)cost_ns(&costs[i]) / costs[i].count);
+    }
+
+    if (choices != 0)
+    {
+        fprintf(stdout, "Chose the recorded edge %" PRIu64 " of %" PRIu64 " times (%.1f%%), no edge %" PRIu64 " times\n",
+            choices_agree, choices, 100.0 * choices_agree / choices, choices_none);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options] TRACE\n"
+        "  --repeat N          Replay the trace N times to measure the cost of each call (default 1)\n"
+        "  --trajectory CSV    Write the trust value of each capability after every update\n"
+        "  --decisions CSV     Write the recorded and replayed choice of edge for each task\n"
+        "  --costs CSV         Write the number of calls and nanoseconds spent in each, less\n"
+        "                      the overhead of timing them\n"
+        "  --log FILE          Write the output of the trust model as a pyterm log (the first pass\n"
+        "                      is then measured with the time spent formatting it)\n"
+        "  --log-level N       Most verbose log level to output, 0 (none) to 4 (debug)\n"
+        "  --seed N            Seed for random_rand (default 0)\n",
+        name);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_unsigned(const char* value, unsigned long long max, unsigned long long* result)
+{
+    char* end;
+    errno = 0;
+    const unsigned long long parsed = strtoull(value, &end, 0);
+
+    if (errno != 0 || end == value || *end != '\0' || parsed > max)
+    {
+        return false;
+    }
+
+    *result = parsed;
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    static const struct option options[] = {
+        { "repeat", required_argument, NULL, 'r' },
+        { "trajectory", required_argument, NULL, 't' },
+        { "decisions", required_argument, NULL, 'd' },
+        { "costs", required_argument, NULL, 'c' },
+        { "log", required_argument, NULL, 'o' },
+        { "log-level", required_argument, NULL, 'l' },
+        { "seed", required_argument, NULL, 's' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    unsigned long long repeat = 1;
+    unsigned long long seed = 0;
+    unsigned long long value;
+    const char* trajectory_path = NULL;
+    const char* decisions_path = NULL;
+    const char* costs_path = NULL;
+    const char* log_path = NULL;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+            if (!parse_unsigned(optarg, UINT32_MAX, &repeat) || repeat == 0)
+            {
+                fprintf(stderr, "Invalid repeat '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 't':
+            trajectory_path = optarg;
+            break;
+
+        case 'd':
+            decisions_path = optarg;
+            break;
+
+        case 'c':
+            costs_path = optarg;
+            break;
+
+        case 'o':
+            log_path = optarg;
+            break;
+
+        case 'l':
+            if (!parse_unsigned(optarg, LOG_LEVEL_DBG, &value))
+            {
+                fprintf(stderr, "Invalid log level '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            sim_log_level = (int)value;
+            break;
+
+        case 's':
+            if (!parse_unsigned(optarg, UINT64_MAX, &seed))
+            {
+                fprintf(stderr, "Invalid seed '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 'h':
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* trace_path = argv[optind];
+
+    if (!load_trace(trace_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (trajectory_path != NULL &&
+        (trajectory_file = open_output(trajectory_path, "time_ms,edge,capability,metric,trust\n")) == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (decisions_path != NULL &&
+        (decisions_file = open_output(decisions_path, "time_ms,capability,recorded,replayed,agree\n")) == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Formatting the log would be measured as part of each update, so only do it when asked to
+    if (log_path == NULL)
+    {
+        sim_log_level = LOG_LEVEL_NONE;
+    }
+    else if (!sim_log_open(log_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    calibrate_timer();
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned long long pass = 0; pass != repeat; ++pass)
+    {
+        replay_reset(seed);
+        replay_pass(pass == 0);
+
+        if (pass == 0)
+        {
+            sim_log_close();
+            sim_log_level = LOG_LEVEL_NONE;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    print_summary(trace_path, repeat, elapsed);
+
+    if (trajectory_file != NULL)
+    {
+        fclose(trajectory_file);
+    }
+    if (decisions_file != NULL)
+    {
+        fclose(decisions_file);
+    }
+    if (costs_path != NULL && !write_costs(costs_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    free(records);
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,30 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "edge-info.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Models of the node side of each application. They make the same calls into the trust stack
+// and log the same messages as the firmware in wsn/applications/<name>/node, but exchange
+// messages with the simulated edges instead of using CoAP.
+// init is called when each node starts and edge_added when an edge announces the capability.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef APPLICATION_MONITORING
+void sim_monitoring_init(void);
+void sim_monitoring_edge_added(edge_resource_t* edge);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef APPLICATION_ROUTING
+void sim_routing_init(void);
+void sim_routing_edge_added(edge_resource_t* edge);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef APPLICATION_CHALLENGE_RESPONSE
+void sim_challenge_response_init(void);
+void sim_challenge_response_edge_added(edge_resource_t* edge);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_MODEL_PERIODIC_EDGE_PING
+// Pings edges on the schedule from edge-ping-schedule.c, as wsn/common/trust/edge-ping.c does
+void sim_edge_ping_init(void);
+void sim_edge_ping_edge_added(edge_resource_t* edge);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,270 @@
+#include "sim-applications.h"
+
+#ifdef APPLICATION_CHALLENGE_RESPONSE
+
+#include "sim.h"
+#include "sim-edge.h"
+
+#include "challenge-response.h"
+#include "trust-models.h"
+
+#include "os/sys/log.h"
+#include "coap-log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "A-" CHALLENGE_RESPONSE_APPLICATION_NAME
+#ifdef APP_CHALLENGE_RESPONSE_LOG_LEVEL
+#define LOG_LEVEL APP_CHALLENGE_RESPONSE_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define MSG_BUF_LEN CHALLENGE_RESPONSE_MSG_BUF_LEN
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct edge_challenger {
+    edge_resource_t* edge;
+    challenge_t ch;
+
+    clock_time_t generated;
+    clock_time_t received;
+
+} edge_challenger_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static struct {
+    edge_challenger_t challengers[NUM_EDGE_RESOURCES];
+    uint8_t challengers_len;
+
+    // Round robin over the challengers
+    edge_challenger_t* next_challenge;
+
+    bool in_use;
+
+    // Incremented for each challenge, so the timeout for an earlier one is ignored
+    uint32_t challenge_id;
+} state;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+move_to_next_challenge(void)
+{
+    if (state.challengers_len == 0)
+    {
+        state.next_challenge = NULL;
+        return;
+    }
+
+    if (state.next_challenge == NULL ||
+        state.next_challenge == &state.challengers[state.challengers_len - 1])
+    {
+        state.next_challenge = &state.challengers[0];
+    }
+    else
+    {
+        state.next_challenge += 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// How long to wait for the challenge response, allowing for the round trip time to the edge
+static clock_time_t
+challenge_deadline(const edge_challenger_t* challenger)
+{
+    return edge_info_deadline(challenger->edge, challenger->ch.max_duration_secs * CLOCK_SECOND);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+challenge_response_timed_out(void* ptr)
+{
+    // A new challenge has been started since
+    if ((uint32_t)(uintptr_t)ptr != state.challenge_id || state.next_challenge == NULL)
+    {
+        return;
+    }
+
+    edge_challenger_t* c = state.next_challenge;
+
+    const clock_time_t duration = challenge_deadline(c);
+
+    bool never_received, received_late;
+    if (challenge_response_missed(c->generated, c->received, duration, &never_received, &received_late))
+    {
+        LOG_WARN("Failed to receive challenge response from ");
+        LOG_WARN_6ADDR(&c->edge->ep.ipaddr);
+        LOG_WARN_(" in a suitable time (gen=%lu,recv=%lu,diff=%lu,dur=%ld)\n",
+            (unsigned long)c->generated,
+            (unsigned long)c->received,
+            (unsigned long)(int32_t)(c->received - c->generated),
+            (long)duration
+        );
+
+        const tm_challenge_response_info_t info = {
+            .type = TM_CHALLENGE_RESPONSE_TIMEOUT,
+            .never_received = never_received,
+            .received_late = received_late,
+        };
+
+        tm_update_challenge_response(c->edge, &info);
+
+        // Reset generation / receive counters
+        c->generated = 0;
+        c->received = 0;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+response_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    edge_challenger_t* c = (edge_challenger_t*)ptr;
+
+    if (status != COAP_REQUEST_STATUS_RESPONSE)
+    {
+        return;
+    }
+
+    LOG_DBG("Received challenge response data uri=%s, payload_len=%d from ", CHALLENGE_RESPONSE_APPLICATION_URI, 0);
+    LOG_DBG_6ADDR(&sim_edge->addr);
+    LOG_DBG_("\n");
+
+    // The simulated edges always solve the challenge correctly
+    tm_challenge_response_info_t info = {
+        .type = TM_CHALLENGE_RESPONSE_RESP,
+        .challenge_successful = true,
+    };
+
+    c->received = clock_time();
+
+    info.challenge_late = challenge_response_late(c->generated, c->received, challenge_deadline(c));
+
+    LOG_INFO("Challenge response from ");
+    LOG_INFO_6ADDR(&c->edge->ep.ipaddr);
+    LOG_INFO_(" %s\n", info.challenge_successful ? "succeeded" : "failed");
+
+    tm_update_challenge_response(c->edge, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    edge_challenger_t* c = (edge_challenger_t*)ptr;
+
+    tm_challenge_response_info_t info = {
+        .type = TM_CHALLENGE_RESPONSE_ACK,
+        .coap_status = NO_ERROR,
+        .coap_request_status = status
+    };
+
+    state.in_use = false;
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        LOG_DBG("Message send complete with code CONTENT_2_05 (len=%d)\n", 0);
+
+        // Set a timer for when we expect a response by
+        sim_schedule(challenge_deadline(c), challenge_response_timed_out, (void*)(uintptr_t)state.challenge_id);
+
+        info.coap_status = CONTENT_2_05;
+
+        edge_info_rtt_update(c->edge, clock_time() - c->generated);
+
+        // The edge starts solving the challenge once it has been received
+        sim_edge_notify(sim_edge,
+            sim_random_between(SIM_EDGE_CHALLENGE_SOLVE_MIN, SIM_EDGE_CHALLENGE_SOLVE_MAX),
+            response_callback, c);
+    }
+    else
+    {
+        LOG_ERR("Failed to send message due to %s(%d)\n", coap_request_status_to_string(status), status);
+    }
+
+    tm_update_challenge_response(c->edge, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+generate_challenge(challenge_t* ch, uint8_t difficulty, uint32_t max_duration_secs)
+{
+    for (size_t i = 0; i != sizeof(ch->data); i += sizeof(uint32_t))
+    {
+        const uint32_t r = sim_random_u32();
+        memcpy(&ch->data[i], &r, sizeof(r));
+    }
+
+    ch->difficulty = difficulty;
+    ch->max_duration_secs = max_duration_secs;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+periodic_action(void* ptr)
+{
+    sim_schedule(CHALLENGE_PERIOD, periodic_action, NULL);
+
+    if (state.in_use)
+    {
+        LOG_WARN("Cannot generate a new message, as in process of sending one\n");
+        return;
+    }
+
+    move_to_next_challenge();
+
+    // The timeout for the previous challenge no longer applies
+    state.challenge_id += 1;
+
+    edge_challenger_t* c = state.next_challenge;
+    if (c == NULL)
+    {
+        LOG_WARN("No challenges possible\n");
+        return;
+    }
+
+    generate_challenge(&c->ch, CHALLENGE_DIFFICULTY, CHALLENGE_DURATION);
+
+    uint8_t msg_buf[MSG_BUF_LEN];
+    int len = nanocbor_fmt_challenge(msg_buf, MSG_BUF_LEN, &c->ch);
+    if (len <= 0 || len > MSG_BUF_LEN)
+    {
+        LOG_ERR("Failed to generated message (%d)\n", len);
+        return;
+    }
+
+    LOG_DBG("Generated message (len=%d) for challenge difficulty=%d and ", len, c->ch.difficulty);
+    LOG_DBG_BYTES(c->ch.data, sizeof(c->ch.data));
+    LOG_DBG_("\n");
+
+    sim_edge_t* sim_edge = sim_edge_find(&c->edge->ep.ipaddr);
+
+    // Record when we sent this challenge
+    c->generated = clock_time();
+    state.in_use = true;
+
+    sim_edge->tasks[SIM_APP_CHALLENGE_RESPONSE] += 1;
+
+    sim_edge_request(sim_edge, send_callback, c);
+
+    LOG_DBG("Message sent to ");
+    LOG_DBG_COAP_EP(&c->edge->ep);
+    LOG_DBG_("\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_challenge_response_init(void)
+{
+    memset(&state, 0, sizeof(state));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_challenge_response_edge_added(edge_resource_t* edge)
+{
+    if (state.challengers_len == 0)
+    {
+        sim_schedule(CHALLENGE_PERIOD, periodic_action, NULL);
+    }
+
+    if (state.challengers_len == NUM_EDGE_RESOURCES)
+    {
+        LOG_ERR("Failed to allocate edge_challenger\n");
+        return;
+    }
+
+    edge_challenger_t* c = &state.challengers[state.challengers_len++];
+    c->edge = edge;
+    c->generated = 0;
+    c->received = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,170 @@
+#include "contiki.h"
+#include "os/sys/log.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "coap-log.h"
+#include "coap-request-state.h"
+#include "coap-timer.h"
+#include "keystore.h"
+
+#include "eui64.h"
+#include "stereotypes.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The parts of Contiki-NG and the rest of the firmware that the trust stack links against,
+// apart from lists and memory blocks which are in sim-lib.c
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+timer_set(struct timer* t, clock_time_t interval)
+{
+    t->interval = interval;
+    t->start = clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+timer_reset(struct timer* t)
+{
+    t->start += t->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+timer_expired(struct timer* t)
+{
+    return (clock_time_t)(clock_time() - t->start) >= t->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+timer_remaining(struct timer* t)
+{
+    return timer_expired(t) ? 0 : t->start + t->interval - clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+coap_timer_set(coap_timer_t* timer, uint64_t time)
+{
+    timer->expiration_time = (uint64_t)clock_time() + time;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The interface identifier is the EUI-64 with the universal/local bit flipped
+void
+eui64_from_ipaddr(const uip_ip6addr_t* ipaddr, uint8_t* eui64)
+{
+    memcpy(eui64, &ipaddr->u8[8], EUI64_LENGTH);
+    eui64[0] ^= 0x02;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+eui64_to_ipaddr(const uint8_t* eui64, uip_ip6addr_t* ipaddr)
+{
+    memset(ipaddr, 0, sizeof(*ipaddr));
+
+    ipaddr->u8[0] = 0xFD;
+    ipaddr->u8[1] = 0x00;
+
+    memcpy(&ipaddr->u8[8], eui64, EUI64_LENGTH);
+    ipaddr->u8[8] ^= 0x02;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+eui64_from_str(const char* eui64_str, uint8_t* eui64)
+{
+    if (strlen(eui64_str) != EUI64_LENGTH * 2)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i != EUI64_LENGTH; ++i)
+    {
+        // sscanf would also accept whitespace, signs and 0x
+        if (!isxdigit((unsigned char)eui64_str[i * 2]) || !isxdigit((unsigned char)eui64_str[i * 2 + 1]) ||
+            sscanf(eui64_str + i * 2, "%2hhx", &eui64[i]) != 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+eui64_to_str(const uint8_t* eui64, char* eui64_str, size_t eui64_str_size)
+{
+    return snprintf(eui64_str, eui64_str_size,
+                    "%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx",
+                    eui64[0], eui64[1], eui64[2], eui64[3],
+                    eui64[4], eui64[5], eui64[6], eui64[7]);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t*
+keystore_find_addr(const uip_ip6addr_t* addr)
+{
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+request_public_key(const uip_ip6addr_t* addr)
+{
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+edge_stereotype_t*
+edge_stereotype_find(const stereotype_tags_t* tags)
+{
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char*
+coap_request_status_to_string(coap_request_status_t status)
+{
+    switch (status)
+    {
+    case COAP_REQUEST_STATUS_RESPONSE:    return "RESPONSE";
+    case COAP_REQUEST_STATUS_MORE:        return "MORE";
+    case COAP_REQUEST_STATUS_FINISHED:    return "FINISHED";
+    case COAP_REQUEST_STATUS_TIMEOUT:     return "TIMEOUT";
+    case COAP_REQUEST_STATUS_BLOCK_ERROR: return "BLOCK_ERROR";
+    default:                              return "UNKNOWN";
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+log_6addr(const uip_ipaddr_t* ipaddr)
+{
+    char buf[INET6_ADDRSTRLEN];
+
+    if (ipaddr == NULL)
+    {
+        printf("(NULL IP addr)");
+        return;
+    }
+
+    printf("%s", inet_ntop(AF_INET6, ipaddr->u8, buf, sizeof(buf)));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+log_bytes(const void* data, size_t length)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (size_t i = 0; i != length; ++i)
+    {
+        printf("%02x", bytes[i]);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+coap_endpoint_log(const coap_endpoint_t* ep)
+{
+    if (ep == NULL)
+    {
+        printf("(NULL EP)");
+        return;
+    }
+
+    printf("coap%s://[", ep->secure ? "s" : "");
+    log_6addr(&ep->ipaddr);
+    printf("]:%u", UIP_HTONS(ep->port));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
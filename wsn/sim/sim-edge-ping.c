@@ -0,0 +1,146 @@
+#include "sim-applications.h"
+
+#ifdef TRUST_MODEL_PERIODIC_EDGE_PING
+
+#include "sim.h"
+#include "sim-edge.h"
+
+#include "edge-ping-schedule.h"
+#include "trust-models.h"
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "edge-ping"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct edge_ping_target
+{
+    edge_resource_t* edge;
+    sim_edge_t* sim_edge;
+
+    edge_ping_schedule_t schedule;
+
+} edge_ping_target_t;
+
+// An echo reply in flight
+typedef struct edge_ping_reply
+{
+    edge_ping_target_t* target;
+    uint16_t seq;
+} edge_ping_reply_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_ping_target_t targets[NUM_EDGE_RESOURCES];
+static uint8_t targets_len;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+echo_callback(void* ptr)
+{
+    edge_ping_reply_t* reply = (edge_ping_reply_t*)ptr;
+    edge_ping_target_t* target = reply->target;
+    const uint16_t seq = reply->seq;
+
+    sim_free(reply);
+
+    LOG_INFO("Received ping response seq=%" PRIu16 " from ", seq);
+    LOG_INFO_6ADDR(&target->edge->ep.ipaddr);
+    LOG_INFO_("\n");
+
+    // Any reply shows the edge is alive
+    const tm_edge_ping_t info = {
+        .action = TM_PING_RECEIVED
+    };
+
+    tm_update_ping(target->edge, &info);
+
+    // Only the first reply to the latest ping gives a round trip time sample
+    clock_time_t rtt;
+    if (edge_ping_schedule_replied(&target->schedule, seq, &rtt))
+    {
+        edge_info_rtt_update(target->edge, rtt);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_ping(edge_ping_target_t* target)
+{
+    const uint16_t seq = edge_ping_schedule_sent(&target->schedule);
+
+    LOG_INFO("Pinging edge ");
+    LOG_INFO_6ADDR(&target->edge->ep.ipaddr);
+    LOG_INFO_(" seq=%" PRIu16 " interval=%lu\n", seq, (unsigned long)target->schedule.interval);
+
+    const tm_edge_ping_t info = {
+        .action = TM_PING_SENT
+    };
+
+    tm_update_ping(target->edge, &info);
+
+    // Echo requests are not retransmitted, so both the request and reply need to get through
+    const clock_time_t now = clock_time();
+    const clock_time_t rtt = sim_edge_rtt(target->sim_edge);
+
+    if (!sim_edge_lost(target->sim_edge, now) && !sim_edge_lost(target->sim_edge, now + rtt / 2))
+    {
+        edge_ping_reply_t* reply = sim_alloc(sizeof(*reply));
+        reply->target = target;
+        reply->seq = seq;
+
+        sim_schedule(rtt, echo_callback, reply);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+ping_timer_callback(void* ptr)
+{
+    edge_ping_target_t* target = (edge_ping_target_t*)ptr;
+
+    // No reply to the last ping in a whole interval
+    if (edge_ping_schedule_timed_out(&target->schedule))
+    {
+        LOG_WARN("No reply to ping seq=%" PRIu16 " from edge ", target->schedule.seq);
+        LOG_WARN_6ADDR(&target->edge->ep.ipaddr);
+        LOG_WARN_("\n");
+
+        const tm_edge_ping_t info = {
+            .action = TM_PING_TIMEOUT
+        };
+
+        tm_update_ping(target->edge, &info);
+    }
+
+    send_ping(target);
+
+    sim_schedule(edge_ping_schedule_next_delay(&target->schedule), ping_timer_callback, target);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_edge_ping_init(void)
+{
+    LOG_INFO("Starting edge ping\n");
+
+    memset(targets, 0, sizeof(targets));
+    targets_len = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_edge_ping_edge_added(edge_resource_t* edge)
+{
+    if (targets_len == NUM_EDGE_RESOURCES)
+    {
+        LOG_ERR("No space to ping edge %s\n", edge_info_name(edge));
+        return;
+    }
+
+    edge_ping_target_t* target = &targets[targets_len++];
+    target->edge = edge;
+    target->sim_edge = sim_edge_find(&edge->ep.ipaddr);
+    edge_ping_schedule_init(&target->schedule);
+
+    sim_schedule(edge_ping_schedule_first_delay(&target->schedule), ping_timer_callback, target);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,385 @@
+#include "sim-edge.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "coap-transactions.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Defaults for the options of each kind of edge
+#define SIM_EDGE_BAD_ROUTING_SLOW_WAIT (1 * CLOCK_SECOND)
+#define SIM_EDGE_RADIO_OFF_INTERVAL (300 * CLOCK_SECOND)
+#define SIM_EDGE_RADIO_OFF_DURATION (5 * CLOCK_SECOND)
+#define SIM_EDGE_DOS_LOSS 0.25f
+#define SIM_EDGE_DOS_DELAY (1 * CLOCK_SECOND)
+/*-------------------------------------------------------------------------------------------------------------------*/
+sim_edge_t sim_edges[NUM_EDGE_RESOURCES];
+uint8_t sim_edges_len;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    const char* name;
+    const char* edges[NUM_EDGE_RESOURCES];
+} sim_scenario_t;
+
+// Each scenario has a well behaved edge (edge.sh) and one that may not be (bad_edge.sh)
+static const sim_scenario_t scenarios[] = {
+    { "all-good", { "good", "good" } },
+    { "routing-always-bad", { "good", "bad-routing:approach=random" } },
+    { "routing-periodically-bad", { "good", "bad-routing:approach=random,duration=300" } },
+    { "throughput-always-good", { "good", "good" } },
+    { "throughput-dos-edge", { "good", "dos" } },
+    { "throughput-periodically-slow", { "good", "bad-routing:approach=slow,duration=300,slow-wait=1" } },
+    { "throughput-power-periodically-off", { "good", "radio-off:interval=300,duration=5" } },
+    { "throughput-routing-always-slow", { "good", "bad-routing:approach=slow,slow-wait=1" } },
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const char* const approaches[] = {
+    [SIM_MISBEHAVE_BAD_RESPONSE] = "bad-response",
+    [SIM_MISBEHAVE_NO_RESPONSE] = "no-response",
+    [SIM_MISBEHAVE_SLOW] = "slow",
+    [SIM_MISBEHAVE_RANDOM] = "random",
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_seconds(const char* value, clock_time_t* result)
+{
+    char* end;
+    const double seconds = strtod(value, &end);
+    if (*end != '\0' || seconds < 0)
+    {
+        return false;
+    }
+
+    *result = (clock_time_t)(seconds * CLOCK_SECOND);
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_option(sim_edge_t* edge, const char* key, const char* value)
+{
+    if (edge->kind == SIM_EDGE_BAD_ROUTING && strcmp(key, "approach") == 0)
+    {
+        for (size_t i = 0; i != CC_ARRAY_SIZE(approaches); ++i)
+        {
+            if (approaches[i] != NULL && strcmp(approaches[i], value) == 0)
+            {
+                edge->approach = (sim_misbehave_t)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if ((edge->kind == SIM_EDGE_BAD_ROUTING || edge->kind == SIM_EDGE_RADIO_OFF) && strcmp(key, "duration") == 0)
+    {
+        return parse_seconds(value, &edge->duration);
+    }
+
+    if (edge->kind == SIM_EDGE_BAD_ROUTING && strcmp(key, "slow-wait") == 0)
+    {
+        return parse_seconds(value, &edge->slow_wait);
+    }
+
+    if (edge->kind == SIM_EDGE_RADIO_OFF && strcmp(key, "interval") == 0)
+    {
+        return parse_seconds(value, &edge->interval) && edge->interval > 0;
+    }
+
+    if (edge->kind == SIM_EDGE_DOS && strcmp(key, "loss") == 0)
+    {
+        char* end;
+        edge->loss = strtof(value, &end);
+        return *end == '\0' && edge->loss >= 0 && edge->loss <= 1;
+    }
+
+    if (edge->kind == SIM_EDGE_DOS && strcmp(key, "delay") == 0)
+    {
+        return parse_seconds(value, &edge->delay);
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+sim_edge_add(const char* spec)
+{
+    if (sim_edges_len == NUM_EDGE_RESOURCES)
+    {
+        fprintf(stderr, "Too many edges, at most NUM_EDGE_RESOURCES=%d can be simulated\n", NUM_EDGE_RESOURCES);
+        return false;
+    }
+
+    sim_edge_t* edge = &sim_edges[sim_edges_len];
+    memset(edge, 0, sizeof(*edge));
+
+    strncpy(edge->spec, spec, sizeof(edge->spec) - 1);
+
+    char copy[sizeof(edge->spec)];
+    strcpy(copy, edge->spec);
+
+    char* options = strchr(copy, ':');
+    if (options != NULL)
+    {
+        *options++ = '\0';
+    }
+
+    if (strcmp(copy, "good") == 0)
+    {
+        edge->kind = SIM_EDGE_GOOD;
+    }
+    else if (strcmp(copy, "bad-routing") == 0)
+    {
+        edge->kind = SIM_EDGE_BAD_ROUTING;
+        edge->approach = SIM_MISBEHAVE_RANDOM;
+        edge->slow_wait = SIM_EDGE_BAD_ROUTING_SLOW_WAIT;
+    }
+    else if (strcmp(copy, "radio-off") == 0)
+    {
+        edge->kind = SIM_EDGE_RADIO_OFF;
+        edge->interval = SIM_EDGE_RADIO_OFF_INTERVAL;
+        edge->duration = SIM_EDGE_RADIO_OFF_DURATION;
+    }
+    else if (strcmp(copy, "dos") == 0)
+    {
+        edge->kind = SIM_EDGE_DOS;
+        edge->loss = SIM_EDGE_DOS_LOSS;
+        edge->delay = SIM_EDGE_DOS_DELAY;
+    }
+    else
+    {
+        fprintf(stderr, "Unknown kind of edge '%s'\n", copy);
+        return false;
+    }
+
+    // Without any options there is nothing more to parse
+    char* saveptr = NULL;
+    for (char* option = (options == NULL) ? NULL : strtok_r(options, ",", &saveptr); option != NULL; option = strtok_r(NULL, ",", &saveptr))
+    {
+        char* value = strchr(option, '=');
+        if (value == NULL || !parse_option(edge, option, (*value++ = '\0', value)))
+        {
+            fprintf(stderr, "Invalid option '%s' for edge '%s'\n", option, spec);
+            return false;
+        }
+    }
+
+    // Addresses in the same form as the motes', fd00::212:4b00:e000:<n>
+    uip_ip6addr(&edge->addr, 0xfd00, 0, 0, 0, 0x0212, 0x4b00, 0xe000, sim_edges_len + 1);
+
+    sim_edges_len += 1;
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+sim_scenario_add(const char* name)
+{
+    for (size_t i = 0; i != CC_ARRAY_SIZE(scenarios); ++i)
+    {
+        if (strcmp(scenarios[i].name, name) != 0)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j != NUM_EDGE_RESOURCES && scenarios[i].edges[j] != NULL; ++j)
+        {
+            if (!sim_edge_add(scenarios[i].edges[j]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    fprintf(stderr, "Unknown scenario '%s'\n", name);
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_scenario_list(void)
+{
+    for (size_t i = 0; i != CC_ARRAY_SIZE(scenarios); ++i)
+    {
+        fprintf(stdout, "%s:", scenarios[i].name);
+
+        for (size_t j = 0; j != NUM_EDGE_RESOURCES && scenarios[i].edges[j] != NULL; ++j)
+        {
+            fprintf(stdout, " %s", scenarios[i].edges[j]);
+        }
+
+        fprintf(stdout, "\n");
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+sim_edge_t*
+sim_edge_find(const uip_ipaddr_t* addr)
+{
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        if (uip_ipaddr_cmp(&sim_edges[i].addr, addr))
+        {
+            return &sim_edges[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+sim_edge_lost(const sim_edge_t* edge, clock_time_t at)
+{
+    switch (edge->kind)
+    {
+    case SIM_EDGE_RADIO_OFF:
+        return (at % (edge->interval + edge->duration)) >= edge->interval;
+
+    case SIM_EDGE_DOS:
+        return sim_random_float() < edge->loss;
+
+    default:
+        return false;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+sim_edge_rtt(const sim_edge_t* edge)
+{
+    clock_time_t rtt = sim_random_between(SIM_EDGE_RTT_MIN, SIM_EDGE_RTT_MAX);
+
+    if (edge->kind == SIM_EDGE_DOS)
+    {
+        rtt += edge->delay;
+    }
+
+    return rtt;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+sim_misbehave_t
+sim_edge_routing_misbehaviour(const sim_edge_t* edge)
+{
+    if (edge->kind != SIM_EDGE_BAD_ROUTING)
+    {
+        return SIM_MISBEHAVE_NONE;
+    }
+
+    // Like PeriodicBad, start off good and then switch every duration
+    if (edge->duration != 0 && ((clock_time() / edge->duration) % 2) == 0)
+    {
+        return SIM_MISBEHAVE_NONE;
+    }
+
+    if (edge->approach == SIM_MISBEHAVE_RANDOM)
+    {
+        return (sim_misbehave_t)(SIM_MISBEHAVE_BAD_RESPONSE + (sim_random_u32() % 3));
+    }
+
+    return edge->approach;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct sim_exchange
+{
+    sim_edge_t* edge;
+    sim_edge_callback_t cb;
+    void* ptr;
+
+    coap_transaction_t transaction;
+
+    // Sent by the edge rather than the node
+    bool from_edge;
+
+} sim_exchange_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+exchange_finished(sim_exchange_t* ex, coap_request_status_t status)
+{
+    ex->cb(ex->edge, status, ex->ptr);
+    sim_free(ex);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+exchange_response(void* ptr)
+{
+    exchange_finished((sim_exchange_t*)ptr, COAP_REQUEST_STATUS_RESPONSE);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+exchange_timeout(void* ptr)
+{
+    exchange_finished((sim_exchange_t*)ptr, COAP_REQUEST_STATUS_TIMEOUT);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+exchange_transmit(void* ptr)
+{
+    sim_exchange_t* ex = (sim_exchange_t*)ptr;
+    coap_transaction_t* t = &ex->transaction;
+
+    const clock_time_t now = clock_time();
+    const clock_time_t rtt = sim_edge_rtt(ex->edge);
+
+    // The node only needs a message from the edge to arrive, a request to the edge also needs its acknowledgement
+    const bool delivered = ex->from_edge
+        ? !sim_edge_lost(ex->edge, now)
+        : !sim_edge_lost(ex->edge, now) && !sim_edge_lost(ex->edge, now + rtt / 2);
+
+    if (delivered)
+    {
+        sim_schedule(ex->from_edge ? rtt / 2 : rtt, exchange_response, ex);
+    }
+    else if (t->retrans_counter < SIM_COAP_MAX_RETRANSMIT)
+    {
+        sim_schedule(t->retrans_interval, exchange_transmit, ex);
+
+        t->retrans_counter += 1;
+        t->retrans_interval <<= 1;
+    }
+    else
+    {
+        sim_schedule(t->retrans_interval, exchange_timeout, ex);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static sim_exchange_t*
+exchange_new(sim_edge_t* edge, sim_edge_callback_t cb, void* ptr, bool from_edge)
+{
+    sim_exchange_t* ex = sim_alloc(sizeof(*ex));
+
+    ex->edge = edge;
+    ex->cb = cb;
+    ex->ptr = ptr;
+    ex->from_edge = from_edge;
+
+    // ACK_TIMEOUT scaled by a random factor in [1, ACK_RANDOM_FACTOR=1.5]
+    memset(&ex->transaction, 0, sizeof(ex->transaction));
+    ex->transaction.retrans_interval = sim_random_between(SIM_COAP_ACK_TIMEOUT, SIM_COAP_ACK_TIMEOUT + SIM_COAP_ACK_TIMEOUT / 2);
+
+    return ex;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_edge_request(sim_edge_t* edge, sim_edge_callback_t cb, void* ptr)
+{
+    sim_exchange_t* ex = exchange_new(edge, cb, ptr, false);
+
+    const edge_resource_t* resource = edge_info_find_addr(&edge->addr);
+    if (resource != NULL)
+    {
+        coap_request_state_t state = {
+            .transaction = &ex->transaction,
+            .status = COAP_REQUEST_STATUS_MORE
+        };
+
+        edge_info_set_coap_timeout(resource, &state);
+    }
+
+    exchange_transmit(ex);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_edge_notify(sim_edge_t* edge, clock_time_t delay, sim_edge_callback_t cb, void* ptr)
+{
+    sim_schedule(delay, exchange_transmit, exchange_new(edge, cb, ptr, true));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
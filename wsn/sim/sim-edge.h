@@ -0,0 +1,144 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "contiki.h"
+#include "os/net/ipv6/uip.h"
+
+#include "coap-request-state.h"
+
+#include "edge-info.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// How the simulated edges behave. Each is a deterministic function of the simulated time and
+// the node's random stream, modelled on the edges and adversaries used by tests/scenarios.
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Round trip time of a message to an edge
+#ifndef SIM_EDGE_RTT_MIN
+#define SIM_EDGE_RTT_MIN (CLOCK_SECOND / 16)
+#endif
+#ifndef SIM_EDGE_RTT_MAX
+#define SIM_EDGE_RTT_MAX (CLOCK_SECOND / 4)
+#endif
+
+// Confirmable messages are retransmitted the same as Contiki-NG's CoAP engine
+#ifndef SIM_COAP_ACK_TIMEOUT
+#define SIM_COAP_ACK_TIMEOUT (2 * CLOCK_SECOND)
+#endif
+#ifndef SIM_COAP_MAX_RETRANSMIT
+#define SIM_COAP_MAX_RETRANSMIT 4
+#endif
+
+// Time the edge takes to find a route
+#ifndef SIM_EDGE_ROUTING_PROCESSING_MIN
+#define SIM_EDGE_ROUTING_PROCESSING_MIN (2 * CLOCK_SECOND)
+#endif
+#ifndef SIM_EDGE_ROUTING_PROCESSING_MAX
+#define SIM_EDGE_ROUTING_PROCESSING_MAX (10 * CLOCK_SECOND)
+#endif
+
+// The route is sent back in this many CoAP blocks
+#ifndef SIM_EDGE_ROUTING_RESULT_BLOCKS
+#define SIM_EDGE_ROUTING_RESULT_BLOCKS 4
+#endif
+#ifndef SIM_EDGE_ROUTING_RESULT_BLOCK_LEN
+#define SIM_EDGE_ROUTING_RESULT_BLOCK_LEN 64
+#endif
+
+// Time the edge takes to solve a challenge
+#ifndef SIM_EDGE_CHALLENGE_SOLVE_MIN
+#define SIM_EDGE_CHALLENGE_SOLVE_MIN (CLOCK_SECOND / 10)
+#endif
+#ifndef SIM_EDGE_CHALLENGE_SOLVE_MAX
+#define SIM_EDGE_CHALLENGE_SOLVE_MAX (5 * CLOCK_SECOND)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    SIM_EDGE_GOOD,
+
+    // resource_rich/applications/bad_routing.py
+    SIM_EDGE_BAD_ROUTING,
+
+    // wsn/adversary/attacks/radio_off.c run on the edge
+    SIM_EDGE_RADIO_OFF,
+
+    // The target of wsn/adversary/attacks/dos_target_network.c
+    SIM_EDGE_DOS,
+} sim_edge_kind_t;
+
+// The same as MISBEHAVE_CHOICES in bad_routing.py
+typedef enum {
+    SIM_MISBEHAVE_NONE,
+    SIM_MISBEHAVE_BAD_RESPONSE,
+    SIM_MISBEHAVE_NO_RESPONSE,
+    SIM_MISBEHAVE_SLOW,
+    SIM_MISBEHAVE_RANDOM,
+} sim_misbehave_t;
+
+typedef enum {
+    SIM_APP_MONITORING,
+    SIM_APP_ROUTING,
+    SIM_APP_CHALLENGE_RESPONSE,
+    SIM_APP_NUM
+} sim_app_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct sim_edge
+{
+    uip_ipaddr_t addr;
+
+    // As given on the command line, for the summary
+    char spec[64];
+
+    sim_edge_kind_t kind;
+
+    // SIM_EDGE_BAD_ROUTING: good then bad for duration in turn, or always bad if duration is 0
+    sim_misbehave_t approach;
+    clock_time_t duration;
+    clock_time_t slow_wait;
+
+    // SIM_EDGE_RADIO_OFF: on for interval then off for duration
+    clock_time_t interval;
+
+    // SIM_EDGE_DOS: chance of each message being dropped and the delay added to the rest
+    float loss;
+    clock_time_t delay;
+
+    // Totals over all nodes simulated
+    uint32_t tasks[SIM_APP_NUM];
+    uint32_t bad_results;
+
+} sim_edge_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+extern sim_edge_t sim_edges[NUM_EDGE_RESOURCES];
+extern uint8_t sim_edges_len;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Add an edge described by "kind[:key=value,...]", see README.md for the options
+bool sim_edge_add(const char* spec);
+
+// Add the edges that tests/scenarios/<name> is run with
+bool sim_scenario_add(const char* name);
+
+void sim_scenario_list(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+sim_edge_t* sim_edge_find(const uip_ipaddr_t* addr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Whether a message sent to or from the edge at this time is dropped
+bool sim_edge_lost(const sim_edge_t* edge, clock_time_t at);
+
+clock_time_t sim_edge_rtt(const sim_edge_t* edge);
+
+// How a routing task submitted now will be handled
+sim_misbehave_t sim_edge_routing_misbehaviour(const sim_edge_t* edge);
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef void (*sim_edge_callback_t)(sim_edge_t* edge, coap_request_status_t status, void* ptr);
+
+// Send a confirmable request from the node to the edge. The retransmission timeout is set by
+// edge_info_set_coap_timeout, as the applications do. cb is called with COAP_REQUEST_STATUS_RESPONSE
+// when the acknowledgement arrives or COAP_REQUEST_STATUS_TIMEOUT when every retransmission was lost.
+void sim_edge_request(sim_edge_t* edge, sim_edge_callback_t cb, void* ptr);
+
+// Send a confirmable request from the edge to the node after delay. cb is called with
+// COAP_REQUEST_STATUS_RESPONSE when it arrives at the node or COAP_REQUEST_STATUS_TIMEOUT
+// when the edge gives up on it.
+void sim_edge_notify(sim_edge_t* edge, clock_time_t delay, sim_edge_callback_t cb, void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
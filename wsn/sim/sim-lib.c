@@ -0,0 +1,232 @@
+#include "contiki.h"
+#include "os/lib/list.h"
+#include "os/lib/memb.h"
+
+#include <string.h>
+
+#include "memb-stats.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Contiki-NG's lists and memory blocks for the host, kept apart from sim-contiki.c so host tests can link them
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+list_init(list_t list)
+{
+    *list = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+list_head(const_list_t list)
+{
+    return *list;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+list_item_next(const void* item)
+{
+    return item == NULL ? NULL : *(void* const*)item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+list_tail(const_list_t list)
+{
+    void* l = *list;
+    if (l == NULL)
+    {
+        return NULL;
+    }
+
+    while (list_item_next(l) != NULL)
+    {
+        l = list_item_next(l);
+    }
+
+    return l;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+list_remove(list_t list, const void* item)
+{
+    for (void** r = list; *r != NULL; r = (void**)*r)
+    {
+        if (*r == item)
+        {
+            *r = *(void**)item;
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+list_add(list_t list, void* item)
+{
+    // Make sure not to add the same item twice
+    list_remove(list, item);
+
+    *(void**)item = NULL;
+
+    void* l = list_tail(list);
+    if (l == NULL)
+    {
+        *list = item;
+    }
+    else
+    {
+        *(void**)l = item;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+list_push(list_t list, void* item)
+{
+    list_remove(list, item);
+
+    *(void**)item = *list;
+    *list = item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+list_pop(list_t list)
+{
+    void* l = *list;
+    if (l != NULL)
+    {
+        *list = *(void**)l;
+    }
+
+    return l;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+list_chop(list_t list)
+{
+    void* l = list_tail(list);
+    if (l != NULL)
+    {
+        list_remove(list, l);
+    }
+
+    return l;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+list_length(const_list_t list)
+{
+    int n = 0;
+
+    for (void* l = *list; l != NULL; l = list_item_next(l))
+    {
+        ++n;
+    }
+
+    return n;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+list_copy(list_t dest, const_list_t src)
+{
+    *dest = *src;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+list_insert(list_t list, void* previtem, void* newitem)
+{
+    if (previtem == NULL)
+    {
+        list_push(list, newitem);
+    }
+    else
+    {
+        list_remove(list, newitem);
+
+        *(void**)newitem = *(void**)previtem;
+        *(void**)previtem = newitem;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+list_contains(const_list_t list, const void* item)
+{
+    for (void* l = *list; l != NULL; l = list_item_next(l))
+    {
+        if (l == item)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_init(struct memb* m)
+{
+    memset(m->used, 0, sizeof(bool) * m->num);
+    memset(m->mem, 0, (size_t)m->size * m->num);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+memb_alloc(struct memb* m)
+{
+    for (unsigned short i = 0; i != m->num; ++i)
+    {
+        if (!m->used[i])
+        {
+            m->used[i] = true;
+            return (char*)m->mem + ((size_t)i * m->size);
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+memb_free(struct memb* m, void* ptr)
+{
+    if (!memb_inmemb(m, ptr))
+    {
+        return -1;
+    }
+
+    m->used[((char*)ptr - (char*)m->mem) / m->size] = false;
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+memb_inmemb(struct memb* m, void* ptr)
+{
+    return (char*)ptr >= (char*)m->mem &&
+           (char*)ptr < (char*)m->mem + ((size_t)m->num * m->size);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+memb_numfree(struct memb* m)
+{
+    int n = 0;
+
+    for (unsigned short i = 0; i != m->num; ++i)
+    {
+        n += !m->used[i];
+    }
+
+    return n;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Pool usage is not tracked, memb-stats.c needs the CoAP engine
+void
+memb_stats_register(struct memb* m, const char* name)
+{
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+memb_stats_alloc(struct memb* m)
+{
+    return memb_alloc(m);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+memb_stats_evicted(struct memb* m)
+{
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,172 @@
+#include "sim-log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+
+#include "contiki.h"
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+int sim_log_level = LOG_LEVEL_DBG;
+
+static FILE* log_file;
+static bool log_at_line_start;
+
+static time_t log_epoch = SIM_DEFAULT_EPOCH;
+
+// The timestamp only changes when the time does
+static char log_prefix[64];
+static clock_time_t log_prefix_time;
+static bool log_prefix_valid;
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+sim_log_open(const char* path)
+{
+    log_file = fopen(path, "w");
+    if (log_file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    log_at_line_start = true;
+    log_prefix_valid = false;
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_log_close(void)
+{
+    if (log_file != NULL)
+    {
+        fclose(log_file);
+        log_file = NULL;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_log_set_epoch(time_t epoch)
+{
+    log_epoch = epoch;
+    log_prefix_valid = false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const char*
+log_timestamp(void)
+{
+    const clock_time_t now = clock_time();
+
+    if (!log_prefix_valid || log_prefix_time != now)
+    {
+        const time_t secs = log_epoch + now / CLOCK_SECOND;
+        const unsigned micros = (now % CLOCK_SECOND) * (1000000 / CLOCK_SECOND);
+
+        struct tm tm;
+        gmtime_r(&secs, &tm);
+
+        const size_t len = strftime(log_prefix, sizeof(log_prefix), "%Y-%m-%dT%H:%M:%S", &tm);
+        snprintf(log_prefix + len, sizeof(log_prefix) - len, ".%06u+00:00 # ", micros);
+
+        log_prefix_time = now;
+        log_prefix_valid = true;
+    }
+
+    return log_prefix;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Write the output as pyterm would have saved it, with the time at the start of each line
+static void
+log_write(const char* s, size_t len)
+{
+    while (len > 0)
+    {
+        if (log_at_line_start)
+        {
+            fputs(log_timestamp(), log_file);
+            log_at_line_start = false;
+        }
+
+        const char* nl = memchr(s, '\n', len);
+        const size_t n = (nl == NULL) ? len : (size_t)(nl - s) + 1;
+
+        fwrite(s, 1, n, log_file);
+
+        if (nl != NULL)
+        {
+            log_at_line_start = true;
+        }
+
+        s += n;
+        len -= n;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+sim_printf(const char* format, ...)
+{
+    if (log_file == NULL)
+    {
+        return 0;
+    }
+
+    char buf[256];
+
+    va_list ap;
+    va_start(ap, format);
+    const int len = vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+
+    if (len < 0)
+    {
+        return len;
+    }
+
+    if ((size_t)len < sizeof(buf))
+    {
+        log_write(buf, len);
+        return len;
+    }
+
+    char* big = malloc(len + 1);
+    if (big == NULL)
+    {
+        return -1;
+    }
+
+    va_start(ap, format);
+    vsnprintf(big, len + 1, format, ap);
+    va_end(ap);
+
+    log_write(big, len);
+    free(big);
+
+    return len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+sim_putchar(int c)
+{
+    if (log_file != NULL)
+    {
+        const char ch = (char)c;
+        log_write(&ch, 1);
+    }
+
+    return c;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+sim_puts(const char* s)
+{
+    if (log_file != NULL)
+    {
+        log_write(s, strlen(s));
+        log_write("\n", 1);
+    }
+
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
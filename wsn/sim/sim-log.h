@@ -0,0 +1,17 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <time.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Output of printf, putchar and puts (see sim-stdio.h) in the format pyterm saves, with the
+// current clock_time() after the epoch at the start of each line. Nothing is written until
+// a log is opened.
+/*-------------------------------------------------------------------------------------------------------------------*/
+// 2022-01-01T00:00:00+00:00, the time that clock_time() of 0 is in the logs
+#define SIM_DEFAULT_EPOCH 1640995200
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool sim_log_open(const char* path);
+void sim_log_close(void);
+
+void sim_log_set_epoch(time_t epoch);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,169 @@
+#include "sim-applications.h"
+
+#ifdef APPLICATION_MONITORING
+
+#include "sim.h"
+#include "sim-edge.h"
+
+#include "monitoring.h"
+#include "trust-models.h"
+#include "trust-choose.h"
+#include "nanocbor-helper.h"
+
+#include "os/sys/log.h"
+#include "coap-log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "A-" MONITORING_APPLICATION_NAME
+#ifdef APP_MONITORING_LOG_LEVEL
+#define LOG_LEVEL APP_MONITORING_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define MSG_BUF_LEN MONITORING_MSG_BUF_LEN
+/*-------------------------------------------------------------------------------------------------------------------*/
+static struct {
+    bool started;
+    bool in_use;
+
+    coap_endpoint_t ep;
+    clock_time_t sent_time;
+    size_t out_len;
+} state;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int
+generate_sensor_data(uint8_t* buf, size_t buf_len)
+{
+    uint32_t time_secs = clock_seconds();
+
+    // Millidegrees and millivolts, as the cc2538 sensors report
+    int temp_value = 20000 + (int)sim_random_between(0, 5000);
+    int vdd3_value = 3300;
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buf, buf_len);
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, time_secs));
+    NANOCBOR_CHECK(nanocbor_fmt_int(&enc, temp_value));
+    NANOCBOR_CHECK(nanocbor_fmt_int(&enc, vdd3_value));
+
+    return nanocbor_encoded_len(&enc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    tm_task_submission_info_t info = {
+        .coap_status = NO_ERROR,
+        .coap_request_status = status
+    };
+
+    state.in_use = false;
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        LOG_DBG("Message send complete with code CONTENT_2_05 (len=%d)\n", 0);
+
+        info.coap_status = CONTENT_2_05;
+    }
+    else
+    {
+        LOG_ERR("Failed to send message due to %s(%d)\n", coap_request_status_to_string(status), status);
+    }
+
+    edge_resource_t* edge = edge_info_find_addr(&state.ep.ipaddr);
+    if (edge == NULL)
+    {
+        return;
+    }
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        edge_info_rtt_update(edge, clock_time() - state.sent_time);
+    }
+
+    edge_capability_t* cap = edge_info_capability_find(edge, MONITORING_APPLICATION_NAME);
+    if (cap == NULL)
+    {
+        return;
+    }
+
+    tm_update_task_submission(edge, cap, &info);
+
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    const tm_throughput_info_t throughput_info = {
+        .direction = TM_THROUGHPUT_OUT,
+        .throughput = sim_throughput(state.out_len, clock_time() - state.sent_time)
+    };
+
+    tm_update_task_throughput(edge, cap, &throughput_info);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+periodic_action(void* ptr)
+{
+    sim_schedule(MONITORING_PUBLISH_PERIOD, periodic_action, NULL);
+
+    if (state.in_use)
+    {
+        LOG_WARN("Cannot generate a new message, as in process of sending one\n");
+        return;
+    }
+
+    uint8_t msg_buf[MSG_BUF_LEN];
+    int len = generate_sensor_data(msg_buf, MSG_BUF_LEN);
+    if (len <= 0 || len > MSG_BUF_LEN)
+    {
+        LOG_ERR("Failed to generated message (%d)\n", len);
+        return;
+    }
+
+    LOG_DBG("Generated message (len=%d)\n", len);
+
+    // Choose an Edge node to send information to
+    edge_resource_t* edge = choose_edge(MONITORING_APPLICATION_NAME);
+    if (edge == NULL)
+    {
+        LOG_ERR("Failed to find an edge resource to send task to\n");
+        return;
+    }
+
+    sim_edge_t* sim_edge = sim_edge_find(&edge->ep.ipaddr);
+
+    state.ep = edge->ep;
+    state.sent_time = clock_time();
+    state.out_len = len;
+    state.in_use = true;
+
+    sim_edge->tasks[SIM_APP_MONITORING] += 1;
+
+    sim_edge_request(sim_edge, send_callback, NULL);
+
+    LOG_DBG("Message sent to ");
+    LOG_DBG_COAP_EP(&state.ep);
+    LOG_DBG_("\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_monitoring_init(void)
+{
+    init_trust_weights_monitoring();
+
+    memset(&state, 0, sizeof(state));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_monitoring_edge_added(edge_resource_t* edge)
+{
+    if (!state.started)
+    {
+        LOG_INFO("Starting periodic timer to send information\n");
+
+        state.started = true;
+        sim_schedule(MONITORING_PUBLISH_PERIOD, periodic_action, NULL);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,50 @@
+#include "sim-random.h"
+
+#include "os/lib/random.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t rng_state;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// splitmix64, so that each stream only depends on the seed and its index
+static uint64_t
+splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_random_seed(uint64_t seed, unsigned stream)
+{
+    rng_state = seed;
+    rng_state = splitmix64(&rng_state) ^ stream;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint32_t
+sim_random_u32(void)
+{
+    return (uint32_t)(splitmix64(&rng_state) >> 32);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+float
+sim_random_float(void)
+{
+    // 24 bits, so the result is exactly representable and never rounds up to 1
+    return (float)(sim_random_u32() >> 8) / (float)(1U << 24);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+sim_random_between(clock_time_t min, clock_time_t max)
+{
+    const uint64_t range = (uint64_t)max - min + 1;
+
+    return min + (clock_time_t)(((uint64_t)sim_random_u32() * range) >> 32);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned short
+random_rand(void)
+{
+    return (unsigned short)(sim_random_u32() >> 16);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
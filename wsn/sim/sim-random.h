@@ -0,0 +1,19 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The random stream used by the simulated node, including random_rand() for the trust stack
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Each stream only depends on the seed and its index
+void sim_random_seed(uint64_t seed, unsigned stream);
+
+uint32_t sim_random_u32(void);
+
+// Uniformly distributed in [0, 1)
+float sim_random_float(void);
+
+// Uniformly distributed in [min, max]
+clock_time_t sim_random_between(clock_time_t min, clock_time_t max);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,464 @@
+#include "sim-applications.h"
+
+#ifdef APPLICATION_ROUTING
+
+#include "sim.h"
+#include "sim-edge.h"
+
+#include "routing.h"
+#include "applications.h"
+#include "trust-models.h"
+#include "trust-choose.h"
+#include "nanocbor-helper.h"
+
+#include "os/sys/log.h"
+#include "coap-log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "A-" ROUTING_APPLICATION_NAME
+#ifdef APP_ROUTING_LOG_LEVEL
+#define LOG_LEVEL APP_ROUTING_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define MSG_BUF_LEN ((1) + (1 + sizeof(uint32_t)) + 2*((1) + 2*(1 + sizeof(float))))
+/*-------------------------------------------------------------------------------------------------------------------*/
+static struct {
+    // Events for earlier tasks are ignored
+    uint32_t task_id;
+
+    // The same as the task_in_use lock, expires when nothing is heard from the edge for deadline
+    bool in_use;
+    clock_time_t deadline;
+    clock_time_t last_heard;
+
+    coap_endpoint_t ep;
+    coordinate_t src, dest;
+
+    clock_time_t sent_time;
+    size_t out_len;
+
+    clock_time_t in_time;
+    size_t in_len;
+
+    // How the edge is handling the task
+    sim_misbehave_t misbehaviour;
+    pyroutelib3_status_t status;
+    bool result_good;
+    uint8_t next_block;
+} state;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int
+generate_routing_request(uint8_t* buf, size_t buf_len, const coordinate_t* source, const coordinate_t* destination)
+{
+    uint32_t time_secs = clock_seconds();
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buf, buf_len);
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, time_secs));
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 2));
+    NANOCBOR_CHECK(nanocbor_fmt_float(&enc, source->latitude));
+    NANOCBOR_CHECK(nanocbor_fmt_float(&enc, source->longitude));
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 2));
+    NANOCBOR_CHECK(nanocbor_fmt_float(&enc, destination->latitude));
+    NANOCBOR_CHECK(nanocbor_fmt_float(&enc, destination->longitude));
+
+    return nanocbor_encoded_len(&enc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+current_task(void* ptr)
+{
+    return state.in_use && (uint32_t)(uintptr_t)ptr == state.task_id;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_capability_t*
+find_capability(edge_resource_t** edge)
+{
+    *edge = edge_info_find_addr(&state.ep.ipaddr);
+    if (*edge == NULL)
+    {
+        return NULL;
+    }
+
+    return edge_info_capability_find(*edge, ROUTING_APPLICATION_NAME);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+routing_process_task_timeout(void)
+{
+    LOG_WARN("Timed out while waiting for response for the routing task\n");
+
+    state.in_use = false;
+
+    edge_resource_t* edge;
+    edge_capability_t* cap = find_capability(&edge);
+    if (cap == NULL)
+    {
+        return;
+    }
+
+    edge_capability_task_finished(cap);
+
+    // When the response times out, we need to log that an error occurred
+    const tm_task_result_info_t info = {
+        .result = TM_TASK_RESULT_INFO_TIMEOUT
+    };
+    tm_update_task_result(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+task_timer_callback(void* ptr)
+{
+    if (!current_task(ptr))
+    {
+        return;
+    }
+
+    // Restarted by a message from the edge since this was set
+    const clock_time_t expires = state.last_heard + state.deadline;
+    if (clock_time() < expires)
+    {
+        sim_schedule(expires - clock_time(), task_timer_callback, ptr);
+        return;
+    }
+
+    routing_process_task_timeout();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_result_block(sim_edge_t* sim_edge, void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+result_block_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    // The edge gave up, so the node will time out
+    if (status != COAP_REQUEST_STATUS_RESPONSE || !current_task(ptr))
+    {
+        return;
+    }
+
+    state.last_heard = clock_time();
+
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    state.in_len += SIM_EDGE_ROUTING_RESULT_BLOCK_LEN;
+#endif
+
+    state.next_block += 1;
+
+    if (state.next_block != SIM_EDGE_ROUTING_RESULT_BLOCKS)
+    {
+        send_result_block(sim_edge, ptr);
+        return;
+    }
+
+    state.in_use = false;
+
+    edge_resource_t* edge;
+    edge_capability_t* cap = find_capability(&edge);
+    if (cap == NULL)
+    {
+        return;
+    }
+
+    edge_capability_task_finished(cap);
+
+    const tm_result_quality_info_t info = {
+        .good = state.result_good
+    };
+
+    if (!info.good)
+    {
+        LOG_WARN("Bad result from edge first=(%f,%f) src=(%f,%f) not close enough\n",
+            state.dest.latitude, state.dest.longitude, state.src.latitude, state.src.longitude);
+    }
+
+    tm_update_result_quality(edge, cap, &info);
+
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    const tm_throughput_info_t throughput_info = {
+        .direction = TM_THROUGHPUT_IN,
+        .throughput = sim_throughput(state.in_len, clock_time() - state.in_time)
+    };
+
+    tm_update_task_throughput(edge, cap, &throughput_info);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_result_block(sim_edge_t* sim_edge, void* ptr)
+{
+    // bad_routing.py waits before sending each block when slow
+    const clock_time_t wait = (state.misbehaviour == SIM_MISBEHAVE_SLOW) ? sim_edge->slow_wait : 0;
+
+    sim_edge_notify(sim_edge, wait, result_block_callback, ptr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+status_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    if (status != COAP_REQUEST_STATUS_RESPONSE)
+    {
+        return;
+    }
+
+    if (!current_task(ptr))
+    {
+        LOG_ERR("Received a task response that we were not expecting\n");
+        return;
+    }
+
+    state.last_heard = clock_time();
+
+    const pyroutelib3_status_t result = state.status;
+
+    if (result == ROUTING_SUCCESS)
+    {
+        LOG_INFO("Routing task succeeded, waiting for task result data from server...\n");
+    }
+    else
+    {
+        LOG_ERR("Routing task failed with error %"PRIu32"\n", (uint32_t)result);
+    }
+
+    edge_resource_t* edge;
+    edge_capability_t* cap = find_capability(&edge);
+    if (cap == NULL)
+    {
+        return;
+    }
+
+    // Update trust model with notification of task success/failure
+    const tm_task_result_info_t info = {
+        .result = (result == ROUTING_SUCCESS) ? TM_TASK_RESULT_INFO_SUCCESS : TM_TASK_RESULT_INFO_FAIL
+    };
+    tm_update_task_result(edge, cap, &info);
+
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    // The status is a single CBOR unsigned integer
+    state.in_time = clock_time();
+    state.in_len = 1;
+#endif
+
+    // The result only follows a successful status, otherwise the node waits until the task times out
+    if (result == ROUTING_SUCCESS)
+    {
+        state.next_block = 0;
+        send_result_block(sim_edge, ptr);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The edge has accepted the task, so process it the way the edge is configured to
+static void
+edge_process_task(sim_edge_t* sim_edge, void* ptr)
+{
+    state.misbehaviour = sim_edge_routing_misbehaviour(sim_edge);
+    state.status = ROUTING_SUCCESS;
+    state.result_good = true;
+
+    const clock_time_t processing = sim_random_between(SIM_EDGE_ROUTING_PROCESSING_MIN, SIM_EDGE_ROUTING_PROCESSING_MAX);
+
+    switch (state.misbehaviour)
+    {
+    case SIM_MISBEHAVE_NONE:
+        sim_edge_notify(sim_edge, processing, status_callback, ptr);
+        break;
+
+    case SIM_MISBEHAVE_BAD_RESPONSE:
+        // The same as BAD_RESPONSE_CHOICES: "success" with a wrong route, "no_route" or "gave_up"
+        switch (sim_random_between(0, 2))
+        {
+        case 0: state.result_good = false; break;
+        case 1: state.status = ROUTING_NO_ROUTE; break;
+        default: state.status = ROUTING_GAVE_UP; break;
+        }
+        sim_edge_notify(sim_edge, 0, status_callback, ptr);
+        break;
+
+    case SIM_MISBEHAVE_SLOW:
+        sim_edge_notify(sim_edge, processing, status_callback, ptr);
+        break;
+
+    default:
+        // Never responds
+        break;
+    }
+
+    if (state.misbehaviour != SIM_MISBEHAVE_NONE)
+    {
+        sim_edge->bad_results += 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+send_callback(sim_edge_t* sim_edge, coap_request_status_t status, void* ptr)
+{
+    tm_task_submission_info_t info = {
+        .coap_status = NO_ERROR,
+        .coap_request_status = status
+    };
+
+    if ((uint32_t)(uintptr_t)ptr != state.task_id)
+    {
+        return;
+    }
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        LOG_DBG("Message send complete with code CONTENT_2_05 (len=%d)\n", (int)APPLICATION_STATS_MAX_CBOR_LENGTH);
+
+        info.coap_status = CONTENT_2_05;
+    }
+    else
+    {
+        LOG_ERR("Failed to send message due to %s(%d)\n", coap_request_status_to_string(status), status);
+        state.in_use = false;
+    }
+
+    edge_resource_t* edge;
+    edge_capability_t* cap = find_capability(&edge);
+    if (cap == NULL)
+    {
+        return;
+    }
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        edge_info_rtt_update(edge, clock_time() - state.sent_time);
+
+        // The edge reports the mean and variance of the uniformly distributed processing time
+        const uint32_t range = SIM_EDGE_ROUTING_PROCESSING_MAX - SIM_EDGE_ROUTING_PROCESSING_MIN;
+        edge_capability_load_stats(cap,
+            (SIM_EDGE_ROUTING_PROCESSING_MIN + SIM_EDGE_ROUTING_PROCESSING_MAX) / 2,
+            (range * range) / 12);
+
+        // Only the task just submitted is queued
+        edge_capability_queue_depth(cap, 1);
+    }
+    else
+    {
+        edge_capability_task_finished(cap);
+    }
+
+    tm_update_task_submission(edge, cap, &info);
+
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    const tm_throughput_info_t throughput_info = {
+        .direction = TM_THROUGHPUT_OUT,
+        .throughput = sim_throughput(state.out_len, clock_time() - state.sent_time)
+    };
+
+    tm_update_task_throughput(edge, cap, &throughput_info);
+#endif
+
+    if (status == COAP_REQUEST_STATUS_RESPONSE)
+    {
+        edge_process_task(sim_edge, ptr);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+dispatch_action(void)
+{
+    if (state.in_use)
+    {
+        LOG_WARN("Cannot generate a new task, as in process of sending or processing one\n");
+        return;
+    }
+
+    // Choose an Edge node to send information to
+    edge_resource_t* edge = choose_edge(ROUTING_APPLICATION_NAME);
+    if (edge == NULL)
+    {
+        LOG_ERR("Failed to find an edge resource to send task to\n");
+        return;
+    }
+
+    uint8_t msg_buf[MSG_BUF_LEN];
+    int len = generate_routing_request(msg_buf, sizeof(msg_buf), &state.src, &state.dest);
+    if (len <= 0 || len > sizeof(msg_buf))
+    {
+        LOG_ERR("Failed to generated message (%d)\n", len);
+        return;
+    }
+
+    LOG_DBG("Generated message (len=%d) for path from (%f,%f) to (%f,%f)\n",
+        len,
+        state.src.latitude, state.src.longitude,
+        state.dest.latitude, state.dest.longitude);
+
+    sim_edge_t* sim_edge = sim_edge_find(&edge->ep.ipaddr);
+
+    state.task_id += 1;
+    state.ep = edge->ep;
+    state.out_len = len;
+
+    // Allow slower edges longer to respond
+    state.deadline = edge_info_deadline(edge, ROUTING_TASK_PROCESSING_TIME);
+    state.sent_time = state.last_heard = clock_time();
+    state.in_use = true;
+
+    void* ptr = (void*)(uintptr_t)state.task_id;
+
+    sim_schedule(state.deadline, task_timer_callback, ptr);
+    sim_edge_request(sim_edge, send_callback, ptr);
+
+    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    if (cap != NULL)
+    {
+        edge_capability_task_started(cap);
+    }
+
+    sim_edge->tasks[SIM_APP_ROUTING] += 1;
+
+    LOG_DBG("Message sent to ");
+    LOG_DBG_COAP_EP(&state.ep);
+    LOG_DBG_("\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+periodic_event(void* ptr)
+{
+    LOG_INFO("Periodic timer triggered, generating fake routing request\n");
+
+    if (!edge_info_has_active_capability(ROUTING_APPLICATION_NAME))
+    {
+        LOG_WARN("No Edge servers available to process request\n");
+    }
+    else
+    {
+        // UoW to Warwick Castle
+        state.src = (coordinate_t){ 52.384057f, -1.561737f };
+        state.dest = (coordinate_t){ 52.280302f, -1.586839f };
+
+        dispatch_action();
+    }
+
+    // Restart timer
+    uint16_t rnd_period = routing_generate_route_period();
+    sim_schedule(rnd_period * CLOCK_SECOND, periodic_event, NULL);
+
+    LOG_INFO("Restarted timer to generate route request in %" PRIu16 " seconds\n", rnd_period);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_routing_init(void)
+{
+    init_trust_weights_routing();
+
+    memset(&state, 0, sizeof(state));
+
+    uint16_t rnd_period = routing_generate_route_period();
+    sim_schedule(rnd_period * CLOCK_SECOND, periodic_event, NULL);
+
+    LOG_INFO("Started timer to generate route request in %" PRIu16 " seconds\n", rnd_period);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_routing_edge_added(edge_resource_t* edge)
+{
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
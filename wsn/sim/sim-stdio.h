@@ -0,0 +1,18 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Included before every source file (see Makefile), so that output from the trust stack goes
+// to the log of the node being simulated with the same timestamps that pyterm adds.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+
+// Some of the firmware relies on the toolchain providing the PRI macros without including this
+#include <inttypes.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+int sim_printf(const char* format, ...) __attribute__((__format__(__printf__, 1, 2)));
+int sim_putchar(int c);
+int sim_puts(const char* s);
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define printf(...) sim_printf(__VA_ARGS__)
+#define putchar(c) sim_putchar(c)
+#define puts(s) sim_puts(s)
+/*-------------------------------------------------------------------------------------------------------------------*/
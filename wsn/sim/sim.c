@@ -0,0 +1,620 @@
+#include "sim.h"
+#include "sim-edge.h"
+#include "sim-log.h"
+#include "sim-applications.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "applications.h"
+#include "edge-info.h"
+#include "peer-info.h"
+#include "trust-models.h"
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Edges are announced here instead of by trust-common.c
+#define LOG_MODULE "trust-comm"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Edges announce themselves at a random time in [0, this) after the node starts
+#ifndef SIM_EDGE_ANNOUNCE_MAX
+#define SIM_EDGE_ANNOUNCE_MAX (30 * CLOCK_SECOND)
+#endif
+
+// clock_time_t counts milliseconds in 32 bits, so keep well clear of it wrapping
+#define SIM_MAX_DURATION (INT32_MAX / CLOCK_SECOND)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct sim_event
+{
+    clock_time_t time;
+
+    // Orders events due at the same time
+    uint64_t seq;
+
+    sim_callback_t cb;
+    void* ptr;
+
+} sim_event_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Binary min-heap of pending events
+static sim_event_t* queue;
+static size_t queue_len;
+static size_t queue_capacity;
+static uint64_t queue_seq;
+
+static clock_time_t now;
+
+// Totals over all nodes simulated
+static uint64_t events_run;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct sim_allocation
+{
+    struct sim_allocation* prev;
+    struct sim_allocation* next;
+} sim_allocation_t;
+
+static sim_allocation_t* allocations;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void*
+checked_realloc(void* ptr, size_t size)
+{
+    void* result = realloc(ptr, size);
+    if (result == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+event_before(const sim_event_t* a, const sim_event_t* b)
+{
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_schedule(clock_time_t delay, sim_callback_t cb, void* ptr)
+{
+    if (queue_len == queue_capacity)
+    {
+        queue_capacity = queue_capacity == 0 ? 64 : queue_capacity * 2;
+        queue = checked_realloc(queue, queue_capacity * sizeof(*queue));
+    }
+
+    const sim_event_t ev = {
+        .time = now + delay,
+        .seq = queue_seq++,
+        .cb = cb,
+        .ptr = ptr,
+    };
+
+    // Sift up
+    size_t i = queue_len++;
+    while (i > 0)
+    {
+        const size_t parent = (i - 1) / 2;
+        if (!event_before(&ev, &queue[parent]))
+        {
+            break;
+        }
+
+        queue[i] = queue[parent];
+        i = parent;
+    }
+
+    queue[i] = ev;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static sim_event_t
+queue_pop(void)
+{
+    const sim_event_t top = queue[0];
+    const sim_event_t last = queue[--queue_len];
+
+    // Sift down
+    size_t i = 0;
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= queue_len)
+        {
+            break;
+        }
+
+        if (child + 1 < queue_len && event_before(&queue[child + 1], &queue[child]))
+        {
+            child += 1;
+        }
+
+        if (!event_before(&queue[child], &last))
+        {
+            break;
+        }
+
+        queue[i] = queue[child];
+        i = child;
+    }
+
+    if (queue_len > 0)
+    {
+        queue[i] = last;
+    }
+
+    return top;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+    return now;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned long
+clock_seconds(void)
+{
+    return now / CLOCK_SECOND;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void*
+sim_alloc(size_t size)
+{
+    sim_allocation_t* a = checked_realloc(NULL, sizeof(*a) + size);
+
+    a->prev = NULL;
+    a->next = allocations;
+    if (allocations != NULL)
+    {
+        allocations->prev = a;
+    }
+    allocations = a;
+
+    return a + 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+sim_free(void* ptr)
+{
+    sim_allocation_t* a = (sim_allocation_t*)ptr - 1;
+
+    if (a->prev != NULL)
+    {
+        a->prev->next = a->next;
+    }
+    else
+    {
+        allocations = a->next;
+    }
+
+    if (a->next != NULL)
+    {
+        a->next->prev = a->prev;
+    }
+
+    free(a);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+sim_free_all(void)
+{
+    while (allocations != NULL)
+    {
+        sim_allocation_t* next = allocations->next;
+        free(allocations);
+        allocations = next;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint32_t
+sim_throughput(size_t len, clock_time_t duration)
+{
+    // Anything faster than a tick is counted as taking a tick
+    if (duration == 0)
+    {
+        duration = 1;
+    }
+
+    return (uint32_t)((len * CLOCK_SECOND + duration - 1) / duration);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+edge_announce(void* ptr)
+{
+    sim_edge_t* sim_edge = (sim_edge_t*)ptr;
+
+    edge_resource_t* edge = edge_info_add(&sim_edge->addr);
+    if (edge == NULL)
+    {
+        LOG_ERR("Failed to allocate edge resource ");
+        LOG_ERR_6ADDR(&sim_edge->addr);
+        LOG_ERR_("\n");
+        return;
+    }
+
+    edge->flags |= EDGE_RESOURCE_ACTIVE;
+
+    static const char* const application_names[] = APPLICATION_NAMES;
+
+    for (size_t i = 0; i != CC_ARRAY_SIZE(application_names); ++i)
+    {
+        edge_capability_t* capability = edge_info_capability_add(edge, application_names[i]);
+        if (capability == NULL)
+        {
+            LOG_ERR("Failed to create capability (%s) for edge with identity ", application_names[i]);
+            LOG_ERR_6ADDR(&edge->ep.ipaddr);
+            LOG_ERR_("\n");
+            continue;
+        }
+
+        LOG_INFO("Added capability (%s) for edge with identity ", application_names[i]);
+        LOG_INFO_6ADDR(&edge->ep.ipaddr);
+        LOG_INFO_("\n");
+
+        capability->flags |= EDGE_CAPABILITY_ACTIVE;
+    }
+
+#ifdef APPLICATION_MONITORING
+    sim_monitoring_edge_added(edge);
+#endif
+#ifdef APPLICATION_ROUTING
+    sim_routing_edge_added(edge);
+#endif
+#ifdef APPLICATION_CHALLENGE_RESPONSE
+    sim_challenge_response_edge_added(edge);
+#endif
+#ifdef TRUST_MODEL_PERIODIC_EDGE_PING
+    sim_edge_ping_edge_added(edge);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+node_address(unsigned node, uip_ipaddr_t* addr)
+{
+    uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x0212, 0x4b00, 0xd000, node);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+simulate_node(unsigned node, uint64_t seed, clock_time_t duration, const char* log_dir)
+{
+    queue_len = 0;
+    queue_seq = 0;
+    now = 0;
+
+    sim_random_seed(seed, node);
+
+    if (log_dir != NULL)
+    {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/wsn.sim%u.pyterm.log", log_dir, node);
+
+        if (!sim_log_open(path))
+        {
+            return false;
+        }
+    }
+
+    edge_info_init();
+    peer_info_init();
+    trust_weights_init();
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+    trust_throughput_thresholds_init();
+#endif
+
+#ifdef APPLICATION_MONITORING
+    sim_monitoring_init();
+#endif
+#ifdef APPLICATION_ROUTING
+    sim_routing_init();
+#endif
+#ifdef APPLICATION_CHALLENGE_RESPONSE
+    sim_challenge_response_init();
+#endif
+#ifdef TRUST_MODEL_PERIODIC_EDGE_PING
+    sim_edge_ping_init();
+#endif
+
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        sim_schedule(sim_random_between(0, SIM_EDGE_ANNOUNCE_MAX - 1), edge_announce, &sim_edges[i]);
+    }
+
+    while (queue_len > 0 && queue[0].time <= duration)
+    {
+        const sim_event_t ev = queue_pop();
+
+        now = ev.time;
+        ev.cb(ev.ptr);
+
+        events_run += 1;
+    }
+
+    // Anything still in flight when the node stops
+    sim_free_all();
+
+    sim_log_close();
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+format_address(const uip_ipaddr_t* addr, char* buf, size_t len)
+{
+    snprintf(buf, len, "fd00::%x:%x:%x:%x",
+        UIP_HTONS(addr->u16[4]), UIP_HTONS(addr->u16[5]), UIP_HTONS(addr->u16[6]), UIP_HTONS(addr->u16[7]));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The same as common/configuration.py, so the analysis scripts can name the simulated devices
+static bool
+write_configuration(const char* log_dir, unsigned nodes)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/configuration.py", log_dir);
+
+    FILE* f = fopen(path, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    char addr[64];
+
+    fprintf(f, "from common.stereotype_tags import StereotypeTags, DeviceClass\n\n");
+    fprintf(f, "from ipaddress import IPv6Address\n\n");
+
+    fprintf(f, "hostname_to_ips = {\n");
+    for (unsigned node = 1; node <= nodes; ++node)
+    {
+        uip_ipaddr_t ipaddr;
+        node_address(node, &ipaddr);
+        format_address(&ipaddr, addr, sizeof(addr));
+        fprintf(f, "    \"sim%u\": IPv6Address(\"%s\"),\n", node, addr);
+    }
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        format_address(&sim_edges[i].addr, addr, sizeof(addr));
+        fprintf(f, "    \"edge%u\": IPv6Address(\"%s\"),\n", i + 1, addr);
+    }
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "root_node = None\n\n");
+
+    fprintf(f, "device_stereotypes = {\n");
+    for (unsigned node = 1; node <= nodes; ++node)
+    {
+        fprintf(f, "    \"sim%u\": StereotypeTags(device_class=DeviceClass.IOT_MEDIUM),\n", node);
+    }
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        fprintf(f, "    \"edge%u\": StereotypeTags(device_class=DeviceClass.RASPBERRY_PI),\n", i + 1);
+    }
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "hostname_to_names = {\n");
+    for (unsigned node = 1; node <= nodes; ++node)
+    {
+        fprintf(f, "    \"sim%u\": \"sim%u\",\n", node, node);
+    }
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        // Named by behaviour, so the graphs show which edge was which
+        fprintf(f, "    \"edge%u\": \"%s\",\n", i + 1, sim_edges[i].spec);
+    }
+    fprintf(f, "}\n");
+
+    fclose(f);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+print_summary(unsigned nodes, clock_time_t duration, double elapsed)
+{
+    fprintf(stdout, "Simulated %u node(s) for %lu s each in %.3f s (%llu events)\n",
+        nodes, (unsigned long)(duration / CLOCK_SECOND), elapsed, (unsigned long long)events_run);
+
+    fprintf(stdout, "%-6s %-48s %8s %8s %8s %8s\n", "edge", "behaviour", "envmon", "routing", "cr", "bad");
+
+    for (uint8_t i = 0; i != sim_edges_len; ++i)
+    {
+        const sim_edge_t* edge = &sim_edges[i];
+
+        fprintf(stdout, "edge%-2u %-48s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n",
+            i + 1, edge->spec,
+            edge->tasks[SIM_APP_MONITORING],
+            edge->tasks[SIM_APP_ROUTING],
+            edge->tasks[SIM_APP_CHALLENGE_RESPONSE],
+            edge->bad_results);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --nodes N           Number of IoT nodes to simulate (default 1)\n"
+        "  --duration SECS     Simulated time per node (default 3600)\n"
+        "  --seed N            Seed for the random streams (default 0)\n"
+        "  --scenario NAME     Use the edges of tests/scenarios/NAME\n"
+        "  --edge SPEC         Add an edge, kind[:key=value,...] (repeatable)\n"
+        "  --log-dir DIR       Write wsn.simN.pyterm.log for each node to DIR\n"
+        "  --log-level N       Most verbose log level to output, 0 (none) to 4 (debug)\n"
+        "  --epoch SECS        Unix time that each node starts at in the logs\n"
+        "  --list-scenarios    List the scenarios and exit\n",
+        name);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+parse_unsigned(const char* value, unsigned long long max, unsigned long long* result)
+{
+    char* end;
+    errno = 0;
+    const unsigned long long parsed = strtoull(value, &end, 0);
+
+    if (errno != 0 || end == value || *end != '\0' || parsed > max)
+    {
+        return false;
+    }
+
+    *result = parsed;
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    static const struct option options[] = {
+        { "nodes", required_argument, NULL, 'n' },
+        { "duration", required_argument, NULL, 'd' },
+        { "seed", required_argument, NULL, 's' },
+        { "scenario", required_argument, NULL, 'c' },
+        { "edge", required_argument, NULL, 'e' },
+        { "log-dir", required_argument, NULL, 'o' },
+        { "log-level", required_argument, NULL, 'l' },
+        { "epoch", required_argument, NULL, 't' },
+        { "list-scenarios", no_argument, NULL, 'L' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    unsigned long long nodes = 1;
+    unsigned long long duration = 3600;
+    unsigned long long seed = 0;
+    unsigned long long value;
+    const char* log_dir = NULL;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            if (!parse_unsigned(optarg, UINT16_MAX, &nodes) || nodes == 0)
+            {
+                fprintf(stderr, "Invalid number of nodes '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 'd':
+            if (!parse_unsigned(optarg, SIM_MAX_DURATION, &duration))
+            {
+                fprintf(stderr, "Invalid duration '%s', must be at most %d seconds\n", optarg, SIM_MAX_DURATION);
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 's':
+            if (!parse_unsigned(optarg, UINT64_MAX, &seed))
+            {
+                fprintf(stderr, "Invalid seed '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 'c':
+            if (!sim_scenario_add(optarg))
+            {
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 'e':
+            if (!sim_edge_add(optarg))
+            {
+                return EXIT_FAILURE;
+            }
+            break;
+
+        case 'o':
+            log_dir = optarg;
+            break;
+
+        case 'l':
+            if (!parse_unsigned(optarg, LOG_LEVEL_DBG, &value))
+            {
+                fprintf(stderr, "Invalid log level '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            sim_log_level = (int)value;
+            break;
+
+        case 't':
+            if (!parse_unsigned(optarg, INT32_MAX, &value))
+            {
+                fprintf(stderr, "Invalid epoch '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            sim_log_set_epoch((time_t)value);
+            break;
+
+        case 'L':
+            sim_scenario_list();
+            return EXIT_SUCCESS;
+
+        case 'h':
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != argc)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (sim_edges_len == 0)
+    {
+        fprintf(stderr, "No edges to simulate, use --scenario or --edge\n");
+        return EXIT_FAILURE;
+    }
+
+    if (log_dir != NULL && !write_configuration(log_dir, (unsigned)nodes))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Nothing is written without a log directory, so do not spend time formatting it
+    if (log_dir == NULL)
+    {
+        sim_log_level = LOG_LEVEL_NONE;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned node = 1; node <= nodes; ++node)
+    {
+        if (!simulate_node(node, seed, (clock_time_t)(duration * CLOCK_SECOND), log_dir))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    print_summary((unsigned)nodes, (clock_time_t)(duration * CLOCK_SECOND), elapsed);
+
+    free(queue);
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,27 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "contiki.h"
+#include "sim-random.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Discrete event simulation of a node running the trust stack. Nodes are simulated one after
+// another, each with its own trust state, event queue and random stream derived from the seed.
+// The same seed and options always produce the same logs.
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef void (*sim_callback_t)(void* ptr);
+
+// Call cb(ptr) once delay ticks of simulated time have passed. Events due at the
+// same time are run in the order they were scheduled.
+void sim_schedule(clock_time_t delay, sim_callback_t cb, void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Memory for messages in flight. Anything not freed when the node finishes is released then,
+// along with the events that would have freed it.
+void* sim_alloc(size_t size);
+void sim_free(void* ptr);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Bytes per second, calculated the same way as app_state_throughput_end_out
+uint32_t sim_throughput(size_t len, clock_time_t duration);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,22 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The values match Contiki-NG's os/net/app-layer/coap/coap-constants.h
+#define COAP_DEFAULT_PORT 5683
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    NO_ERROR = 0,
+
+    CREATED_2_01 = 65,
+    DELETED_2_02 = 66,
+    VALID_2_03 = 67,
+    CHANGED_2_04 = 68,
+    CONTENT_2_05 = 69,
+
+    BAD_REQUEST_4_00 = 128,
+    NOT_FOUND_4_04 = 132,
+
+    INTERNAL_SERVER_ERROR_5_00 = 160,
+    SERVICE_UNAVAILABLE_5_03 = 163,
+    GATEWAY_TIMEOUT_5_04 = 164,
+} coap_status_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
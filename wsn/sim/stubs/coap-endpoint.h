@@ -0,0 +1,12 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "os/net/ipv6/uip.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uip_ipaddr_t ipaddr;
+    uint16_t port;
+    uint8_t secure;
+} coap_endpoint_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
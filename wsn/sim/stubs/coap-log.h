@@ -0,0 +1,21 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "coap-endpoint.h"
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Logs an endpoint as coap://[addr]:port, the same as Contiki-NG's coap_endpoint_log
+void coap_endpoint_log(const coap_endpoint_t* ep);
+
+#define LOG_COAP_EP(level, ep) \
+    do { \
+        if (LOG_ENABLED(level)) \
+        { \
+            coap_endpoint_log(ep); \
+        } \
+    } while (0)
+
+#define LOG_ERR_COAP_EP(ep)  LOG_COAP_EP(LOG_LEVEL_ERR, ep)
+#define LOG_WARN_COAP_EP(ep) LOG_COAP_EP(LOG_LEVEL_WARN, ep)
+#define LOG_INFO_COAP_EP(ep) LOG_COAP_EP(LOG_LEVEL_INFO, ep)
+#define LOG_DBG_COAP_EP(ep)  LOG_COAP_EP(LOG_LEVEL_DBG, ep)
+/*-------------------------------------------------------------------------------------------------------------------*/
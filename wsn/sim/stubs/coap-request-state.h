@@ -0,0 +1,20 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "coap-transactions.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The values match Contiki-NG's os/net/app-layer/coap/coap-request-state.h
+typedef enum {
+    COAP_REQUEST_STATUS_RESPONSE,
+    COAP_REQUEST_STATUS_MORE,
+    COAP_REQUEST_STATUS_FINISHED,
+    COAP_REQUEST_STATUS_TIMEOUT,
+    COAP_REQUEST_STATUS_BLOCK_ERROR
+} coap_request_status_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct coap_request_state {
+    coap_transaction_t* transaction;
+    coap_request_status_t status;
+} coap_request_state_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char* coap_request_status_to_string(coap_request_status_t status);
+/*-------------------------------------------------------------------------------------------------------------------*/
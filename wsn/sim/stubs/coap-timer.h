@@ -0,0 +1,10 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct coap_timer {
+    uint64_t expiration_time;
+} coap_timer_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_timer_set(coap_timer_t* timer, uint64_t time);
+/*-------------------------------------------------------------------------------------------------------------------*/
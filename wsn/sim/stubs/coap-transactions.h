@@ -0,0 +1,13 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "coap-timer.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Only the retransmission state that edge_info_set_coap_timeout changes, see sim_edge_request
+typedef struct coap_transaction {
+    uint32_t retrans_interval;
+    uint8_t retrans_counter;
+    coap_timer_t retrans_timer;
+} coap_transaction_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,24 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Stands in for Contiki-NG when the trust stack is built for the host simulator.
+// Only what the trust models, choose policies and edge info use is provided.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+
+#include "os/sys/cc.h"
+#include "os/sys/clock.h"
+#include "os/sys/timer.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef unsigned char process_event_t;
+typedef void* process_data_t;
+
+struct process;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Provided by the platform SDKs on the motes
+#define ASSERT(expr) assert(expr)
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,17 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+
+#include "os/net/ipv6/uip.h"
+#include "stereotype-tags.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The simulator has no certificates, so there is never a key or stereotype for an edge
+typedef struct public_key_item {
+    struct {
+        stereotype_tags_t tags;
+    } cert;
+} public_key_item_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_find_addr(const uip_ip6addr_t* addr);
+bool request_public_key(const uip_ip6addr_t* addr);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,2 @@
+#pragma once
+#include "os/net/ipv6/uip.h"
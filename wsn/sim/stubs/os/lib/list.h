@@ -0,0 +1,42 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+
+#include "os/sys/cc.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The same interface and semantics as Contiki-NG's os/lib/list.h
+#define LIST_CONCAT2(s1, s2) s1##s2
+#define LIST_CONCAT(s1, s2) LIST_CONCAT2(s1, s2)
+
+#define LIST(name) \
+    static void* LIST_CONCAT(name, _list) = NULL; \
+    static list_t name = (list_t)&LIST_CONCAT(name, _list)
+
+#define LIST_STRUCT(name) \
+    void* LIST_CONCAT(name, _list); \
+    list_t name
+
+#define LIST_STRUCT_INIT(struct_ptr, name) \
+    do { \
+        (struct_ptr)->name = &((struct_ptr)->LIST_CONCAT(name, _list)); \
+        (struct_ptr)->LIST_CONCAT(name, _list) = NULL; \
+        list_init((struct_ptr)->name); \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef void** list_t;
+typedef void* const* const_list_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_init(list_t list);
+void* list_head(const_list_t list);
+void* list_tail(const_list_t list);
+void* list_pop(list_t list);
+void list_push(list_t list, void* item);
+void* list_chop(list_t list);
+void list_add(list_t list, void* item);
+bool list_remove(list_t list, const void* item);
+int list_length(const_list_t list);
+void list_copy(list_t dest, const_list_t src);
+void list_insert(list_t list, void* previtem, void* newitem);
+void* list_item_next(const void* item);
+bool list_contains(const_list_t list, const void* item);
+/*-------------------------------------------------------------------------------------------------------------------*/
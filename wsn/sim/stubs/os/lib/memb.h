@@ -0,0 +1,26 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+
+#include "os/sys/cc.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The same interface and semantics as Contiki-NG's os/lib/memb.h
+#define MEMB(name, structure, num) \
+    static bool CC_CONCAT(name, _memb_used)[num]; \
+    static structure CC_CONCAT(name, _memb_mem)[num]; \
+    static struct memb name = { sizeof(structure), num, CC_CONCAT(name, _memb_used), (void*)CC_CONCAT(name, _memb_mem) }
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct memb
+{
+    unsigned short size;
+    unsigned short num;
+    bool* used;
+    void* mem;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+void memb_init(struct memb* m);
+void* memb_alloc(struct memb* m);
+int memb_free(struct memb* m, void* ptr);
+int memb_inmemb(struct memb* m, void* ptr);
+int memb_numfree(struct memb* m);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,9 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define RANDOM_RAND_MAX 65535U
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Drawn from the simulated node's own stream, so each node is reproducible from the seed
+unsigned short random_rand(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+// Contiki-NG's uip.h brings in the rest of Contiki through uipopt.h, which some headers rely on
+#include "contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Only addresses are needed, as the simulator does not send packets
+typedef union uip_ip6addr_t
+{
+    uint8_t u8[16];
+    uint16_t u16[8];
+} uip_ip6addr_t;
+
+typedef uip_ip6addr_t uip_ipaddr_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UIP_HTONS(n) ((uint16_t)((((uint16_t)(n)) << 8) | (((uint16_t)(n)) >> 8)))
+#else
+#define UIP_HTONS(n) ((uint16_t)(n))
+#endif
+#define UIP_NTOHS(n) UIP_HTONS(n)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define uip_ip6addr(addr, addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7) \
+    do { \
+        (addr)->u16[0] = UIP_HTONS(addr0); \
+        (addr)->u16[1] = UIP_HTONS(addr1); \
+        (addr)->u16[2] = UIP_HTONS(addr2); \
+        (addr)->u16[3] = UIP_HTONS(addr3); \
+        (addr)->u16[4] = UIP_HTONS(addr4); \
+        (addr)->u16[5] = UIP_HTONS(addr5); \
+        (addr)->u16[6] = UIP_HTONS(addr6); \
+        (addr)->u16[7] = UIP_HTONS(addr7); \
+    } while (0)
+
+#define uip_ipaddr_copy(dest, src) (*((uip_ip6addr_t*)(dest)) = *((const uip_ip6addr_t*)(src)))
+#define uip_ip6addr_copy(dest, src) uip_ipaddr_copy(dest, src)
+
+#define uip_ip6addr_cmp(addr1, addr2) (memcmp(addr1, addr2, sizeof(uip_ip6addr_t)) == 0)
+#define uip_ipaddr_cmp(addr1, addr2) uip_ip6addr_cmp(addr1, addr2)
+/*-------------------------------------------------------------------------------------------------------------------*/
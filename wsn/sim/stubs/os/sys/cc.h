@@ -0,0 +1,12 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CC_CONCAT2(s1, s2) s1##s2
+#define CC_CONCAT(s1, s2) CC_CONCAT2(s1, s2)
+
+#define CC_STRINGIFY_IMPL(s) #s
+#define CC_STRINGIFY(s) CC_STRINGIFY_IMPL(s)
+
+#define CC_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+#define CC_INLINE inline
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,13 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Simulated time in milliseconds, advanced by the event queue in sim.c or the trace in replay.c
+#define CLOCK_SECOND 1000
+#define CLOCK_CONF_SECOND CLOCK_SECOND
+
+typedef uint32_t clock_time_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t clock_time(void);
+unsigned long clock_seconds(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
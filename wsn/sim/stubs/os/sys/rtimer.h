@@ -0,0 +1,10 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "os/sys/clock.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Profiling is not meaningful in simulated time, so rtimer ticks are the same as clock ticks
+typedef clock_time_t rtimer_clock_t;
+
+#define RTIMER_SECOND CLOCK_SECOND
+#define RTIMER_NOW() clock_time()
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,17 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdbool.h>
+
+#include "os/sys/clock.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct timer
+{
+    clock_time_t start;
+    clock_time_t interval;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+void timer_set(struct timer* t, clock_time_t interval);
+void timer_reset(struct timer* t);
+bool timer_expired(struct timer* t);
+clock_time_t timer_remaining(struct timer* t);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,55 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The simulator's stand in for Contiki-NG, with enough of processes and event timers for a host test
+// to run the process threads of firmware modules. Events are delivered by the test itself.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "../../stubs/contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PROCESS_EVENT_INIT  0x81
+#define PROCESS_EVENT_POLL  0x82
+#define PROCESS_EVENT_TIMER 0x88
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct pt
+{
+    unsigned short lc;
+};
+
+struct process
+{
+    const char* name;
+    char (*thread)(struct pt*, process_event_t, process_data_t);
+    struct pt pt;
+    bool needspoll;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PROCESS_NAME_STRING(process) ((process)->name)
+
+#define PROCESS_NAME(name) extern struct process name
+
+#define PROCESS_THREAD(name, ev, data) \
+    static char process_thread_##name(struct pt* process_pt, process_event_t ev, process_data_t data)
+
+#define PROCESS(name, strname) \
+    PROCESS_THREAD(name, ev, data); \
+    struct process name = { strname, process_thread_##name, { 0 }, false }
+
+// Local continuations as a switch statement, the same as Contiki-NG's lc-switch.h
+#define PROCESS_BEGIN() switch (process_pt->lc) { case 0:
+#define PROCESS_YIELD() do { process_pt->lc = __LINE__; return 0; case __LINE__:; } while (0)
+#define PROCESS_END() } process_pt->lc = 0; return 3
+
+extern struct process* process_current;
+#define PROCESS_CURRENT() process_current
+/*-------------------------------------------------------------------------------------------------------------------*/
+process_event_t process_alloc_event(void);
+void process_poll(struct process* p);
+void process_post_synch(struct process* p, process_event_t ev, process_data_t data);
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct etimer
+{
+    struct timer timer;
+    struct process* p;
+};
+
+void etimer_set(struct etimer* et, clock_time_t interval);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,7 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Only what the offload scheduler uses, the number of pending requests is set by the test
+uint8_t crypto_support_pending(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,249 @@
+// Checks tasks are dispatched earliest deadline first, and that the application is told when
+// a task it is waiting on is dropped because its deadline passed before it could be dispatched
+#include "offload-scheduler.h"
+#include "crypto-support.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+int sim_log_level = LOG_LEVEL_NONE;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+// What the scheduler needs from Contiki-NG and the rest of the firmware
+struct process* process_current;
+
+static clock_time_t now;
+static process_event_t next_event = 0x8a;
+static uint8_t crypto_pending;
+static struct etimer* etimer_pending;
+
+clock_time_t
+clock_time(void)
+{
+    return now;
+}
+
+uint8_t
+crypto_support_pending(void)
+{
+    return crypto_pending;
+}
+
+process_event_t
+process_alloc_event(void)
+{
+    return next_event++;
+}
+
+void
+process_poll(struct process* p)
+{
+    p->needspoll = true;
+}
+
+void
+process_post_synch(struct process* p, process_event_t ev, process_data_t data)
+{
+    struct process* caller = process_current;
+
+    process_current = p;
+    p->thread(&p->pt, ev, data);
+    process_current = caller;
+}
+
+void
+etimer_set(struct etimer* et, clock_time_t interval)
+{
+    et->timer.start = now;
+    et->timer.interval = interval;
+    et->p = process_current;
+    etimer_pending = et;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_NAME(offload_scheduler);
+PROCESS(app_process, "app");
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define DISPATCHED_MAX 8
+
+static offload_task_t* dispatched[DISPATCHED_MAX];
+static uint8_t dispatched_len;
+
+// The task the application is waiting to be dispatched, as routing keeps it
+static offload_task_t* pending;
+static uint8_t dropped_len;
+static uint8_t dropped_kind;
+
+PROCESS_THREAD(app_process, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while (1)
+    {
+        PROCESS_YIELD();
+
+        if (ev == pe_offload_task_dispatch)
+        {
+            offload_task_t* task = (offload_task_t*)data;
+            CHECK(task->dispatched);
+            CHECK(dispatched_len != DISPATCHED_MAX);
+
+            dispatched[dispatched_len++] = task;
+
+            if (task == pending)
+            {
+                pending = NULL;
+            }
+        }
+
+        if (ev == pe_offload_task_dropped)
+        {
+            offload_task_t* task = (offload_task_t*)data;
+
+            // Still allocated while the application is told about it
+            CHECK(!task->dispatched);
+            dropped_kind = task->kind;
+            dropped_len += 1;
+
+            if (task == pending)
+            {
+                pending = NULL;
+            }
+        }
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static offload_task_t*
+enqueue(clock_time_t deadline, uint8_t kind, uint8_t flags)
+{
+    struct process* caller = process_current;
+
+    process_current = &app_process;
+    offload_task_t* task = offload_sched_enqueue(NULL, deadline, 0, kind, flags);
+    process_current = caller;
+
+    return task;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+done(offload_task_t* task)
+{
+    process_current = &app_process;
+    offload_sched_task_done(task);
+    process_current = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Deliver polls and expired event timers until the scheduler has nothing left to do
+static void
+run(void)
+{
+    while (1)
+    {
+        if (offload_scheduler.needspoll)
+        {
+            offload_scheduler.needspoll = false;
+            process_post_synch(&offload_scheduler, PROCESS_EVENT_POLL, NULL);
+        }
+        else if (etimer_pending != NULL && now - etimer_pending->timer.start >= etimer_pending->timer.interval)
+        {
+            struct etimer* et = etimer_pending;
+            etimer_pending = NULL;
+            process_post_synch(et->p, PROCESS_EVENT_TIMER, et);
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+main(void)
+{
+    process_post_synch(&offload_scheduler, PROCESS_EVENT_INIT, NULL);
+    process_post_synch(&app_process, PROCESS_EVENT_INIT, NULL);
+
+    // Nothing is dispatched while the crypto queue is busy
+    crypto_pending = OFFLOAD_SCHED_CRYPTO_BUSY;
+
+    offload_task_t* later = enqueue(10 * CLOCK_SECOND, 1, OFFLOAD_SCHED_NO_FLAGS);
+    offload_task_t* sooner = enqueue(5 * CLOCK_SECOND, 2, OFFLOAD_SCHED_NO_FLAGS);
+    CHECK(later != NULL && sooner != NULL);
+
+    run();
+    CHECK(dispatched_len == 0);
+    CHECK(etimer_pending != NULL);
+
+    // Waiting periodic tasks of the same kind are collapsed
+    offload_task_t* periodic = enqueue(20 * CLOCK_SECOND, 3, OFFLOAD_SCHED_PERIODIC);
+    CHECK(enqueue(20 * CLOCK_SECOND, 3, OFFLOAD_SCHED_PERIODIC) == periodic);
+
+    // Earliest deadline first, up to the limit of submissions in flight
+    crypto_pending = 0;
+    now += OFFLOAD_SCHED_RETRY_PERIOD;
+    run();
+
+    CHECK(dispatched_len == OFFLOAD_SCHED_MAX_IN_FLIGHT);
+    CHECK(dispatched[0] == sooner);
+    CHECK(dispatched[1] == later);
+
+    done(sooner);
+    done(later);
+    run();
+    CHECK(dispatched_len == 3);
+    CHECK(dispatched[2] == periodic);
+    done(periodic);
+    run();
+
+    // A task that cannot be dispatched before its deadline is dropped, and the application told
+    offload_task_t* first = enqueue(60 * CLOCK_SECOND, 4, OFFLOAD_SCHED_NO_FLAGS);
+    offload_task_t* second = enqueue(60 * CLOCK_SECOND, 4, OFFLOAD_SCHED_NO_FLAGS);
+    run();
+    CHECK(dispatched_len == 5);
+
+    pending = enqueue(1 * CLOCK_SECOND, 5, OFFLOAD_SCHED_NO_FLAGS);
+    CHECK(pending != NULL);
+    run();
+    CHECK(pending != NULL);
+
+    now += 2 * CLOCK_SECOND;
+    done(first);
+    run();
+
+    CHECK(pending == NULL);
+    CHECK(dropped_len == 1);
+    CHECK(dropped_kind == 5);
+    CHECK(dispatched_len == 5);
+
+    done(second);
+    run();
+
+    // Every task has been freed
+    for (uint8_t i = 0; i != OFFLOAD_SCHED_MAX_TASKS; ++i)
+    {
+        CHECK(enqueue(60 * CLOCK_SECOND, 6, OFFLOAD_SCHED_NO_FLAGS) != NULL);
+    }
+    CHECK(enqueue(60 * CLOCK_SECOND, 6, OFFLOAD_SCHED_NO_FLAGS) == NULL);
+
+    const offload_sched_stats_t* s = offload_sched_stats(&app_process);
+    CHECK(s->dispatched == 5);
+    CHECK(s->completed == 5);
+    CHECK(s->missed == 1);
+    CHECK(s->collapsed == 1);
+
+    printf("offload-scheduler: dispatched %" PRIu32 ", dropped %" PRIu32 "\n", s->dispatched, s->missed);
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
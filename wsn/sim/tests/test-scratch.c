@@ -0,0 +1,104 @@
+// Checks the scratch arena with the buffers of the node applications that share it
+#include "scratch.h"
+#include "monitoring.h"
+#include "challenge-response.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+int sim_log_level = LOG_LEVEL_NONE;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint16_t size;
+    uint8_t* buf;
+    uint8_t pattern;
+} user_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+user_alloc(user_t* u)
+{
+    CHECK(u->buf == NULL);
+
+    u->buf = scratch_alloc(u->size);
+    CHECK(u->buf != NULL);
+    CHECK(((uintptr_t)u->buf % sizeof(uint32_t)) == 0);
+
+    u->pattern += 1;
+    memset(u->buf, u->pattern, u->size);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+user_free(user_t* u)
+{
+    CHECK(u->buf != NULL);
+
+    // Nothing else has been given the same memory
+    for (uint16_t i = 0; i != u->size; ++i)
+    {
+        CHECK(u->buf[i] == u->pattern);
+    }
+
+    scratch_free(u->buf);
+    u->buf = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int
+main(void)
+{
+    user_t monitoring = { .size = MONITORING_MSG_BUF_LEN };
+    user_t challenge_response = { .size = CHALLENGE_RESPONSE_MSG_BUF_LEN };
+
+    // The older allocation is freed first, so the space it leaves is before a live allocation
+    user_alloc(&monitoring);
+    user_alloc(&challenge_response);
+    user_free(&monitoring);
+    user_alloc(&monitoring);
+    user_free(&challenge_response);
+    user_alloc(&challenge_response);
+    user_free(&monitoring);
+    user_free(&challenge_response);
+
+    // Every order of the two applications sending and their requests finishing
+    user_t* users[] = { &monitoring, &challenge_response };
+
+    srand(1);
+    for (unsigned i = 0; i != 100000; ++i)
+    {
+        user_t* u = users[rand() % 2];
+
+        if (u->buf == NULL)
+        {
+            user_alloc(u);
+        }
+        else
+        {
+            user_free(u);
+        }
+    }
+
+    CHECK(scratch_failures() == 0);
+    CHECK(scratch_peak() <= SCRATCH_SIZE);
+
+    // Allocations that do not fit fail, rather than overlapping others
+    user_alloc(&monitoring);
+    user_alloc(&challenge_response);
+    CHECK(scratch_alloc(SCRATCH_SIZE) == NULL);
+    CHECK(scratch_failures() == 1);
+
+    printf("scratch: peak %u of %u bytes\n", scratch_peak(), SCRATCH_SIZE);
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/